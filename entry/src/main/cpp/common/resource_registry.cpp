@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <map>
+#include "resource_registry.h"
+
+namespace {
+const char *const KIND_NAMES[] = {"program", "buffer", "texture", "renderbuffer", "framebuffer", "vertexArray",
+                                  "surface", "heap"};
+static_assert(sizeof(KIND_NAMES) / sizeof(KIND_NAMES[0]) == static_cast<size_t>(ResourceKind::Count),
+              "every resource kind needs a name");
+} // namespace
+
+const char *ResourceKindName(ResourceKind kind) {
+    int index = static_cast<int>(kind);
+    return index < static_cast<int>(ResourceKind::Count) ? KIND_NAMES[index] : "unknown";
+}
+
+bool ResourceKindFromName(const std::string &name, ResourceKind &kind) {
+    for (int i = 0; i < static_cast<int>(ResourceKind::Count); i++) {
+        if (name == KIND_NAMES[i]) {
+            kind = static_cast<ResourceKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+ResourcePool PoolOf(ResourceKind kind) { return kind == ResourceKind::Heap ? ResourcePool::Cpu : ResourcePool::Gpu; }
+
+ResourceRegistry *ResourceRegistry::GetInstance() {
+    static ResourceRegistry registry;
+    return &registry;
+}
+
+ResourceHandle ResourceRegistry::Track(ResourceKind kind, const char *owner, uint64_t bytes) {
+    std::vector<BudgetExceeded> crossed;
+    ResourceHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handle = nextHandle_++;
+        if (nextHandle_ == 0) {
+            nextHandle_ = 1;
+        }
+        records_[handle] = {kind, owner, bytes};
+        kinds_[static_cast<int>(kind)].count++;
+        pools_[static_cast<int>(PoolOf(kind))].count++;
+        Add(kind, owner, static_cast<int64_t>(bytes), crossed);
+    }
+    Notify(crossed);
+    return handle;
+}
+
+void ResourceRegistry::Resize(ResourceHandle handle, uint64_t bytes) {
+    std::vector<BudgetExceeded> crossed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = records_.find(handle);
+        if (it == records_.end() || it->second.bytes == bytes) {
+            return;
+        }
+        Record &record = it->second;
+        Add(record.kind, record.owner, static_cast<int64_t>(bytes) - static_cast<int64_t>(record.bytes), crossed);
+        record.bytes = bytes;
+    }
+    Notify(crossed);
+}
+
+void ResourceRegistry::Untrack(ResourceHandle handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = records_.find(handle);
+    if (it == records_.end()) {
+        return;
+    }
+    const Record &record = it->second;
+    std::vector<BudgetExceeded> none;
+    Add(record.kind, record.owner, -static_cast<int64_t>(record.bytes), none);
+    kinds_[static_cast<int>(record.kind)].count--;
+    pools_[static_cast<int>(PoolOf(record.kind))].count--;
+    records_.erase(it);
+}
+
+void ResourceRegistry::Add(ResourceKind kind, const char *owner, int64_t delta, std::vector<BudgetExceeded> &crossed) {
+    Account(kinds_[static_cast<int>(kind)], delta, false, static_cast<int>(kind), owner, crossed);
+    int pool = static_cast<int>(PoolOf(kind));
+    Account(pools_[pool], delta, true, pool, owner, crossed);
+}
+
+void ResourceRegistry::Account(ResourceUsage &usage, int64_t delta, bool pool, int index, const char *owner,
+                               std::vector<BudgetExceeded> &crossed) {
+    uint64_t before = usage.bytes;
+    usage.bytes = static_cast<uint64_t>(std::max<int64_t>(0, static_cast<int64_t>(before) + delta));
+    usage.peakBytes = std::max(usage.peakBytes, usage.bytes);
+    if (usage.budgetBytes > 0 && before <= usage.budgetBytes && usage.bytes > usage.budgetBytes) {
+        usage.overBudget++;
+        crossed.push_back({pool, index, usage.bytes, usage.budgetBytes, owner});
+    }
+}
+
+void ResourceRegistry::Notify(const std::vector<BudgetExceeded> &crossed) {
+    if (crossed.empty()) {
+        return;
+    }
+    // Called on a copy outside both locks, so the callback may query, allocate or free resources, or
+    // replace itself.
+    BudgetCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        callback = callback_;
+    }
+    if (!callback) {
+        return;
+    }
+    for (const BudgetExceeded &event : crossed) {
+        callback(event);
+    }
+}
+
+void ResourceRegistry::SetBudget(ResourceKind kind, uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    kinds_[static_cast<int>(kind)].budgetBytes = bytes;
+}
+
+void ResourceRegistry::SetPoolBudget(ResourcePool pool, uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pools_[static_cast<int>(pool)].budgetBytes = bytes;
+}
+
+void ResourceRegistry::SetBudgetCallback(BudgetCallback callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    callback_ = std::move(callback);
+}
+
+bool ResourceRegistry::Fits(ResourceKind kind, uint64_t bytes) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto fits = [bytes](const ResourceUsage &usage) {
+        return usage.budgetBytes == 0 || usage.bytes + bytes <= usage.budgetBytes;
+    };
+    return fits(kinds_[static_cast<int>(kind)]) && fits(pools_[static_cast<int>(PoolOf(kind))]);
+}
+
+ResourceSnapshot ResourceRegistry::Snapshot() const {
+    ResourceSnapshot snapshot;
+    std::map<std::string, ResourceOwnerUsage> owners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::copy(std::begin(kinds_), std::end(kinds_), std::begin(snapshot.kinds));
+        std::copy(std::begin(pools_), std::end(pools_), std::begin(snapshot.pools));
+        for (const auto &entry : records_) {
+            ResourceOwnerUsage &owner = owners[entry.second.owner];
+            owner.count++;
+            owner.bytes += entry.second.bytes;
+        }
+    }
+    for (auto &entry : owners) {
+        entry.second.owner = entry.first;
+        snapshot.owners.push_back(std::move(entry.second));
+    }
+    std::sort(snapshot.owners.begin(), snapshot.owners.end(),
+              [](const ResourceOwnerUsage &a, const ResourceOwnerUsage &b) { return a.bytes > b.bytes; });
+    return snapshot;
+}
@@ -0,0 +1,132 @@
+#ifndef RESOURCE_REGISTRY_H
+#define RESOURCE_REGISTRY_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Names are part of the JS interface (MemoryStats in Index.d.ts).
+enum class ResourceKind : uint8_t {
+    Program = 0,
+    Buffer,
+    Texture,
+    Renderbuffer,
+    Framebuffer,
+    VertexArray,
+    Surface, // window surface buffers, estimated
+    Heap,
+    Count
+};
+
+enum class ResourcePool : uint8_t { Gpu = 0, Cpu, Count };
+
+const char *ResourceKindName(ResourceKind kind);
+bool ResourceKindFromName(const std::string &name, ResourceKind &kind);
+ResourcePool PoolOf(ResourceKind kind);
+
+// 0 is never a valid handle; untracking it is a no-op.
+using ResourceHandle = uint32_t;
+
+struct ResourceUsage {
+    uint32_t count = 0;
+    uint64_t bytes = 0;
+    uint64_t peakBytes = 0;
+    uint64_t budgetBytes = 0; // 0 = unlimited
+    uint32_t overBudget = 0;  // times the budget was crossed
+};
+
+struct ResourceOwnerUsage {
+    std::string owner;
+    uint32_t count = 0;
+    uint64_t bytes = 0;
+};
+
+struct ResourceSnapshot {
+    ResourceUsage kinds[static_cast<int>(ResourceKind::Count)];
+    ResourceUsage pools[static_cast<int>(ResourcePool::Count)];
+    // Largest first.
+    std::vector<ResourceOwnerUsage> owners;
+};
+
+struct BudgetExceeded {
+    bool pool;      // pool budget rather than kind budget
+    int index;      // ResourceKind or ResourcePool
+    uint64_t bytes; // usage after the allocation that crossed the budget
+    uint64_t budgetBytes;
+    const char *owner; // owner of that allocation
+};
+
+// Process-wide accounting of GL objects and large heap allocations. Sizes are the caller's estimate of
+// what the driver or allocator holds, tagged with a static owner string. Budgets can be set per kind and
+// per pool; the callback fires when an allocation takes usage over a budget, and again only after usage
+// has dropped back under it. Fits() lets creators refuse work that would exceed a budget.
+class ResourceRegistry {
+public:
+    using BudgetCallback = std::function<void(const BudgetExceeded &event)>;
+
+    static ResourceRegistry *GetInstance();
+
+    ResourceHandle Track(ResourceKind kind, const char *owner, uint64_t bytes);
+    void Resize(ResourceHandle handle, uint64_t bytes);
+    void Untrack(ResourceHandle handle);
+
+    void SetBudget(ResourceKind kind, uint64_t bytes);
+    void SetPoolBudget(ResourcePool pool, uint64_t bytes);
+    void SetBudgetCallback(BudgetCallback callback);
+    // True if another bytes of kind stay within both its kind and pool budgets.
+    bool Fits(ResourceKind kind, uint64_t bytes) const;
+
+    ResourceSnapshot Snapshot() const;
+
+private:
+    struct Record {
+        ResourceKind kind;
+        const char *owner;
+        uint64_t bytes;
+    };
+
+    // mutex_ held. Returns the budget crossings caused by the change.
+    void Add(ResourceKind kind, const char *owner, int64_t delta, std::vector<BudgetExceeded> &crossed);
+    static void Account(ResourceUsage &usage, int64_t delta, bool pool, int index, const char *owner,
+                        std::vector<BudgetExceeded> &crossed);
+    void Notify(const std::vector<BudgetExceeded> &crossed);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<ResourceHandle, Record> records_;
+    ResourceHandle nextHandle_ = 1;
+    ResourceUsage kinds_[static_cast<int>(ResourceKind::Count)];
+    ResourceUsage pools_[static_cast<int>(ResourcePool::Count)];
+    std::mutex callbackMutex_;
+    BudgetCallback callback_;
+};
+
+// Tracks one allocation for the lifetime of the owning object.
+class TrackedResource {
+public:
+    TrackedResource() = default;
+    TrackedResource(ResourceKind kind, const char *owner, uint64_t bytes)
+        : handle_(ResourceRegistry::GetInstance()->Track(kind, owner, bytes)) {
+    }
+    ~TrackedResource() { Reset(); }
+    TrackedResource(const TrackedResource &) = delete;
+    TrackedResource &operator=(const TrackedResource &) = delete;
+
+    void Reset(ResourceKind kind, const char *owner, uint64_t bytes) {
+        Reset();
+        handle_ = ResourceRegistry::GetInstance()->Track(kind, owner, bytes);
+    }
+    void Resize(uint64_t bytes) { ResourceRegistry::GetInstance()->Resize(handle_, bytes); }
+    void Reset() {
+        ResourceRegistry::GetInstance()->Untrack(handle_);
+        handle_ = 0;
+    }
+    bool Active() const { return handle_ != 0; }
+
+private:
+    ResourceHandle handle_ = 0;
+};
+
+#endif // RESOURCE_REGISTRY_H
@@ -0,0 +1,407 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "tracing.h"
+#include "resource_registry.h"
+#include "plugin_common.h"
+
+namespace {
+const uint32_t EVENTS_PER_THREAD = 16384;
+// Everything but Ends stops this far short of the end, so the Ends of slices already open still fit.
+const uint32_t END_RESERVE = 64;
+
+thread_local const char *t_threadName = nullptr;
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+bool EndsWith(const std::string &text, const char *suffix) {
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+void AppendJsonString(std::string &out, const char *text) {
+    out += '"';
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += static_cast<unsigned char>(*c) < 0x20 ? ' ' : *c;
+    }
+    out += '"';
+}
+
+void AppendFormat(std::string &out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+void AppendFormat(std::string &out, const char *format, ...) {
+    char text[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    out.append(text, std::min<size_t>(length > 0 ? length : 0, sizeof(text) - 1));
+}
+
+// Minimal protobuf writer for the few Perfetto messages the dump needs.
+enum WireType : uint32_t { VARINT = 0, FIXED64 = 1, LENGTH_DELIMITED = 2 };
+
+void PutVarint(std::string &out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void PutTag(std::string &out, uint32_t field, WireType type) { PutVarint(out, (field << 3) | type); }
+
+void PutUint(std::string &out, uint32_t field, uint64_t value) {
+    PutTag(out, field, VARINT);
+    PutVarint(out, value);
+}
+
+void PutFixed64(std::string &out, uint32_t field, uint64_t value) {
+    PutTag(out, field, FIXED64);
+    for (int i = 0; i < 8; i++) {
+        out += static_cast<char>(value >> (i * 8));
+    }
+}
+
+void PutDouble(std::string &out, uint32_t field, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutFixed64(out, field, bits);
+}
+
+void PutBytes(std::string &out, uint32_t field, const std::string &bytes) {
+    PutTag(out, field, LENGTH_DELIMITED);
+    PutVarint(out, bytes.size());
+    out += bytes;
+}
+
+// Field numbers from perfetto/protos/perfetto/trace/ (trace.proto, trace_packet.proto, track_event/*.proto).
+const uint32_t TRACE_PACKET = 1;
+const uint32_t PACKET_TIMESTAMP = 8;
+const uint32_t PACKET_SEQUENCE_ID = 10;
+const uint32_t PACKET_TRACK_EVENT = 11;
+const uint32_t PACKET_TRACK_DESCRIPTOR = 60;
+const uint32_t TRACK_UUID = 1;
+const uint32_t TRACK_NAME = 2;
+const uint32_t TRACK_PROCESS = 3;
+const uint32_t TRACK_THREAD = 4;
+const uint32_t TRACK_PARENT_UUID = 5;
+const uint32_t TRACK_COUNTER = 8;
+const uint32_t PROCESS_PID = 1;
+const uint32_t PROCESS_NAME = 6;
+const uint32_t THREAD_PID = 1;
+const uint32_t THREAD_TID = 2;
+const uint32_t THREAD_NAME = 5;
+const uint32_t EVENT_TYPE = 9;
+const uint32_t EVENT_TRACK_UUID = 11;
+const uint32_t EVENT_NAME = 23;
+const uint32_t EVENT_DOUBLE_COUNTER_VALUE = 44;
+const uint32_t EVENT_FLOW_IDS = 47;
+const uint32_t EVENT_TERMINATING_FLOW_IDS = 48;
+const uint64_t SLICE_BEGIN = 1;
+const uint64_t SLICE_END = 2;
+const uint64_t INSTANT = 3;
+const uint64_t COUNTER = 4;
+
+const uint64_t PROCESS_TRACK = 1;
+const uint64_t FIRST_THREAD_TRACK = 0x100;
+const uint64_t FIRST_COUNTER_TRACK = 0x10000;
+
+void PutPacket(std::string &out, uint64_t timestampNs, uint32_t sequenceId, uint32_t field, const std::string &body) {
+    std::string packet;
+    if (timestampNs > 0) {
+        PutUint(packet, PACKET_TIMESTAMP, timestampNs);
+    }
+    PutUint(packet, PACKET_SEQUENCE_ID, sequenceId);
+    PutBytes(packet, field, body);
+    PutBytes(out, TRACE_PACKET, packet);
+}
+} // namespace
+
+struct Tracer::ThreadBuffer {
+    int tid = 0;
+    std::atomic<const char *> name {nullptr};
+    std::atomic<uint32_t> session {0};
+    std::atomic<uint32_t> count {0};
+    std::atomic<uint64_t> dropped {0};
+    std::unique_ptr<TraceEvent[]> events;
+    TrackedResource tracked;
+};
+
+struct Tracer::BufferView {
+    int tid;
+    const char *name;
+    const TraceEvent *events;
+    uint32_t count;
+};
+
+std::atomic<bool> Tracer::enabled_ {false};
+std::atomic<uint64_t> Tracer::nextFlowId_ {1};
+thread_local Tracer::ThreadBuffer *Tracer::threadBuffer_ = nullptr;
+
+Tracer *Tracer::GetInstance() {
+    // Never destroyed: threads may still record while the process exits.
+    static Tracer *tracer = new Tracer();
+    return tracer;
+}
+
+void Tracer::Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Each thread drops its previous session on its next event.
+    session_.fetch_add(1, std::memory_order_release);
+    enabled_.store(true);
+    LOGI("Tracing started");
+}
+
+void Tracer::Stop() {
+    enabled_.store(false);
+    LOGI("Tracing stopped");
+}
+
+void Tracer::SetThreadName(const char *name) {
+    t_threadName = name;
+    if (threadBuffer_) {
+        threadBuffer_->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+Tracer::ThreadBuffer *Tracer::CurrentBuffer() {
+    if (threadBuffer_) {
+        return threadBuffer_;
+    }
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = static_cast<int>(syscall(SYS_gettid));
+    buffer->name.store(t_threadName, std::memory_order_relaxed);
+    buffer->events.reset(new TraceEvent[EVENTS_PER_THREAD]);
+    buffer->tracked.Reset(ResourceKind::Heap, "trace", sizeof(TraceEvent) * EVENTS_PER_THREAD);
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(std::move(buffer));
+    threadBuffer_ = buffers_.back().get();
+    return threadBuffer_;
+}
+
+bool Tracer::Record(TraceEventType type, const char *name, uint64_t flowId, double counter) {
+    if (!Enabled()) {
+        return false;
+    }
+    ThreadBuffer *buffer = CurrentBuffer();
+    uint32_t session = session_.load(std::memory_order_acquire);
+    if (buffer->session.load(std::memory_order_relaxed) != session) {
+        // Only the owning thread writes count; Dump skips the buffer until session is published.
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+    uint32_t count = buffer->count.load(std::memory_order_relaxed);
+    uint32_t limit = type == TraceEventType::End ? EVENTS_PER_THREAD : EVENTS_PER_THREAD - END_RESERVE;
+    if (count >= limit) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    TraceEvent &event = buffer->events[count];
+    event.name = name;
+    event.timestampNs = NowNs();
+    if (type == TraceEventType::Counter) {
+        event.counter = counter;
+    } else {
+        event.flowId = flowId;
+    }
+    event.type = type;
+    // Publishes the event to Dump, which reads only below count.
+    buffer->count.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+TraceStats Tracer::Stats() {
+    TraceStats stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t session = session_.load(std::memory_order_relaxed);
+    for (const auto &buffer : buffers_) {
+        if (buffer->session.load(std::memory_order_acquire) != session) {
+            continue;
+        }
+        stats.threads++;
+        stats.events += buffer->count.load(std::memory_order_acquire);
+        stats.dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+bool Tracer::Dump(const std::string &path) {
+    std::string out;
+    {
+        // Held throughout so Start() cannot recycle the buffers being read.
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t session = session_.load(std::memory_order_relaxed);
+        std::vector<BufferView> views;
+        for (const auto &buffer : buffers_) {
+            if (buffer->session.load(std::memory_order_acquire) != session) {
+                continue;
+            }
+            views.push_back({buffer->tid, buffer->name.load(std::memory_order_relaxed), buffer->events.get(),
+                             buffer->count.load(std::memory_order_acquire)});
+        }
+        if (EndsWith(path, ".pftrace") || EndsWith(path, ".perfetto-trace")) {
+            WritePerfetto(views, out);
+        } else {
+            WriteJson(views, out);
+        }
+    }
+
+    std::string tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    bool written = file && fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (file) {
+        written = fclose(file) == 0 && written;
+    }
+    if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOGE("Trace write failed: %{public}s", path.c_str());
+        remove(tmpPath.c_str());
+        return false;
+    }
+    TraceStats stats = Stats();
+    LOGI("Trace written to %{public}s: %{public}llu events from %{public}u threads, %{public}llu dropped",
+         path.c_str(), (unsigned long long)stats.events, stats.threads, (unsigned long long)stats.dropped);
+    return true;
+}
+
+void Tracer::WriteJson(const std::vector<BufferView> &views, std::string &out) {
+    int pid = static_cast<int>(getpid());
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto open = [&out, &first, pid](const char *phase, const char *name, uint64_t timestampNs, int tid) {
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"ph\":\"";
+        out += phase;
+        out += "\",\"name\":";
+        AppendJsonString(out, name);
+        AppendFormat(out, ",\"pid\":%d,\"tid\":%d,\"ts\":%.3f", pid, tid, timestampNs / 1000.0);
+    };
+    for (const BufferView &view : views) {
+        if (view.name) {
+            open("M", "thread_name", 0, view.tid);
+            out += ",\"args\":{\"name\":";
+            AppendJsonString(out, view.name);
+            out += "}}";
+        }
+        for (uint32_t i = 0; i < view.count; i++) {
+            const TraceEvent &event = view.events[i];
+            switch (event.type) {
+                case TraceEventType::Begin:
+                    open("B", event.name, event.timestampNs, view.tid);
+                    break;
+                case TraceEventType::End:
+                    open("E", event.name, event.timestampNs, view.tid);
+                    break;
+                case TraceEventType::Instant:
+                    open("i", event.name, event.timestampNs, view.tid);
+                    out += ",\"s\":\"t\"";
+                    break;
+                case TraceEventType::Counter:
+                    open("C", event.name, event.timestampNs, view.tid);
+                    AppendFormat(out, ",\"args\":{\"value\":%.6g}", event.counter);
+                    break;
+                case TraceEventType::FlowStart:
+                    open("s", event.name, event.timestampNs, view.tid);
+                    AppendFormat(out, ",\"cat\":\"flow\",\"id\":%llu", (unsigned long long)event.flowId);
+                    break;
+                case TraceEventType::FlowEnd:
+                    // Binds to the enclosing slice rather than the next one to begin.
+                    open("f", event.name, event.timestampNs, view.tid);
+                    AppendFormat(out, ",\"cat\":\"flow\",\"bp\":\"e\",\"id\":%llu", (unsigned long long)event.flowId);
+                    break;
+            }
+            out += "}";
+        }
+    }
+    out += "\n]}\n";
+}
+
+void Tracer::WritePerfetto(const std::vector<BufferView> &views, std::string &out) {
+    int pid = static_cast<int>(getpid());
+    // One packet sequence per thread, plus sequence 1 for the process and counter descriptors.
+    std::string body;
+    std::string process;
+    PutUint(process, PROCESS_PID, pid);
+    PutBytes(process, PROCESS_NAME, "entry");
+    PutUint(body, TRACK_UUID, PROCESS_TRACK);
+    PutBytes(body, TRACK_PROCESS, process);
+    PutPacket(out, 0, 1, PACKET_TRACK_DESCRIPTOR, body);
+
+    std::map<std::string, uint64_t> counterTracks;
+    for (size_t v = 0; v < views.size(); v++) {
+        const BufferView &view = views[v];
+        uint64_t threadTrack = FIRST_THREAD_TRACK + v;
+        uint32_t sequenceId = static_cast<uint32_t>(2 + v);
+
+        std::string thread;
+        PutUint(thread, THREAD_PID, pid);
+        PutUint(thread, THREAD_TID, view.tid);
+        if (view.name) {
+            PutBytes(thread, THREAD_NAME, view.name);
+        }
+        body.clear();
+        PutUint(body, TRACK_UUID, threadTrack);
+        PutUint(body, TRACK_PARENT_UUID, PROCESS_TRACK);
+        PutBytes(body, TRACK_THREAD, thread);
+        PutPacket(out, 0, sequenceId, PACKET_TRACK_DESCRIPTOR, body);
+
+        for (uint32_t i = 0; i < view.count; i++) {
+            const TraceEvent &event = view.events[i];
+            uint64_t track = threadTrack;
+            body.clear();
+            switch (event.type) {
+                case TraceEventType::Begin:
+                    PutUint(body, EVENT_TYPE, SLICE_BEGIN);
+                    PutBytes(body, EVENT_NAME, event.name);
+                    break;
+                case TraceEventType::End:
+                    PutUint(body, EVENT_TYPE, SLICE_END);
+                    break;
+                case TraceEventType::Instant:
+                    PutUint(body, EVENT_TYPE, INSTANT);
+                    PutBytes(body, EVENT_NAME, event.name);
+                    break;
+                case TraceEventType::Counter: {
+                    auto inserted = counterTracks.emplace(event.name, FIRST_COUNTER_TRACK + counterTracks.size());
+                    track = inserted.first->second;
+                    if (inserted.second) {
+                        std::string descriptor;
+                        PutUint(descriptor, TRACK_UUID, track);
+                        PutUint(descriptor, TRACK_PARENT_UUID, PROCESS_TRACK);
+                        PutBytes(descriptor, TRACK_NAME, event.name);
+                        PutBytes(descriptor, TRACK_COUNTER, std::string());
+                        PutPacket(out, 0, sequenceId, PACKET_TRACK_DESCRIPTOR, descriptor);
+                    }
+                    PutUint(body, EVENT_TYPE, COUNTER);
+                    PutDouble(body, EVENT_DOUBLE_COUNTER_VALUE, event.counter);
+                    break;
+                }
+                case TraceEventType::FlowStart:
+                case TraceEventType::FlowEnd:
+                    // Perfetto hangs flows on slices; a zero-length one marks the point on the thread.
+                    PutUint(body, EVENT_TYPE, INSTANT);
+                    PutBytes(body, EVENT_NAME, event.name);
+                    PutFixed64(body,
+                               event.type == TraceEventType::FlowStart ? EVENT_FLOW_IDS : EVENT_TERMINATING_FLOW_IDS,
+                               event.flowId);
+                    break;
+            }
+            PutUint(body, EVENT_TRACK_UUID, track);
+            PutPacket(out, event.timestampNs, sequenceId, PACKET_TRACK_EVENT, body);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TraceEventType : uint8_t { Begin = 0, End, Instant, Counter, FlowStart, FlowEnd };
+
+// Names are static strings; the tracer keeps the pointer, not a copy.
+struct TraceEvent {
+    const char *name;
+    uint64_t timestampNs;
+    union {
+        double counter;
+        uint64_t flowId;
+    };
+    TraceEventType type;
+};
+
+struct TraceStats {
+    uint32_t threads = 0;
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+};
+
+// Timeline of scoped slices, counters and flows across the engine's threads. Each thread appends to its own
+// buffer without locking; the buffer is allocated on the thread's first event after Start() and filled up
+// to a fixed capacity, after which further events of that session are dropped. Recording costs one relaxed
+// load while stopped. Dump() writes Chrome Trace Event JSON, or Perfetto protobuf when the path ends in
+// .pftrace or .perfetto-trace; it can run while recording continues.
+class Tracer {
+public:
+    static Tracer *GetInstance();
+    static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Starting discards the previous session. Stopping keeps it for Dump().
+    void Start();
+    void Stop();
+    bool Dump(const std::string &path);
+    TraceStats Stats();
+
+    // Name shown for the calling thread; may be set before tracing starts.
+    static void SetThreadName(const char *name);
+    // Ids for linking a FlowStart on one thread to the FlowEnd of the slice it led to.
+    static uint64_t NewFlowId() { return nextFlowId_.fetch_add(1, std::memory_order_relaxed); }
+
+    // False if the event was not recorded (stopped, or this thread's buffer is full).
+    bool Begin(const char *name) { return Record(TraceEventType::Begin, name, 0); }
+    void End(const char *name) { Record(TraceEventType::End, name, 0); }
+    void Instant(const char *name) { Record(TraceEventType::Instant, name, 0); }
+    void Counter(const char *name, double value) { Record(TraceEventType::Counter, name, 0, value); }
+    // Flows attach to the slice open on the calling thread.
+    void FlowStart(const char *name, uint64_t id) { Record(TraceEventType::FlowStart, name, id); }
+    void FlowEnd(const char *name, uint64_t id) { Record(TraceEventType::FlowEnd, name, id); }
+
+private:
+    struct ThreadBuffer;
+    struct BufferView;
+
+    bool Record(TraceEventType type, const char *name, uint64_t flowId, double counter = 0.0);
+    ThreadBuffer *CurrentBuffer();
+
+    static void WriteJson(const std::vector<BufferView> &views, std::string &out);
+    static void WritePerfetto(const std::vector<BufferView> &views, std::string &out);
+
+    static std::atomic<bool> enabled_;
+    static std::atomic<uint64_t> nextFlowId_;
+    static thread_local ThreadBuffer *threadBuffer_;
+    std::atomic<uint32_t> session_ {0};
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Begin/End pair for the enclosing block. The End is recorded only if the Begin was.
+class TraceScope {
+public:
+    explicit TraceScope(const char *name)
+        : name_(Tracer::Enabled() && Tracer::GetInstance()->Begin(name) ? name : nullptr) {
+    }
+    ~TraceScope() {
+        if (name_) {
+            Tracer::GetInstance()->End(name_);
+        }
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value)                                                                                 \
+    do {                                                                                                           \
+        if (Tracer::Enabled()) {                                                                                   \
+            Tracer::GetInstance()->Counter(name, static_cast<double>(value));                                      \
+        }                                                                                                          \
+    } while (0)
+
+#endif // TRACING_H
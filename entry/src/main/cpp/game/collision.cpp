@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <limits>
+#include "collision.h"
+
+namespace {
+// Interval of t in which [minA + t * d, maxA + t * d] strictly overlaps [minB, maxB].
+bool AxisInterval(float minA, float maxA, float d, float minB, float maxB, float &enter, float &leave) {
+    if (d == 0.0f) {
+        enter = -std::numeric_limits<float>::infinity();
+        leave = std::numeric_limits<float>::infinity();
+        return minA < maxB && maxA > minB;
+    }
+    float t0 = (minB - maxA) / d;
+    float t1 = (maxB - minA) / d;
+    enter = std::min(t0, t1);
+    leave = std::max(t0, t1);
+    return true;
+}
+} // namespace
+
+bool Overlaps(const Aabb &a, const Aabb &b) {
+    return a.x < b.x + b.width && a.x + a.width > b.x && a.y < b.y + b.height && a.y + a.height > b.y;
+}
+
+bool SweptOverlaps(const Aabb &a, float dx, float dy, const Aabb &b, float &timeOfImpact) {
+    float enterX, leaveX, enterY, leaveY;
+    if (!AxisInterval(a.x, a.x + a.width, dx, b.x, b.x + b.width, enterX, leaveX) ||
+        !AxisInterval(a.y, a.y + a.height, dy, b.y, b.y + b.height, enterY, leaveY)) {
+        return false;
+    }
+
+    float enter = std::max(enterX, enterY);
+    float leave = std::min(leaveX, leaveY);
+    if (enter >= leave || enter >= 1.0f || leave <= 0.0f) {
+        return false;
+    }
+    timeOfImpact = std::max(0.0f, enter);
+    return true;
+}
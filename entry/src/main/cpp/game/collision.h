@@ -0,0 +1,18 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+// Axis-aligned box given by its minimum corner and size, the convention the game rules use.
+struct Aabb {
+    float x, y;
+    float width, height;
+};
+
+// Discrete test: the boxes overlap with positive area. Touching edges do not count.
+bool Overlaps(const Aabb &a, const Aabb &b);
+
+// Continuous test: box a moves by (dx, dy) over one step while b stays put. Returns true when they
+// overlap at any time in [0, 1] and stores the first such time in timeOfImpact. Unlike Overlaps on the
+// end position, a fast box cannot pass through a thin one between two steps.
+bool SweptOverlaps(const Aabb &a, float dx, float dy, const Aabb &b, float &timeOfImpact);
+
+#endif // COLLISION_H
@@ -0,0 +1,118 @@
+#include <algorithm>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "collision_mask.h"
+
+namespace {
+// True if some bit of a[k] & (b shifted left by shift bits) is set, for the two words k and k + 1. b
+// points at the word of b that lines up with a[k] before the bit shift.
+inline bool AndShifted2(const uint64_t *a, const uint64_t *b, int shift) {
+#if defined(__ARM_NEON)
+    uint64x2_t high = vshlq_u64(vld1q_u64(b), vdupq_n_s64(shift));
+    // A negative count shifts right; 64 clears the lanes, which is what shift 0 needs.
+    uint64x2_t low = vshlq_u64(vld1q_u64(b - 1), vdupq_n_s64(shift - 64));
+    uint64x2_t hit = vandq_u64(vld1q_u64(a), vorrq_u64(high, low));
+    return (vgetq_lane_u64(hit, 0) | vgetq_lane_u64(hit, 1)) != 0;
+#elif defined(__SSE2__)
+    __m128i high = _mm_sll_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b)), _mm_cvtsi32_si128(shift));
+    // Counts above 63 clear the lanes, which is what shift 0 needs.
+    __m128i low =
+        _mm_srl_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b - 1)), _mm_cvtsi32_si128(64 - shift));
+    __m128i hit = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a)), _mm_or_si128(high, low));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(hit, _mm_setzero_si128())) != 0xffff;
+#else
+    uint64_t hit = 0;
+    for (int i = 0; i < 2; i++) {
+        uint64_t aligned = b[i] << shift;
+        if (shift != 0) {
+            aligned |= b[i - 1] >> (64 - shift);
+        }
+        hit |= a[i] & aligned;
+    }
+    return hit != 0;
+#endif
+}
+} // namespace
+
+CollisionMask::CollisionMask(int width, int height)
+    : width_(std::max(0, width)), height_(std::max(0, height)), words_((width_ + 63) / 64),
+      stride_(words_ + 2 * PAD_WORDS), bits_(static_cast<size_t>(stride_) * height_, 0) {
+}
+
+CollisionMask CollisionMask::Resampled(int width, int height) const {
+    CollisionMask out(width, height);
+    if (width_ == 0 || height_ == 0) {
+        return out;
+    }
+    for (int y = 0; y < out.height_; y++) {
+        int sy = static_cast<int>((2 * static_cast<int64_t>(y) + 1) * height_ / (2 * static_cast<int64_t>(height)));
+        for (int x = 0; x < out.width_; x++) {
+            int sx = static_cast<int>((2 * static_cast<int64_t>(x) + 1) * width_ / (2 * static_cast<int64_t>(width)));
+            if (Test(sx, sy)) {
+                out.Set(x, y);
+            }
+        }
+    }
+    return out;
+}
+
+std::shared_ptr<CollisionAtlas> CollisionAtlas::FromRgba(const uint8_t *rgba, int width, int height, int frameWidth,
+                                                         int frameHeight, uint8_t alphaThreshold) {
+    if (!rgba || frameWidth <= 0 || frameHeight <= 0 || width < frameWidth || height < frameHeight) {
+        return nullptr;
+    }
+    int columns = width / frameWidth;
+    int rows = height / frameHeight;
+    std::shared_ptr<CollisionAtlas> atlas(new CollisionAtlas());
+    atlas->frames_.reserve(static_cast<size_t>(columns) * rows);
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            CollisionMask mask(frameWidth, frameHeight);
+            for (int y = 0; y < frameHeight; y++) {
+                // The atlas is stored top row first, masks bottom row first.
+                const uint8_t *pixel =
+                    rgba + (static_cast<size_t>(row * frameHeight + y) * width + column * frameWidth) * 4;
+                for (int x = 0; x < frameWidth; x++, pixel += 4) {
+                    if (pixel[3] >= alphaThreshold) {
+                        mask.Set(x, frameHeight - 1 - y);
+                    }
+                }
+            }
+            atlas->frames_.push_back(std::move(mask));
+        }
+    }
+    return atlas;
+}
+
+bool MasksOverlap(const CollisionMask &a, int32_t ax, int32_t ay, const CollisionMask &b, int32_t bx, int32_t by) {
+    // Put a on the left, so b's columns only ever shift towards higher bits.
+    if (bx < ax) {
+        return MasksOverlap(b, bx, by, a, ax, ay);
+    }
+    int64_t dx = static_cast<int64_t>(bx) - ax;
+    int64_t dy = static_cast<int64_t>(by) - ay;
+    if (dx >= a.Width() || dy >= a.Height() || -dy >= b.Height()) {
+        return false;
+    }
+    int wordShift = static_cast<int>(dx >> 6);
+    int bitShift = static_cast<int>(dx & 63);
+    // Words of a that b reaches; b's last word spills into one more when shifted.
+    int firstWord = wordShift;
+    int endWord = std::min(a.WordsPerRow(), wordShift + b.WordsPerRow() + (bitShift != 0 ? 1 : 0));
+    int firstRow = static_cast<int>(std::max<int64_t>(0, dy));
+    int endRow = static_cast<int>(std::min<int64_t>(a.Height(), dy + b.Height()));
+    for (int y = firstRow; y < endRow; y++) {
+        const uint64_t *rowA = a.Row(y);
+        const uint64_t *rowB = b.Row(static_cast<int>(y - dy));
+        // Pairs may run one word past either row's columns, into its zero padding.
+        for (int k = firstWord; k < endWord; k += 2) {
+            if (AndShifted2(rowA + k, rowB + (k - wordShift), bitShift)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
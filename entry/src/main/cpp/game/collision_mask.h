@@ -0,0 +1,70 @@
+#ifndef COLLISION_MASK_H
+#define COLLISION_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Resolution of the grid masks are compared on: a mask baked for a box covers round(size * CELLS) cells
+// and is placed at the cell its minimum corner rounds to.
+constexpr float COLLISION_CELLS_PER_NDC = 256.0f;
+
+inline int32_t ToCollisionCells(float ndc) {
+    float cells = ndc * COLLISION_CELLS_PER_NDC;
+    return static_cast<int32_t>(cells < 0.0f ? cells - 0.5f : cells + 0.5f);
+}
+
+// 1-bit coverage image, bottom row first. Bit x % 64 of word x / 64 is column x. Each row is padded with
+// zero words on both sides so the narrowphase can load neighbouring words without bounds checks.
+class CollisionMask {
+public:
+    CollisionMask() = default;
+    CollisionMask(int width, int height);
+
+    int Width() const { return width_; }
+    int Height() const { return height_; }
+    // Words that hold columns; the row extends past both ends with zero words.
+    int WordsPerRow() const { return words_; }
+    const uint64_t *Row(int y) const { return bits_.data() + static_cast<size_t>(y) * stride_ + PAD_WORDS; }
+    uint64_t *Row(int y) { return bits_.data() + static_cast<size_t>(y) * stride_ + PAD_WORDS; }
+    void Set(int x, int y) { Row(y)[x >> 6] |= uint64_t(1) << (x & 63); }
+    bool Test(int x, int y) const { return (Row(y)[x >> 6] >> (x & 63)) & 1; }
+    size_t Bytes() const { return bits_.size() * sizeof(uint64_t); }
+
+    // Nearest-sampled copy stretched to width x height, the way a textured quad stretches its frame.
+    CollisionMask Resampled(int width, int height) const;
+
+private:
+    static constexpr int PAD_WORDS = 2;
+
+    int width_ = 0;
+    int height_ = 0;
+    int words_ = 0;
+    int stride_ = 0;
+    std::vector<uint64_t> bits_;
+};
+
+// Collision masks for every frame of a sprite atlas, taken from its alpha channel when the atlas is loaded.
+// Frames are frameWidth x frameHeight cells of the atlas, numbered row by row from the top left.
+class CollisionAtlas {
+public:
+    // rgba is width * height pixels, top row first, alpha in the fourth byte. Pixels with alpha at or
+    // above alphaThreshold are solid. Null if the sizes do not describe at least one whole frame.
+    static std::shared_ptr<CollisionAtlas> FromRgba(const uint8_t *rgba, int width, int height, int frameWidth,
+                                                    int frameHeight, uint8_t alphaThreshold);
+
+    size_t FrameCount() const { return frames_.size(); }
+    const CollisionMask &Frame(size_t frame) const { return frames_[frame]; }
+
+private:
+    CollisionAtlas() = default;
+
+    std::vector<CollisionMask> frames_;
+};
+
+// Narrowphase: true when a placed at cell (ax, ay) and b at (bx, by) share a solid cell. Only the rows
+// both masks cover are visited; each is a shifted AND of whole words, two at a time with SIMD.
+bool MasksOverlap(const CollisionMask &a, int32_t ax, int32_t ay, const CollisionMask &b, int32_t bx, int32_t by);
+
+#endif // COLLISION_MASK_H
@@ -0,0 +1,42 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <cstdint>
+
+// Positions and extents are in NDC, velocities in NDC per second. A position is the centre of its extent.
+struct Position {
+    float x, y;
+};
+
+struct Velocity {
+    float x, y;
+};
+
+struct Extent {
+    float width, height;
+};
+
+struct Sprite {
+    float r, g, b, a;
+};
+
+struct PlayerControl {
+    float speed;
+};
+
+// Which atlas frame the entity collides as, and its mask baked to the entity's extent.
+struct CollisionShape {
+    // Obstacles use obstacle frame variant % (frames - 1); the player always uses frame 0.
+    uint16_t variant;
+    // Index into the world's baked masks, NO_COLLISION_MASK to collide as the whole box.
+    uint16_t mask;
+};
+
+constexpr uint16_t NO_COLLISION_MASK = UINT16_MAX;
+
+// Tag: entity falls towards the player, scores when it leaves the screen.
+struct Obstacle {
+    uint8_t unused;
+};
+
+#endif // COMPONENTS_H
@@ -0,0 +1,209 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <mutex>
+#include "ecs.h"
+#include "job_system.h"
+#include "plugin_common.h"
+
+namespace {
+// Below this many live entities a phase's systems are too cheap to be worth waking a worker for; they run
+// one after another on the calling thread, which still splits their own loops if those are big enough.
+constexpr size_t PARALLEL_PHASE_MIN_ENTITIES = 256;
+
+std::mutex g_componentMutex;
+size_t g_componentSizes[kMaxComponents];
+ComponentId g_componentCount = 0;
+
+bool Conflicts(const SystemDesc &a, const SystemDesc &b) {
+    return (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+}
+} // namespace
+
+namespace ecs_detail {
+ComponentId RegisterComponent(size_t size) {
+    std::lock_guard<std::mutex> lock(g_componentMutex);
+    if (g_componentCount >= kMaxComponents) {
+        LOGE("ECS: more than %{public}u component types", kMaxComponents);
+        return kMaxComponents - 1;
+    }
+    g_componentSizes[g_componentCount] = size;
+    return g_componentCount++;
+}
+
+size_t ComponentSize(ComponentId id) {
+    std::lock_guard<std::mutex> lock(g_componentMutex);
+    return id < g_componentCount ? g_componentSizes[id] : 0;
+}
+} // namespace ecs_detail
+
+Archetype::Archetype(ComponentMask mask) : mask_(mask) {
+    for (ComponentId id = 0; id < kMaxComponents; id++) {
+        columnIndex_[id] = -1;
+        if (mask & (ComponentMask(1) << id)) {
+            columnIndex_[id] = static_cast<int8_t>(columns_.size());
+            columns_.push_back({id, ecs_detail::ComponentSize(id), {}});
+        }
+    }
+}
+
+uint8_t *Archetype::ColumnData(ComponentId id) {
+    int8_t index = id < kMaxComponents ? columnIndex_[id] : -1;
+    return index < 0 ? nullptr : columns_[index].bytes.data();
+}
+
+size_t Archetype::Append(Entity entity) {
+    size_t row = entities_.size();
+    entities_.push_back(entity);
+    for (ColumnStorage &column : columns_) {
+        column.bytes.resize(column.bytes.size() + column.elementSize, 0);
+    }
+    return row;
+}
+
+Entity Archetype::SwapRemove(size_t row) {
+    size_t last = entities_.size() - 1;
+    Entity moved;
+    if (row != last) {
+        moved = entities_[last];
+        entities_[row] = moved;
+        for (ColumnStorage &column : columns_) {
+            memcpy(column.bytes.data() + row * column.elementSize, column.bytes.data() + last * column.elementSize,
+                   column.elementSize);
+        }
+    }
+    entities_.pop_back();
+    for (ColumnStorage &column : columns_) {
+        column.bytes.resize(column.bytes.size() - column.elementSize);
+    }
+    return moved;
+}
+
+void Archetype::Clear() {
+    entities_.clear();
+    for (ColumnStorage &column : columns_) {
+        column.bytes.clear();
+    }
+}
+
+size_t Archetype::CapacityBytes() const {
+    size_t bytes = entities_.capacity() * sizeof(Entity);
+    for (const ColumnStorage &column : columns_) {
+        bytes += column.bytes.capacity();
+    }
+    return bytes;
+}
+
+size_t World::CapacityBytes() const {
+    size_t bytes = records_.capacity() * sizeof(Record) + freeIndices_.capacity() * sizeof(uint32_t);
+    for (const auto &archetype : archetypes_) {
+        bytes += sizeof(Archetype) + archetype->CapacityBytes();
+    }
+    return bytes;
+}
+
+Entity World::Allocate() {
+    Entity entity;
+    if (!freeIndices_.empty()) {
+        entity.index = freeIndices_.back();
+        freeIndices_.pop_back();
+    } else {
+        entity.index = static_cast<uint32_t>(records_.size());
+        records_.emplace_back();
+    }
+    entity.generation = records_[entity.index].generation;
+    return entity;
+}
+
+Archetype *World::GetOrCreateArchetype(ComponentMask mask) {
+    auto it = archetypeByMask_.find(mask);
+    if (it != archetypeByMask_.end()) {
+        return it->second;
+    }
+    archetypes_.push_back(std::make_unique<Archetype>(mask));
+    Archetype *archetype = archetypes_.back().get();
+    archetypeByMask_[mask] = archetype;
+    return archetype;
+}
+
+bool World::Alive(Entity entity) const {
+    return entity.index < records_.size() && records_[entity.index].archetype &&
+           records_[entity.index].generation == entity.generation;
+}
+
+void World::Destroy(Entity entity) {
+    if (!Alive(entity)) {
+        return;
+    }
+    Record &record = records_[entity.index];
+    Entity moved = record.archetype->SwapRemove(record.row);
+    if (moved.Valid()) {
+        records_[moved.index].row = record.row;
+    }
+    record.archetype = nullptr;
+    record.generation++;
+    // Lowest indices are reused first, which keeps entity indices small and dense.
+    freeIndices_.insert(std::upper_bound(freeIndices_.begin(), freeIndices_.end(), entity.index,
+                                         [](uint32_t a, uint32_t b) { return a > b; }),
+                        entity.index);
+}
+
+void World::Clear() {
+    for (auto &archetype : archetypes_) {
+        archetype->Clear();
+    }
+    freeIndices_.clear();
+    for (size_t i = records_.size(); i > 0; i--) {
+        Record &record = records_[i - 1];
+        if (record.archetype) {
+            record.archetype = nullptr;
+            record.generation++;
+        }
+        freeIndices_.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+void World::RegisterSystem(const SystemDesc &system) {
+    systems_.push_back(system);
+    phasesDirty_ = true;
+}
+
+void World::BuildPhases() {
+    phases_.clear();
+    for (size_t i = 0; i < systems_.size(); i++) {
+        bool fits = !phases_.empty();
+        if (fits) {
+            for (size_t other : phases_.back()) {
+                if (Conflicts(systems_[i], systems_[other])) {
+                    fits = false;
+                    break;
+                }
+            }
+        }
+        if (!fits) {
+            phases_.emplace_back();
+        }
+        phases_.back().push_back(i);
+    }
+    phasesDirty_ = false;
+    LOGI("ECS: %{public}zu systems in %{public}zu phases", systems_.size(), phases_.size());
+}
+
+void World::RunSystems(JobSystem &jobs) {
+    if (phasesDirty_) {
+        BuildPhases();
+    }
+    bool parallel = records_.size() - freeIndices_.size() >= PARALLEL_PHASE_MIN_ENTITIES;
+    for (const std::vector<size_t> &phase : phases_) {
+        if (!parallel) {
+            for (size_t system : phase) {
+                systems_[system].run();
+            }
+            continue;
+        }
+        jobs.ParallelFor(phase.size(), 1, [this, &phase](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                systems_[phase[i]].run();
+            }
+        });
+    }
+}
@@ -0,0 +1,173 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+constexpr ComponentId kMaxComponents = 64;
+
+namespace ecs_detail {
+ComponentId RegisterComponent(size_t size);
+size_t ComponentSize(ComponentId id);
+} // namespace ecs_detail
+
+// Components are plain data; every type gets a process-wide id on first use.
+template <typename T> ComponentId ComponentIdOf() {
+    static_assert(std::is_trivially_copyable<T>::value, "components must be plain data");
+    static const ComponentId id = ecs_detail::RegisterComponent(sizeof(T));
+    return id;
+}
+
+template <typename... Cs> ComponentMask MaskOf() {
+    return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentIdOf<Cs>()));
+}
+
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool Valid() const { return index != UINT32_MAX; }
+    bool operator==(const Entity &other) const { return index == other.index && generation == other.generation; }
+};
+
+// All entities with exactly the same component set, one contiguous column per component.
+class Archetype {
+public:
+    explicit Archetype(ComponentMask mask);
+
+    ComponentMask Mask() const { return mask_; }
+    size_t Size() const { return entities_.size(); }
+    const Entity *Entities() const { return entities_.data(); }
+
+    template <typename T> T *Column() { return reinterpret_cast<T *>(ColumnData(ComponentIdOf<T>())); }
+    uint8_t *ColumnData(ComponentId id);
+
+    // Appends a zero-initialised row and returns its index.
+    size_t Append(Entity entity);
+    // Moves the last row into row and shrinks by one. Returns the entity that now lives at row, if any.
+    Entity SwapRemove(size_t row);
+    void Clear();
+    // Heap bytes reserved by the columns and entity list.
+    size_t CapacityBytes() const;
+
+private:
+    struct ColumnStorage {
+        ComponentId id;
+        size_t elementSize;
+        std::vector<uint8_t> bytes;
+    };
+
+    ComponentMask mask_;
+    std::vector<ColumnStorage> columns_;
+    int8_t columnIndex_[kMaxComponents];
+    std::vector<Entity> entities_;
+};
+
+struct SystemDesc {
+    const char *name;
+    ComponentMask reads;
+    ComponentMask writes;
+    std::function<void()> run;
+};
+
+class World {
+public:
+    template <typename... Cs> Entity Create(const Cs &...components);
+    void Destroy(Entity entity);
+    bool Alive(Entity entity) const;
+    void Clear();
+
+    template <typename T> T *Get(Entity entity);
+
+    // Calls fn(archetype) for every non-empty archetype holding at least the components Cs.
+    template <typename... Cs, typename Fn> void ForEachArchetype(Fn &&fn);
+    // Calls fn(entity, Cs&...) for every matching entity.
+    template <typename... Cs, typename Fn> void Each(Fn &&fn);
+    template <typename... Cs> size_t Count();
+    // Heap bytes reserved for component storage and entity records.
+    size_t CapacityBytes() const;
+
+    // Systems run in registration order. Consecutive systems whose read/write sets do not conflict
+    // form one phase and run concurrently on the job system once the world holds enough entities to pay
+    // for it.
+    void RegisterSystem(const SystemDesc &system);
+    void RunSystems(JobSystem &jobs);
+
+private:
+    struct Record {
+        Archetype *archetype = nullptr;
+        size_t row = 0;
+        uint32_t generation = 0;
+    };
+
+    Entity Allocate();
+    Archetype *GetOrCreateArchetype(ComponentMask mask);
+    void BuildPhases();
+
+    std::vector<Record> records_;
+    std::vector<uint32_t> freeIndices_;
+    std::vector<std::unique_ptr<Archetype>> archetypes_;
+    std::unordered_map<ComponentMask, Archetype *> archetypeByMask_;
+    std::vector<SystemDesc> systems_;
+    std::vector<std::vector<size_t>> phases_;
+    bool phasesDirty_ = false;
+};
+
+template <typename... Cs> Entity World::Create(const Cs &...components) {
+    Entity entity = Allocate();
+    Archetype *archetype = GetOrCreateArchetype(MaskOf<Cs...>());
+    size_t row = archetype->Append(entity);
+    ((archetype->Column<Cs>()[row] = components), ...);
+    records_[entity.index].archetype = archetype;
+    records_[entity.index].row = row;
+    return entity;
+}
+
+template <typename T> T *World::Get(Entity entity) {
+    if (!Alive(entity)) {
+        return nullptr;
+    }
+    const Record &record = records_[entity.index];
+    if ((record.archetype->Mask() & MaskOf<T>()) == 0) {
+        return nullptr;
+    }
+    return record.archetype->Column<T>() + record.row;
+}
+
+template <typename... Cs, typename Fn> void World::ForEachArchetype(Fn &&fn) {
+    const ComponentMask mask = MaskOf<Cs...>();
+    for (auto &archetype : archetypes_) {
+        if ((archetype->Mask() & mask) == mask && archetype->Size() > 0) {
+            fn(*archetype);
+        }
+    }
+}
+
+template <typename... Cs, typename Fn> void World::Each(Fn &&fn) {
+    ForEachArchetype<Cs...>([&fn](Archetype &archetype) {
+        const Entity *entities = archetype.Entities();
+        auto columns = std::make_tuple(archetype.Column<Cs>()...);
+        for (size_t row = 0; row < archetype.Size(); row++) {
+            fn(entities[row], std::get<Cs *>(columns)[row]...);
+        }
+    });
+}
+
+template <typename... Cs> size_t World::Count() {
+    size_t count = 0;
+    ForEachArchetype<Cs...>([&count](Archetype &archetype) { count += archetype.Size(); });
+    return count;
+}
+
+#endif // ECS_H
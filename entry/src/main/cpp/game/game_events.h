@@ -0,0 +1,22 @@
+#ifndef GAME_EVENTS_H
+#define GAME_EVENTS_H
+
+#include <cstdint>
+
+// Values are part of the JS interface (EngineEventType in Index.d.ts).
+enum class GameEventType : uint8_t {
+    ScoreChanged = 0, // value: new score
+    Spawn,            // x, y: spawn position
+    Collision,        // value: score, x, y: obstacle position at impact
+    GameOver,         // value: final score
+    StateChanged,     // value: FrameState (0 playing, 1 paused, 2 game over)
+    Count
+};
+
+struct GameEvent {
+    GameEventType type;
+    int32_t value;
+    float x, y;
+};
+
+#endif // GAME_EVENTS_H
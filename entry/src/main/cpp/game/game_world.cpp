@@ -0,0 +1,542 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "collision.h"
+#include "game_world.h"
+#include "job_system.h"
+#include "plugin_common.h"
+#include "tracing.h"
+#include "world_snapshot.h"
+
+namespace {
+// Entities per simulation job. Fixed, so chunking and results do not depend on the thread count.
+const size_t SIM_CHUNK_SIZE = 64;
+
+// Positions are sprite centres, as they are drawn; boxes and the masks placed on them start at the minimum
+// corner.
+Aabb ToAabb(const Position &position, const Extent &extent) {
+    return {position.x - extent.width / 2, position.y - extent.height / 2, extent.width, extent.height};
+}
+
+// Earliest time in [toi, 1] at which the obstacle's mask touches the player's while the obstacle moves by
+// (dx, dy) from box. Sampled at least once per collision cell of travel, so thin parts are not skipped.
+bool SweptMasksOverlap(const CollisionMask &mask, const Aabb &box, float dx, float dy,
+                       const CollisionMask &playerMask, int32_t playerX, int32_t playerY, float &toi) {
+    float travel = std::max(std::fabs(dx), std::fabs(dy)) * (1.0f - toi) * COLLISION_CELLS_PER_NDC;
+    int steps = static_cast<int>(std::ceil(travel));
+    float start = toi;
+    for (int step = 0; step <= steps; step++) {
+        float t = steps > 0 ? start + (1.0f - start) * step / steps : start;
+        if (MasksOverlap(mask, ToCollisionCells(box.x + dx * t), ToCollisionCells(box.y + dy * t), playerMask,
+                         playerX, playerY)) {
+            toi = t;
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+GameWorld::GameWorld() : spawnTable_(SpawnTable::FromText(DEFAULT_SPAWN_WAVES)) { RegisterSystems(); }
+
+void GameWorld::RegisterSystems() {
+    world_.RegisterSystem(
+        {"PlayerInput", MaskOf<PlayerControl, Extent>(), MaskOf<Position>(), [this] { ApplyInput(); }});
+    world_.RegisterSystem({"Integrate", MaskOf<Velocity>(), MaskOf<Position>(), [this] { Integrate(*jobs_); }});
+    world_.RegisterSystem(
+        {"Collide", MaskOf<Position, Velocity, Extent, CollisionShape, PlayerControl, Obstacle>(), 0,
+         [this] { Collide(*jobs_); }});
+    world_.RegisterSystem({"Retire", MaskOf<Position, Obstacle>(), 0, [this] { Retire(*jobs_); }});
+}
+
+void GameWorld::Init() {
+    world_.Clear();
+    Extent extent {0.15f, 0.15f};
+    player_ = world_.Create(Position {0.0f, -0.8f}, extent, PlayerControl {0.04f}, Sprite {0.0f, 1.0f, 1.0f, 1.0f},
+                            CollisionShape {0, BakeShape(0, true, extent)});
+    pendingMoves_.store(0);
+    events_.clear();
+
+    score_ = 0;
+    gameOver_.store(false);
+    accumulator_ = 0.0f;
+    alpha_ = 1.0f;
+    simSeconds_ = 0.0;
+    seed_ = spawnTable_ && spawnTable_->Header().seed ? spawnTable_->Header().seed : std::random_device {}();
+    spawner_.Reset(spawnTable_, seed_);
+    hasPendingSpawner_ = false;
+    LOGI("Game initialized");
+}
+
+void GameWorld::TakeEvents(std::vector<GameEvent> &out) {
+    out.swap(events_);
+    events_.clear();
+}
+
+void GameWorld::SetTickRate(int ticksPerSecond) {
+    tickSeconds_ = 1.0f / std::clamp(ticksPerSecond, 10, 240);
+    accumulator_ = 0.0f;
+    alpha_ = 1.0f;
+}
+
+void GameWorld::SetSpawnTable(std::shared_ptr<const SpawnTable> table) {
+    spawnTable_ = std::move(table);
+    SpawnScheduler::Checkpoint current;
+    spawner_.Save(current);
+    // The table a restored snapshot was walking resumes that walk; the same table again keeps the current one.
+    bool resumed = hasPendingSpawner_ && spawner_.Restore(spawnTable_, pendingSpawner_);
+    if (!resumed && !spawner_.Restore(spawnTable_, current)) {
+        spawner_.Reset(spawnTable_, seed_, static_cast<uint32_t>(simSeconds_ * 1000.0));
+    }
+    hasPendingSpawner_ = false;
+}
+
+void GameWorld::SetCollisionMasks(std::shared_ptr<const CollisionAtlas> atlas) {
+    collisionAtlas_ = atlas && atlas->FrameCount() > 0 ? std::move(atlas) : nullptr;
+    bakedShapes_.clear();
+    bakedMasks_.clear();
+    world_.Each<Extent, CollisionShape>([this](Entity entity, const Extent &extent, CollisionShape &shape) {
+        shape.mask = BakeShape(shape.variant, entity == player_, extent);
+    });
+    size_t bytes = 0;
+    for (const CollisionMask &mask : bakedMasks_) {
+        bytes += mask.Bytes();
+    }
+    LOGI("Collision masks %{public}s: %{public}zu frames, %{public}zu shapes baked in %{public}zu bytes",
+         collisionAtlas_ ? "on" : "off", collisionAtlas_ ? collisionAtlas_->FrameCount() : 0, bakedMasks_.size(),
+         bytes);
+}
+
+uint16_t GameWorld::BakeShape(uint16_t variant, bool player, const Extent &extent) {
+    if (!collisionAtlas_) {
+        return NO_COLLISION_MASK;
+    }
+    size_t frames = collisionAtlas_->FrameCount();
+    size_t frame = player || frames == 1 ? 0 : 1 + variant % (frames - 1);
+    int32_t width = ToCollisionCells(extent.width);
+    int32_t height = ToCollisionCells(extent.height);
+    for (size_t i = 0; i < bakedShapes_.size(); i++) {
+        const BakedShape &baked = bakedShapes_[i];
+        if (baked.frame == frame && baked.width == width && baked.height == height) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    if (bakedMasks_.size() >= NO_COLLISION_MASK) {
+        return NO_COLLISION_MASK;
+    }
+    bakedShapes_.push_back({frame, width, height});
+    bakedMasks_.push_back(collisionAtlas_->Frame(frame).Resampled(width, height));
+    return static_cast<uint16_t>(bakedMasks_.size() - 1);
+}
+
+CollisionStats GameWorld::TakeCollisionStats() {
+    CollisionStats stats = collisionStats_;
+    collisionStats_ = {};
+    return stats;
+}
+
+bool GameWorld::SaveSnapshot(uint32_t frame, std::vector<uint8_t> &out) {
+    TRACE_SCOPE("SaveSnapshot");
+    spawner_.Save(snapshotSpawner_);
+    size_t entities = 0;
+    world_.ForEachArchetype<Position, Extent, Sprite>([&entities](Archetype &archetype) {
+        if (archetype.Column<PlayerControl>() || archetype.Column<Obstacle>()) {
+            entities += archetype.Size();
+        }
+    });
+    if (entities > UINT16_MAX || snapshotSpawner_.active.size() > UINT16_MAX) {
+        LOGE("World snapshot refused: %{public}zu entities, %{public}zu active waves", entities,
+             snapshotSpawner_.active.size());
+        out.clear();
+        return false;
+    }
+    out.resize(sizeof(WorldSnapshotHeader) + entities * sizeof(WorldSnapshotEntity) +
+               snapshotSpawner_.active.size() * sizeof(WorldSnapshotWave));
+
+    WorldSnapshotHeader header {};
+    header.entityCount = static_cast<uint16_t>(entities);
+    header.frame = frame;
+    header.score = score_;
+    header.simSeconds = simSeconds_;
+    header.tickSeconds = tickSeconds_;
+    header.accumulator = accumulator_;
+    header.alpha = alpha_;
+    header.pendingMoves = pendingMoves_.load();
+    header.seed = seed_;
+    header.spawnSourceHash = snapshotSpawner_.sourceHash;
+    header.spawnResetMs = snapshotSpawner_.resetMs;
+    header.spawnCursor = snapshotSpawner_.cursor;
+    header.activeWaveCount = static_cast<uint16_t>(snapshotSpawner_.active.size());
+    header.collisionMode = static_cast<uint8_t>(collisionMode_);
+    header.gameOver = gameOver_.load() ? 1 : 0;
+    memcpy(out.data(), &header, sizeof(header));
+
+    // Archetype by archetype and row by row, so a restore recreates the same iteration order.
+    uint8_t *cursor = out.data() + sizeof(WorldSnapshotHeader);
+    world_.ForEachArchetype<Position, Extent, Sprite>([&cursor](Archetype &archetype) {
+        const PlayerControl *controls = archetype.Column<PlayerControl>();
+        if (!controls && !archetype.Column<Obstacle>()) {
+            return;
+        }
+        const Position *positions = archetype.Column<Position>();
+        const Extent *extents = archetype.Column<Extent>();
+        const Sprite *sprites = archetype.Column<Sprite>();
+        const Velocity *velocities = archetype.Column<Velocity>();
+        const CollisionShape *shapes = archetype.Column<CollisionShape>();
+        for (size_t i = 0; i < archetype.Size(); i++) {
+            WorldSnapshotEntity record {};
+            record.kind = static_cast<uint8_t>(controls ? SnapshotEntityKind::Player : SnapshotEntityKind::Obstacle);
+            record.collisionVariant = shapes ? shapes[i].variant : 0;
+            record.x = positions[i].x;
+            record.y = positions[i].y;
+            record.velocityX = velocities ? velocities[i].x : 0.0f;
+            record.velocityY = velocities ? velocities[i].y : 0.0f;
+            record.width = extents[i].width;
+            record.height = extents[i].height;
+            record.r = sprites[i].r;
+            record.g = sprites[i].g;
+            record.b = sprites[i].b;
+            record.a = sprites[i].a;
+            record.speed = controls ? controls[i].speed : 0.0f;
+            memcpy(cursor, &record, sizeof(record));
+            cursor += sizeof(record);
+        }
+    });
+    for (const SpawnScheduler::ActiveWave &active : snapshotSpawner_.active) {
+        WorldSnapshotWave wave {active.wave, active.nextMs, active.trigger};
+        memcpy(cursor, &wave, sizeof(wave));
+        cursor += sizeof(wave);
+    }
+    SealWorldSnapshot(out);
+    return true;
+}
+
+bool GameWorld::RestoreSnapshot(const std::vector<uint8_t> &snapshot, uint32_t &frame) {
+    if (!ValidateWorldSnapshot(snapshot.data(), snapshot.size())) {
+        return false;
+    }
+    WorldSnapshotHeader header;
+    memcpy(&header, snapshot.data(), sizeof(header));
+    const uint8_t *records = snapshot.data() + sizeof(WorldSnapshotHeader);
+    int players = 0;
+    for (uint16_t i = 0; i < header.entityCount; i++) {
+        uint8_t kind = records[i * sizeof(WorldSnapshotEntity)];
+        players += kind == static_cast<uint8_t>(SnapshotEntityKind::Player) ? 1 : 0;
+        if (kind > static_cast<uint8_t>(SnapshotEntityKind::Obstacle)) {
+            return false;
+        }
+    }
+    if (players != 1 || !(header.tickSeconds > 0.0f)) {
+        LOGE("World snapshot rejected: %{public}d players, tick %{public}f s", players, header.tickSeconds);
+        return false;
+    }
+
+    world_.Clear();
+    for (uint16_t i = 0; i < header.entityCount; i++) {
+        WorldSnapshotEntity record;
+        memcpy(&record, records + i * sizeof(WorldSnapshotEntity), sizeof(record));
+        Position position {record.x, record.y};
+        Extent extent {record.width, record.height};
+        Sprite sprite {record.r, record.g, record.b, record.a};
+        bool player = record.kind == static_cast<uint8_t>(SnapshotEntityKind::Player);
+        CollisionShape shape {record.collisionVariant, BakeShape(record.collisionVariant, player, extent)};
+        if (player) {
+            player_ = world_.Create(position, extent, PlayerControl {record.speed}, sprite, shape);
+        } else {
+            world_.Create(position, extent, Velocity {record.velocityX, record.velocityY}, Obstacle {}, sprite,
+                          shape);
+        }
+    }
+
+    pendingMoves_.store(header.pendingMoves);
+    inputApplied_ = false;
+    hit_ = false;
+    hitTime_ = 1.0f;
+    tickSeconds_ = header.tickSeconds;
+    accumulator_ = header.accumulator;
+    alpha_ = header.alpha;
+    collisionMode_ = header.collisionMode == static_cast<uint8_t>(CollisionMode::Discrete) ? CollisionMode::Discrete
+                                                                                          : CollisionMode::Swept;
+    simSeconds_ = header.simSeconds;
+    seed_ = header.seed;
+    score_ = header.score;
+    gameOver_.store(header.gameOver != 0);
+
+    SpawnScheduler::Checkpoint checkpoint;
+    checkpoint.sourceHash = header.spawnSourceHash;
+    checkpoint.seed = header.seed;
+    checkpoint.resetMs = header.spawnResetMs;
+    checkpoint.cursor = header.spawnCursor;
+    const uint8_t *waves = records + header.entityCount * sizeof(WorldSnapshotEntity);
+    for (uint16_t i = 0; i < header.activeWaveCount; i++) {
+        WorldSnapshotWave wave;
+        memcpy(&wave, waves + i * sizeof(WorldSnapshotWave), sizeof(wave));
+        checkpoint.active.push_back({wave.wave, wave.nextMs, wave.trigger});
+    }
+    hasPendingSpawner_ = !spawner_.Restore(spawnTable_, checkpoint);
+    if (hasPendingSpawner_) {
+        // Saved while another table was loaded: walk this one from here until that one comes back.
+        spawner_.Reset(spawnTable_, seed_, static_cast<uint32_t>(simSeconds_ * 1000.0));
+        pendingSpawner_ = std::move(checkpoint);
+    }
+
+    events_.clear();
+    events_.push_back({GameEventType::ScoreChanged, score_, 0.0f, 0.0f});
+    frame = header.frame;
+    LOGI("World restored: %{public}u entities, score %{public}d at %{public}.2f s%{public}s", header.entityCount,
+         score_, simSeconds_, hasPendingSpawner_ ? ", spawn table differs" : "");
+    return true;
+}
+
+void GameWorld::QueueMove(int direction) { pendingMoves_.fetch_add(direction > 0 ? 1 : -1); }
+
+void GameWorld::SpawnObstacle(const SpawnRequest &request) {
+    if (world_.Count<Obstacle>() >= obstacleLimit_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Extent extent {request.width, request.height};
+    uint16_t variant = static_cast<uint16_t>(request.wave);
+    world_.Create(Position {request.x, 1.2f}, extent, Velocity {0.0f, -request.speed}, Obstacle {},
+                  Sprite {1.0f, 0.2f, 0.2f, 1.0f}, CollisionShape {variant, BakeShape(variant, false, extent)});
+    events_.push_back({GameEventType::Spawn, 0, request.x, 1.2f});
+}
+
+namespace {
+// One queued move; the edge rule nudges the player back inside when it would leave the screen.
+float StepPlayer(float x, int direction, const Extent &extent, const PlayerControl &control) {
+    if (direction < 0) {
+        x -= control.speed;
+        if (x - extent.width / 2 < -1.0f) {
+            x = -1.0f + extent.width / 5;
+        }
+    } else {
+        x += control.speed;
+        if (x + extent.width / 2 > 1.0f) {
+            x = 1.0f - extent.width / 5;
+        }
+    }
+    return x;
+}
+} // namespace
+
+void GameWorld::ApplyInput() {
+    int moves = pendingMoves_.exchange(0);
+    if (moves != 0) {
+        inputApplied_ = true;
+    }
+    world_.Each<Position, Extent, PlayerControl>(
+        [moves](Entity, Position &position, const Extent &extent, const PlayerControl &control) {
+            for (int i = 0; i < std::abs(moves); i++) {
+                position.x = StepPlayer(position.x, moves, extent, control);
+            }
+        });
+}
+
+float GameWorld::PredictPlayerX(int pendingMoves, float extraMoves) {
+    const Position *position = world_.Get<Position>(player_);
+    const Extent *extent = world_.Get<Extent>(player_);
+    const PlayerControl *control = world_.Get<PlayerControl>(player_);
+    if (!position || !extent || !control) {
+        return position ? position->x : 0.0f;
+    }
+    float x = position->x;
+    for (int i = 0; i < std::abs(pendingMoves); i++) {
+        x = StepPlayer(x, pendingMoves, *extent, *control);
+    }
+    // The extrapolated part is continuous, so clamp it to where the edge rule would settle.
+    float limit = 1.0f - extent->width / 5;
+    return std::clamp(x + extraMoves * control->speed, std::min(x, -limit), std::max(x, limit));
+}
+
+bool GameWorld::TakeInputApplied() {
+    bool applied = inputApplied_;
+    inputApplied_ = false;
+    return applied;
+}
+
+void GameWorld::Integrate(JobSystem &jobs) {
+    const float dt = tickSeconds_;
+    world_.ForEachArchetype<Position, Velocity>([&jobs, dt](Archetype &archetype) {
+        Position *positions = archetype.Column<Position>();
+        const Velocity *velocities = archetype.Column<Velocity>();
+        jobs.ParallelFor(archetype.Size(), SIM_CHUNK_SIZE, [=](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                positions[i].x += velocities[i].x * dt;
+                positions[i].y += velocities[i].y * dt;
+            }
+        });
+    });
+}
+
+void GameWorld::Collide(JobSystem &jobs) {
+    hit_ = false;
+    hitTime_ = 1.0f;
+    hitObstacle_ = Entity {};
+    const Position *playerPosition = world_.Get<Position>(player_);
+    const Extent *playerExtent = world_.Get<Extent>(player_);
+    const CollisionShape *playerShape = world_.Get<CollisionShape>(player_);
+    if (!playerPosition || !playerExtent) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const Aabb player = ToAabb(*playerPosition, *playerExtent);
+    const bool swept = collisionMode_ == CollisionMode::Swept;
+    const float dt = tickSeconds_;
+    // Without a player mask every box hit stands.
+    const CollisionMask *playerMask =
+        playerShape && playerShape->mask != NO_COLLISION_MASK ? &bakedMasks_[playerShape->mask] : nullptr;
+    const int32_t playerX = ToCollisionCells(player.x);
+    const int32_t playerY = ToCollisionCells(player.y);
+
+    world_.ForEachArchetype<Position, Velocity, Extent, Obstacle>([&](Archetype &archetype) {
+        const Position *positions = archetype.Column<Position>();
+        const Velocity *velocities = archetype.Column<Velocity>();
+        const Extent *extents = archetype.Column<Extent>();
+        const CollisionShape *shapes = archetype.Column<CollisionShape>();
+        const Entity *entities = archetype.Entities();
+        size_t chunks = JobSystem::ChunkCount(archetype.Size(), SIM_CHUNK_SIZE);
+        // Earliest time of impact per chunk and the obstacle it belongs to; 2 means no hit.
+        chunkHitTimes_.assign(chunks, 2.0f);
+        chunkHitObstacles_.assign(chunks, Entity {});
+        chunkCollisionStats_.assign(chunks, CollisionStats {});
+        jobs.ParallelFor(archetype.Size(), SIM_CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            float &earliest = chunkHitTimes_[chunk];
+            CollisionStats &stats = chunkCollisionStats_[chunk];
+            for (size_t i = begin; i < end; i++) {
+                Aabb obstacle = ToAabb(positions[i], extents[i]);
+                float toi = 1.0f;
+                float dx = 0.0f;
+                float dy = 0.0f;
+                if (swept) {
+                    // Sweep from where the obstacle was at the start of this tick, the player is static.
+                    dx = velocities[i].x * dt;
+                    dy = velocities[i].y * dt;
+                    obstacle.x -= dx;
+                    obstacle.y -= dy;
+                    if (!SweptOverlaps(obstacle, dx, dy, player, toi)) {
+                        continue;
+                    }
+                } else if (!Overlaps(player, obstacle)) {
+                    continue;
+                }
+                stats.boxHits++;
+                // The boxes touch; with masks on both sides the hit only stands if solid cells meet.
+                if (playerMask && shapes && shapes[i].mask != NO_COLLISION_MASK) {
+                    stats.maskTests++;
+                    if (!SweptMasksOverlap(bakedMasks_[shapes[i].mask], obstacle, dx, dy, *playerMask, playerX,
+                                           playerY, toi)) {
+                        stats.maskMisses++;
+                        continue;
+                    }
+                }
+                if (toi < earliest) {
+                    earliest = toi;
+                    chunkHitObstacles_[chunk] = entities[i];
+                }
+            }
+        });
+        // Ties go to the first chunk, whatever thread finished first.
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            float chunkTime = chunkHitTimes_[chunk];
+            if (chunkTime <= 1.0f && (!hit_ || chunkTime < hitTime_)) {
+                hit_ = true;
+                hitTime_ = chunkTime;
+                hitObstacle_ = chunkHitObstacles_[chunk];
+            }
+        }
+        for (const CollisionStats &stats : chunkCollisionStats_) {
+            collisionStats_.boxHits += stats.boxHits;
+            collisionStats_.maskTests += stats.maskTests;
+            collisionStats_.maskMisses += stats.maskMisses;
+        }
+    });
+    float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    collisionStats_.ticks++;
+    collisionStats_.totalUs += us;
+    collisionStats_.maxUs = std::max(collisionStats_.maxUs, us);
+}
+
+void GameWorld::Retire(JobSystem &jobs) {
+    retired_.clear();
+    world_.ForEachArchetype<Position, Obstacle>([&](Archetype &archetype) {
+        const Position *positions = archetype.Column<Position>();
+        const Entity *entities = archetype.Entities();
+        size_t chunks = JobSystem::ChunkCount(archetype.Size(), SIM_CHUNK_SIZE);
+        if (chunkRetired_.size() < chunks) {
+            chunkRetired_.resize(chunks);
+        }
+        jobs.ParallelFor(archetype.Size(), SIM_CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<Entity> &out = chunkRetired_[chunk];
+            out.clear();
+            for (size_t i = begin; i < end; i++) {
+                if (positions[i].y < -1.5f) {
+                    out.push_back(entities[i]);
+                }
+            }
+        });
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            retired_.insert(retired_.end(), chunkRetired_[chunk].begin(), chunkRetired_[chunk].end());
+        }
+    });
+}
+
+void GameWorld::Advance(JobSystem &jobs, float deltaSeconds) {
+    if (gameOver_.load()) {
+        return;
+    }
+
+    // Fixed steps keep the rules independent of the display rate; a long stall only catches up a few ticks.
+    accumulator_ = std::min(accumulator_ + std::max(0.0f, deltaSeconds), tickSeconds_ * kMaxTicksPerFrame);
+    while (accumulator_ >= tickSeconds_ && !gameOver_.load()) {
+        accumulator_ -= tickSeconds_;
+        Tick(jobs);
+    }
+    alpha_ = gameOver_.load() ? 1.0f : accumulator_ / tickSeconds_;
+}
+
+void GameWorld::Tick(JobSystem &jobs) {
+    TRACE_SCOPE("Tick");
+    // Input, integration, then collision and retirement side by side; none of them changes the layout.
+    jobs_ = &jobs;
+    world_.RunSystems(jobs);
+    jobs_ = nullptr;
+
+    if (hit_) {
+        // Freeze the scene at the moment of contact rather than at the end of the tick.
+        float rewind = (1.0f - hitTime_) * tickSeconds_;
+        world_.Each<Position, Velocity>([rewind](Entity, Position &position, const Velocity &velocity) {
+            position.x -= velocity.x * rewind;
+            position.y -= velocity.y * rewind;
+        });
+
+        gameOver_.store(true);
+        LOGI("COLLISION! GAME OVER! Final Score: %{public}d", score_);
+        const Position *obstacle = world_.Get<Position>(hitObstacle_);
+        events_.push_back(
+            {GameEventType::Collision, score_, obstacle ? obstacle->x : 0.0f, obstacle ? obstacle->y : 0.0f});
+        events_.push_back({GameEventType::GameOver, score_, 0.0f, 0.0f});
+        return;
+    }
+
+    // Structural changes happen here, after every system has finished.
+    for (const Entity &entity : retired_) {
+        world_.Destroy(entity);
+    }
+    int retired = static_cast<int>(retired_.size());
+    score_ += retired * 10;
+    if (retired > 0) {
+        events_.push_back({GameEventType::ScoreChanged, score_, 0.0f, 0.0f});
+    }
+
+    bool allInactive = world_.Count<Obstacle>() + retired == 0;
+    simSeconds_ += tickSeconds_;
+    spawnRequests_.clear();
+    spawner_.Advance(static_cast<uint32_t>(simSeconds_ * 1000.0), score_, allInactive, spawnRequests_);
+    for (const SpawnRequest &request : spawnRequests_) {
+        SpawnObstacle(request);
+    }
+}
@@ -0,0 +1,169 @@
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "collision_mask.h"
+#include "components.h"
+#include "ecs.h"
+#include "game_events.h"
+#include "spawn_schedule.h"
+
+class JobSystem;
+
+enum class CollisionMode { Discrete = 0, Swept };
+
+struct CollisionStats {
+    uint32_t ticks = 0;
+    // Obstacles whose box reached the player's, how many of those went on to the mask test, and how many
+    // the masks cleared.
+    uint64_t boxHits = 0;
+    uint64_t maskTests = 0;
+    uint64_t maskMisses = 0;
+    float totalUs = 0.0f;
+    float maxUs = 0.0f;
+};
+
+// Game rules on top of the entity store. The simulation runs at a fixed tick rate independent of the
+// display: Advance is called once per rendered frame on the render thread and runs as many ticks as
+// the elapsed time covers. QueueMove may be called from any thread and is applied at the next tick.
+class GameWorld {
+public:
+    static constexpr int kDefaultTickRate = 30;
+    static constexpr int kMaxTicksPerFrame = 4;
+    static constexpr size_t kDefaultObstacleLimit = 25;
+    // Snapshots count the player and the obstacles in 16 bits.
+    static constexpr size_t kMaxObstacleLimit = UINT16_MAX - 1;
+
+    GameWorld();
+
+    void Init();
+    void Advance(JobSystem &jobs, float deltaSeconds);
+    void QueueMove(int direction);
+    // Render thread only.
+    void SetTickRate(int ticksPerSecond);
+    void SetCollisionMode(CollisionMode mode) { collisionMode_ = mode; }
+    // Most obstacles alive at once, up to kMaxObstacleLimit; spawns beyond it are dropped. Any thread, from the
+    // next spawn.
+    void SetObstacleLimit(size_t limit) {
+        obstacleLimit_.store(std::min(limit, kMaxObstacleLimit), std::memory_order_relaxed);
+    }
+    // With an atlas, boxes that touch only count as a hit if their masks do: frame 0 is the player's,
+    // obstacles take the other frames by spawning wave. Null goes back to boxes alone.
+    void SetCollisionMasks(std::shared_ptr<const CollisionAtlas> atlas);
+    // Returns the counters accumulated since the previous call.
+    CollisionStats TakeCollisionStats();
+    // A different table takes effect immediately; waves already under way fire one period from now.
+    void SetSpawnTable(std::shared_ptr<const SpawnTable> table);
+
+    bool IsGameOver() const { return gameOver_.load(); }
+    int Score() const { return score_; }
+    double SimSeconds() const { return simSeconds_; }
+    int ObstacleCount() { return static_cast<int>(world_.Count<Obstacle>()); }
+    const Position *PlayerPosition() { return world_.Get<Position>(player_); }
+    Entity Player() const { return player_; }
+    // Moves queued since the last tick.
+    int PendingMoves() const { return pendingMoves_.load(); }
+    // Player x once the pending moves and extraMoves more (fractional, either sign) have been applied,
+    // following the same edge rules as the simulation. Render thread, between ticks.
+    float PredictPlayerX(int pendingMoves, float extraMoves);
+    // True if a tick since the last call applied queued moves.
+    bool TakeInputApplied();
+    World &Entities() { return world_; }
+    // Events raised by the ticks since the last call, oldest first. Clears the list.
+    void TakeEvents(std::vector<GameEvent> &out);
+
+    // The whole simulation in the world_snapshot.h format, frame included for the caller. Render thread,
+    // between ticks. out is reused, so steady-state saves do not allocate. False, with out emptied, when the
+    // world holds more entities or waves than the format can count.
+    bool SaveSnapshot(uint32_t frame, std::vector<uint8_t> &out);
+    // Replaces the world with a validated snapshot and returns its frame; false leaves the world unchanged.
+    bool RestoreSnapshot(const std::vector<uint8_t> &snapshot, uint32_t &frame);
+
+    // Calls fn(entity, x, y, extent, sprite) for every sprite in creation order of its archetype, with the
+    // position interpolated between the last two ticks for the time elapsed since the latest one.
+    template <typename Fn> void EachSprite(Fn &&fn);
+
+private:
+    void Tick(JobSystem &jobs);
+    void RegisterSystems();
+    void ApplyInput();
+    void Integrate(JobSystem &jobs);
+    void Collide(JobSystem &jobs);
+    void Retire(JobSystem &jobs);
+    void SpawnObstacle(const SpawnRequest &request);
+    // Mask for a shape of this extent, baked on first use; NO_COLLISION_MASK without an atlas.
+    uint16_t BakeShape(uint16_t variant, bool player, const Extent &extent);
+
+    World world_;
+    JobSystem *jobs_ = nullptr;
+    Entity player_;
+    std::atomic<int> pendingMoves_ {0};
+    bool inputApplied_ = false;
+    // Per-chunk results, reduced in chunk order so the outcome does not depend on the thread count.
+    std::vector<float> chunkHitTimes_;
+    std::vector<Entity> chunkHitObstacles_;
+    std::vector<std::vector<Entity>> chunkRetired_;
+    std::vector<Entity> retired_;
+    bool hit_ = false;
+    float hitTime_ = 1.0f;
+    // The obstacle with the earliest impact this tick; the Collision event reports where it was.
+    Entity hitObstacle_;
+
+    std::shared_ptr<const CollisionAtlas> collisionAtlas_;
+    struct BakedShape {
+        size_t frame;
+        int32_t width, height;
+    };
+    // Read-only while the systems run; shapes are baked when entities are created.
+    std::vector<BakedShape> bakedShapes_;
+    std::vector<CollisionMask> bakedMasks_;
+    std::vector<CollisionStats> chunkCollisionStats_;
+    CollisionStats collisionStats_;
+
+    float tickSeconds_ = 1.0f / kDefaultTickRate;
+    float accumulator_ = 0.0f;
+    float alpha_ = 1.0f;
+    CollisionMode collisionMode_ = CollisionMode::Swept;
+    std::atomic<size_t> obstacleLimit_ {kDefaultObstacleLimit};
+    double simSeconds_ = 0.0;
+
+    std::shared_ptr<const SpawnTable> spawnTable_;
+    SpawnScheduler spawner_;
+    // Walk of a table other than the current one, from a snapshot; resumed if that table is loaded.
+    SpawnScheduler::Checkpoint pendingSpawner_;
+    bool hasPendingSpawner_ = false;
+    SpawnScheduler::Checkpoint snapshotSpawner_;
+    std::vector<SpawnRequest> spawnRequests_;
+    uint32_t seed_ = 0;
+
+    int score_ = 0;
+    std::atomic<bool> gameOver_ {false};
+    std::vector<GameEvent> events_;
+};
+
+template <typename Fn> void GameWorld::EachSprite(Fn &&fn) {
+    // Rendering trails the simulation by up to one tick: pull positions back along the last step.
+    float lag = (1.0f - alpha_) * tickSeconds_;
+    world_.ForEachArchetype<Position, Extent, Sprite>([&fn, lag](Archetype &archetype) {
+        const Entity *entities = archetype.Entities();
+        const Position *positions = archetype.Column<Position>();
+        const Extent *extents = archetype.Column<Extent>();
+        const Sprite *sprites = archetype.Column<Sprite>();
+        const Velocity *velocities = archetype.Column<Velocity>();
+        for (size_t i = 0; i < archetype.Size(); i++) {
+            float x = positions[i].x;
+            float y = positions[i].y;
+            if (velocities) {
+                x -= velocities[i].x * lag;
+                y -= velocities[i].y * lag;
+            }
+            fn(entities[i], x, y, extents[i], sprites[i]);
+        }
+    });
+}
+
+#endif // GAME_WORLD_H
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include "job_system.h"
+#include "tracing.h"
+
+namespace {
+// Index of the calling thread's own queue; threads the pool did not start use queue 0.
+thread_local int t_workerIndex = 0;
+} // namespace
+
+JobSystem::JobSystem(int workerCount) {
+    if (workerCount <= 0) {
+        workerCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    workerCount = std::clamp(workerCount, 1, kMaxWorkers);
+
+    for (int i = 0; i < workerCount; i++) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+void JobSystem::StartWorkers() {
+    std::call_once(startOnce_, [this] {
+        for (int i = 1; i < WorkerCount(); i++) {
+            threads_.emplace_back(&JobSystem::WorkerMain, this, i);
+        }
+        started_.store(true, std::memory_order_release);
+    });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_.store(true);
+    }
+    wake_.notify_all();
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+}
+
+void JobSystem::Submit(const Job &job) {
+    if (WorkerCount() > 1 && !WorkersStarted()) {
+        StartWorkers();
+    }
+    if (job.counter) {
+        job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    WorkerQueue &queue = *queues_[t_workerIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    if (WorkerCount() > 1) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        wake_.notify_one();
+    }
+}
+
+bool JobSystem::PopOrSteal(int self, Job &job) {
+    {
+        WorkerQueue &own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    int count = WorkerCount();
+    for (int offset = 1; offset < count; offset++) {
+        WorkerQueue &victim = *queues_[(self + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Execute(const Job &job) {
+    TRACE_SCOPE("job");
+    job.run(job.context, job.index);
+    if (job.counter && job.counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Taking the lock orders this with a waiter that has just seen the counter above zero.
+        std::lock_guard<std::mutex> lock(doneMutex_);
+        done_.notify_all();
+    }
+}
+
+void JobSystem::Wait(JobCounter &counter) {
+    Job job;
+    while (!counter.Done()) {
+        if (PopOrSteal(t_workerIndex, job)) {
+            Execute(job);
+            continue;
+        }
+        // Everything left is running on other workers.
+        std::unique_lock<std::mutex> lock(doneMutex_);
+        done_.wait(lock, [this, &counter] {
+            return counter.Done() || queued_.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+void JobSystem::WorkerMain(int index) {
+    t_workerIndex = index;
+    Tracer::SetThreadName("job worker");
+    Job job;
+    while (true) {
+        if (PopOrSteal(index, job)) {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stopping_.load() || queued_.load(std::memory_order_acquire) > 0; });
+        if (stopping_.load()) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Counts outstanding jobs. A phase that depends on earlier jobs waits for their counter to drain.
+struct JobCounter {
+    std::atomic<int> pending {0};
+    bool Done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job {
+    void (*run)(void *context, size_t index) = nullptr;
+    void *context = nullptr;
+    size_t index = 0;
+    JobCounter *counter = nullptr;
+};
+
+// Small work-stealing scheduler. Every worker owns a deque: it pushes and pops at the back, idle
+// workers steal from the front of the others. The thread that submits and waits (the render thread)
+// takes part as worker 0, so a JobSystem with one worker runs everything inline. Worker threads are only
+// started by the first range big enough to split; until then nothing but the caller runs.
+class JobSystem {
+public:
+    // workerCount includes the calling thread; 0 picks one per core, capped at kMaxWorkers.
+    explicit JobSystem(int workerCount = 0);
+    ~JobSystem();
+
+    static constexpr int kMaxWorkers = 8;
+
+    int WorkerCount() const { return static_cast<int>(queues_.size()); }
+    bool WorkersStarted() const { return started_.load(std::memory_order_acquire); }
+
+    void Submit(const Job &job);
+    // Runs queued jobs on the calling thread until the counter reaches zero, then sleeps until the
+    // workers finish the rest.
+    void Wait(JobCounter &counter);
+
+    // Splits [0, count) into chunks of grain items and calls fn(chunk, begin, end) for each, possibly in
+    // parallel. Chunk boundaries depend only on count and grain, never on the worker count, so per-chunk
+    // results combined in chunk order are identical for any number of threads.
+    template <typename Fn> void ParallelFor(size_t count, size_t grain, Fn &&fn);
+
+    static size_t ChunkCount(size_t count, size_t grain) { return grain == 0 ? 0 : (count + grain - 1) / grain; }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    template <typename Fn> struct RangeContext {
+        Fn *fn;
+        size_t count;
+        size_t grain;
+    };
+
+    void StartWorkers();
+    bool PopOrSteal(int self, Job &job);
+    void Execute(const Job &job);
+    void WorkerMain(int index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::mutex doneMutex_;
+    std::condition_variable done_;
+    std::once_flag startOnce_;
+    std::atomic<bool> started_ {false};
+    std::atomic<int> queued_ {0};
+    std::atomic<bool> stopping_ {false};
+};
+
+template <typename Fn> void JobSystem::ParallelFor(size_t count, size_t grain, Fn &&fn) {
+    size_t chunks = ChunkCount(count, grain);
+    if (chunks <= 1 || WorkerCount() == 1) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            size_t begin = chunk * grain;
+            fn(chunk, begin, begin + grain < count ? begin + grain : count);
+        }
+        return;
+    }
+
+    using FnType = typename std::remove_reference<Fn>::type;
+    RangeContext<FnType> context {&fn, count, grain};
+    JobCounter counter;
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        Job job;
+        job.run = [](void *ctx, size_t index) {
+            auto *range = static_cast<RangeContext<FnType> *>(ctx);
+            size_t begin = index * range->grain;
+            size_t end = begin + range->grain < range->count ? begin + range->grain : range->count;
+            (*range->fn)(index, begin, end);
+        };
+        job.context = &context;
+        job.index = chunk;
+        job.counter = &counter;
+        Submit(job);
+    }
+    Wait(counter);
+}
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,31 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstdint>
+
+// Philox-2x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// The output is a pure function of (counter, key), so a stream can be indexed directly: the n-th value
+// of a wave is the same no matter how many values other waves have drawn.
+struct Philox2x32 {
+    uint32_t lo;
+    uint32_t hi;
+};
+
+inline Philox2x32 Philox(uint64_t counter, uint32_t key) {
+    const uint32_t multiplier = 0xD256D193u;
+    const uint32_t weyl = 0x9E3779B9u;
+    uint32_t x0 = static_cast<uint32_t>(counter);
+    uint32_t x1 = static_cast<uint32_t>(counter >> 32);
+    for (int round = 0; round < 10; round++) {
+        uint64_t product = static_cast<uint64_t>(multiplier) * x0;
+        x0 = static_cast<uint32_t>(product >> 32) ^ key ^ x1;
+        x1 = static_cast<uint32_t>(product);
+        key += weyl;
+    }
+    return {x0, x1};
+}
+
+// Uniform float in [0, 1) from the top 24 bits.
+inline float PhiloxUnit(uint32_t bits) { return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f); }
+
+#endif // PHILOX_H
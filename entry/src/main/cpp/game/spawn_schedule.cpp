@@ -0,0 +1,350 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "philox.h"
+#include "spawn_schedule.h"
+#include "plugin_common.h"
+
+const char DEFAULT_SPAWN_WAVES[] =
+    "# Spawn waves. Compiled to spawn_waves.bin in the app files dir on first load.\n"
+    "# seed <n>           fixed seed for reproducible runs, 0 picks a new one every game\n"
+    "# wave key=value ... start/end/every in seconds, chance in percent, count per firing,\n"
+    "#                    x range and size in NDC, speed in NDC per second, growth in NDC per\n"
+    "#                    second per 1000 points, refill=1 fires whenever the field is empty\n"
+    "seed 0\n"
+    "wave start=0 every=0.417 chance=100 x=-0.75,0.75 size=0.12,0.12 speed=1.5 growth=0.48\n"
+    "wave start=0 every=0.167 chance=30 x=-0.75,0.75 size=0.12,0.12 speed=1.5 growth=0.48\n"
+    "wave start=0 refill=1 x=-0.75,0.75 size=0.12,0.12 speed=1.5 growth=0.48\n";
+
+namespace {
+uint32_t Fnv1a(const std::string &text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+bool ParseFloat(const std::string &value, float &out) {
+    char *end = nullptr;
+    out = strtof(value.c_str(), &end);
+    return end != value.c_str() && *end == '\0' && std::isfinite(out);
+}
+
+bool ParsePair(const std::string &value, float &first, float &second) {
+    size_t comma = value.find(',');
+    return comma != std::string::npos && ParseFloat(value.substr(0, comma), first) &&
+           ParseFloat(value.substr(comma + 1), second);
+}
+
+uint32_t ToMs(float seconds) { return static_cast<uint32_t>(std::lround(std::max(0.0f, seconds) * 1000.0f)); }
+
+int16_t ToNdcUnits(float value) {
+    return static_cast<int16_t>(std::clamp(std::lround(value * SPAWN_NDC_SCALE), -32767L, 32767L));
+}
+
+// Rules every record must meet, whether it was just parsed or comes from a mapped cache: the scheduler
+// loops on periodMs and divides the x range and sizes without further checks.
+bool CheckWave(const SpawnWaveRecord &wave, std::string &error) {
+    if (!(wave.flags & SPAWN_WAVE_REFILL) && wave.periodMs == 0) {
+        error = "periodic wave needs every > 0";
+    } else if (wave.endMs <= wave.startMs) {
+        error = "end must be after start";
+    } else if (wave.count == 0 || wave.chance > SPAWN_CHANCE_ALWAYS) {
+        error = "bad count or chance";
+    } else if (wave.xMin > wave.xMax) {
+        error = "bad x range";
+    } else if (wave.width == 0 || wave.height == 0) {
+        error = "size rounds to zero";
+    } else if (!std::isfinite(wave.speed) || !std::isfinite(wave.speedPerKiloPoint)) {
+        error = "bad speed";
+    }
+    return error.empty();
+}
+
+bool ParseWave(std::istringstream &tokens, SpawnWaveRecord &wave, std::string &error) {
+    wave = {};
+    wave.endMs = SPAWN_FOREVER;
+    wave.chance = SPAWN_CHANCE_ALWAYS;
+    wave.count = 1;
+    float xMin = -0.75f, xMax = 0.75f, width = 0.12f, height = 0.12f;
+    wave.speed = 1.5f;
+
+    std::string token;
+    while (tokens >> token) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            error = "expected key=value, got '" + token + "'";
+            return false;
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        float number = 0.0f;
+        bool ok = true;
+        if (key == "x") {
+            ok = ParsePair(value, xMin, xMax) && xMin <= xMax;
+        } else if (key == "size") {
+            ok = ParsePair(value, width, height) && width > 0.0f && height > 0.0f;
+        } else if (!ParseFloat(value, number)) {
+            ok = false;
+        } else if (key == "start") {
+            wave.startMs = ToMs(number);
+        } else if (key == "end") {
+            wave.endMs = ToMs(number);
+        } else if (key == "every") {
+            wave.periodMs = ToMs(number);
+        } else if (key == "chance") {
+            ok = number >= 0.0f && number <= 100.0f;
+            wave.chance = static_cast<uint16_t>(std::lround(number * 100.0f));
+        } else if (key == "count") {
+            ok = number >= 1.0f && number <= 255.0f;
+            wave.count = static_cast<uint8_t>(number);
+        } else if (key == "speed") {
+            wave.speed = number;
+        } else if (key == "growth") {
+            wave.speedPerKiloPoint = number;
+        } else if (key == "refill") {
+            wave.flags = number != 0.0f ? (wave.flags | SPAWN_WAVE_REFILL) : (wave.flags & ~SPAWN_WAVE_REFILL);
+        } else {
+            error = "unknown key '" + key + "'";
+            return false;
+        }
+        if (!ok) {
+            error = "bad value for '" + key + "'";
+            return false;
+        }
+    }
+
+    wave.xMin = ToNdcUnits(xMin);
+    wave.xMax = ToNdcUnits(xMax);
+    wave.width = static_cast<uint16_t>(ToNdcUnits(width));
+    wave.height = static_cast<uint16_t>(ToNdcUnits(height));
+    return CheckWave(wave, error);
+}
+} // namespace
+
+bool SpawnTable::Compile(const std::string &text, std::vector<uint8_t> &out) {
+    SpawnTableHeader header = {};
+    memcpy(header.magic, SPAWN_TABLE_MAGIC, sizeof(header.magic));
+    header.version = SPAWN_TABLE_VERSION;
+    header.sourceHash = Fnv1a(text);
+    std::vector<SpawnWaveRecord> waves;
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        std::istringstream tokens(line.substr(0, line.find('#')));
+        std::string keyword;
+        if (!(tokens >> keyword)) {
+            continue;
+        }
+
+        std::string error;
+        if (keyword == "seed") {
+            unsigned long seed = 0;
+            if (!(tokens >> seed)) {
+                error = "seed needs a number";
+            }
+            header.seed = static_cast<uint32_t>(seed);
+        } else if (keyword == "wave") {
+            SpawnWaveRecord wave;
+            if (ParseWave(tokens, wave, error)) {
+                waves.push_back(wave);
+            }
+        } else {
+            error = "unknown directive '" + keyword + "'";
+        }
+        if (!error.empty()) {
+            LOGE("spawn_waves.txt:%{public}d: %{public}s", lineNumber, error.c_str());
+            return false;
+        }
+    }
+    if (waves.empty() || waves.size() > UINT16_MAX) {
+        LOGE("spawn_waves.txt: expected 1 to 65535 waves, got %{public}zu", waves.size());
+        return false;
+    }
+
+    std::stable_sort(waves.begin(), waves.end(),
+                     [](const SpawnWaveRecord &a, const SpawnWaveRecord &b) { return a.startMs < b.startMs; });
+    header.waveCount = static_cast<uint16_t>(waves.size());
+    out.resize(sizeof(header) + waves.size() * sizeof(SpawnWaveRecord));
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), waves.data(), waves.size() * sizeof(SpawnWaveRecord));
+    return true;
+}
+
+bool SpawnTable::Validate(const uint8_t *data, size_t size, uint32_t sourceHash) {
+    if (size < sizeof(SpawnTableHeader)) {
+        return false;
+    }
+    const SpawnTableHeader *header = reinterpret_cast<const SpawnTableHeader *>(data);
+    if (memcmp(header->magic, SPAWN_TABLE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SPAWN_TABLE_VERSION || header->sourceHash != sourceHash || header->waveCount == 0 ||
+        size != sizeof(SpawnTableHeader) + header->waveCount * sizeof(SpawnWaveRecord)) {
+        return false;
+    }
+    // The hash only covers the text, so a damaged file passes the header checks; hold every record to the
+    // rules Compile applies, plus the start order the scheduler walks them in.
+    const SpawnWaveRecord *waves = reinterpret_cast<const SpawnWaveRecord *>(data + sizeof(SpawnTableHeader));
+    for (size_t i = 0; i < header->waveCount; i++) {
+        std::string error;
+        if (!CheckWave(waves[i], error) || (i > 0 && waves[i].startMs < waves[i - 1].startMs)) {
+            LOGW("Spawn table cache: wave %{public}zu is damaged (%{public}s), recompiling", i,
+                 error.empty() ? "out of order" : error.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+SpawnTable::~SpawnTable() {
+    if (mapped_) {
+        munmap(mapped_, mappedSize_);
+    }
+}
+
+std::shared_ptr<SpawnTable> SpawnTable::FromText(const std::string &text) {
+    std::shared_ptr<SpawnTable> table(new SpawnTable());
+    if (!Compile(text, table->owned_)) {
+        return nullptr;
+    }
+    table->data_ = table->owned_.data();
+    return table;
+}
+
+std::shared_ptr<SpawnTable> SpawnTable::LoadOrCompile(const std::string &text, const std::string &cachePath) {
+    uint32_t sourceHash = Fnv1a(text);
+    int fd = open(cachePath.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        void *mapped = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (mapped != MAP_FAILED) {
+            size_t size = static_cast<size_t>(st.st_size);
+            if (Validate(static_cast<const uint8_t *>(mapped), size, sourceHash)) {
+                std::shared_ptr<SpawnTable> table(new SpawnTable());
+                table->mapped_ = mapped;
+                table->mappedSize_ = size;
+                table->data_ = static_cast<const uint8_t *>(mapped);
+                LOGI("Spawn table mapped from cache: %{public}zu waves", table->WaveCount());
+                return table;
+            }
+            munmap(mapped, size);
+        }
+    }
+
+    std::shared_ptr<SpawnTable> table = FromText(text);
+    if (!table) {
+        return nullptr;
+    }
+    // Write to a temporary name first so a crash never leaves a truncated cache behind.
+    std::string tmpPath = cachePath + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    bool written = file && fwrite(table->owned_.data(), 1, table->owned_.size(), file) == table->owned_.size();
+    if (file) {
+        written = fclose(file) == 0 && written;
+    }
+    if (!written || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        LOGE("Spawn table cache write failed: %{public}s", cachePath.c_str());
+        remove(tmpPath.c_str());
+    }
+    LOGI("Spawn table compiled: %{public}zu waves", table->WaveCount());
+    return table;
+}
+
+void SpawnScheduler::Reset(std::shared_ptr<const SpawnTable> table, uint32_t seed, uint32_t nowMs) {
+    table_ = std::move(table);
+    seed_ = seed;
+    resetMs_ = nowMs;
+    cursor_ = 0;
+    active_.clear();
+}
+
+void SpawnScheduler::Save(Checkpoint &checkpoint) const {
+    checkpoint.sourceHash = table_ ? table_->Header().sourceHash : 0;
+    checkpoint.seed = seed_;
+    checkpoint.resetMs = resetMs_;
+    checkpoint.cursor = static_cast<uint32_t>(cursor_);
+    checkpoint.active = active_;
+}
+
+bool SpawnScheduler::Restore(std::shared_ptr<const SpawnTable> table, const Checkpoint &checkpoint) {
+    if (!table || table->Header().sourceHash != checkpoint.sourceHash || checkpoint.cursor > table->WaveCount()) {
+        return false;
+    }
+    for (const ActiveWave &active : checkpoint.active) {
+        if (active.wave >= checkpoint.cursor) {
+            return false;
+        }
+    }
+    table_ = std::move(table);
+    seed_ = checkpoint.seed;
+    resetMs_ = checkpoint.resetMs;
+    cursor_ = checkpoint.cursor;
+    active_ = checkpoint.active;
+    return true;
+}
+
+void SpawnScheduler::Fire(ActiveWave &active, int score, std::vector<SpawnRequest> &out) {
+    const SpawnWaveRecord &wave = table_->Waves()[active.wave];
+    uint32_t key = seed_ + active.wave * 0x9E3779B9u;
+    uint64_t trigger = active.trigger++;
+
+    Philox2x32 bits = Philox(trigger, key);
+    if (wave.chance < SPAWN_CHANCE_ALWAYS && PhiloxUnit(bits.lo) * SPAWN_CHANCE_ALWAYS >= wave.chance) {
+        return;
+    }
+
+    float xMin = wave.xMin / SPAWN_NDC_SCALE;
+    float xMax = wave.xMax / SPAWN_NDC_SCALE;
+    float speed = wave.speed + score / 1000.0f * wave.speedPerKiloPoint;
+    for (uint32_t i = 0; i < wave.count; i++) {
+        if (i > 0) {
+            bits = Philox(trigger | (static_cast<uint64_t>(i) << 32), key);
+        }
+        out.push_back({xMin + (xMax - xMin) * PhiloxUnit(bits.hi), wave.width / SPAWN_NDC_SCALE,
+                       wave.height / SPAWN_NDC_SCALE, speed, active.wave});
+    }
+}
+
+void SpawnScheduler::Advance(uint32_t nowMs, int score, bool fieldEmpty, std::vector<SpawnRequest> &out) {
+    if (!table_) {
+        return;
+    }
+
+    const SpawnWaveRecord *waves = table_->Waves();
+    for (; cursor_ < table_->WaveCount() && waves[cursor_].startMs <= nowMs; cursor_++) {
+        uint32_t start = std::max(waves[cursor_].startMs, resetMs_);
+        active_.push_back({static_cast<uint32_t>(cursor_), start + waves[cursor_].periodMs, 0});
+    }
+
+    for (ActiveWave &active : active_) {
+        const SpawnWaveRecord &wave = waves[active.wave];
+        if (wave.flags & SPAWN_WAVE_REFILL) {
+            if (fieldEmpty) {
+                Fire(active, score, out);
+            }
+            continue;
+        }
+        for (; active.nextMs <= nowMs && active.nextMs < wave.endMs; active.nextMs += wave.periodMs) {
+            Fire(active, score, out);
+        }
+    }
+
+    active_.erase(std::remove_if(active_.begin(), active_.end(),
+                                 [waves, nowMs](const ActiveWave &active) { return waves[active.wave].endMs <= nowMs; }),
+                  active_.end());
+}
@@ -0,0 +1,127 @@
+#ifndef SPAWN_SCHEDULE_H
+#define SPAWN_SCHEDULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary spawn table, little endian: a 16-byte header followed by waveCount 32-byte wave records
+// sorted by start time. Designers edit the text form (rawfile spawn_waves.txt); it is compiled once
+// and cached next to the app data, where later launches map it without parsing.
+constexpr char SPAWN_TABLE_MAGIC[4] = {'S', 'P', 'W', 'N'};
+constexpr uint16_t SPAWN_TABLE_VERSION = 1;
+constexpr uint32_t SPAWN_FOREVER = UINT32_MAX;
+// Positions and sizes are stored in units of 1 / SPAWN_NDC_SCALE NDC, chance in basis points.
+constexpr float SPAWN_NDC_SCALE = 10000.0f;
+constexpr uint16_t SPAWN_CHANCE_ALWAYS = 10000;
+
+enum SpawnWaveFlags : uint8_t {
+    // Spawns whenever no obstacle is left instead of on a period.
+    SPAWN_WAVE_REFILL = 1 << 0,
+};
+
+struct SpawnTableHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t waveCount;
+    // FNV-1a of the source text, so a stale cache is rebuilt when the text changes.
+    uint32_t sourceHash;
+    // 0 picks a new seed for every game.
+    uint32_t seed;
+};
+
+struct SpawnWaveRecord {
+    uint32_t startMs;
+    uint32_t endMs;
+    uint32_t periodMs;
+    uint16_t chance;
+    uint8_t count;
+    uint8_t flags;
+    int16_t xMin, xMax;
+    uint16_t width, height;
+    float speed;
+    float speedPerKiloPoint;
+};
+
+static_assert(sizeof(SpawnTableHeader) == 16, "spawn table header layout");
+static_assert(sizeof(SpawnWaveRecord) == 32, "spawn wave record layout");
+
+// Compiled-in copy of rawfile/spawn_waves.txt, used until the app loads the resource.
+extern const char DEFAULT_SPAWN_WAVES[];
+
+class SpawnTable {
+public:
+    ~SpawnTable();
+
+    // Parses the text format into the binary layout. Reports the first error with its line number.
+    static bool Compile(const std::string &text, std::vector<uint8_t> &out);
+    static std::shared_ptr<SpawnTable> FromText(const std::string &text);
+    // Maps cachePath if it holds a valid table for text, otherwise compiles text and rewrites the cache.
+    static std::shared_ptr<SpawnTable> LoadOrCompile(const std::string &text, const std::string &cachePath);
+
+    const SpawnTableHeader &Header() const { return *reinterpret_cast<const SpawnTableHeader *>(data_); }
+    const SpawnWaveRecord *Waves() const {
+        return reinterpret_cast<const SpawnWaveRecord *>(data_ + sizeof(SpawnTableHeader));
+    }
+    size_t WaveCount() const { return Header().waveCount; }
+    bool IsMapped() const { return mapped_ != nullptr; }
+
+private:
+    SpawnTable() = default;
+    static bool Validate(const uint8_t *data, size_t size, uint32_t sourceHash);
+
+    const uint8_t *data_ = nullptr;
+    void *mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    std::vector<uint8_t> owned_;
+};
+
+struct SpawnRequest {
+    float x;
+    float width, height;
+    float speed;
+    // Index of the wave record that fired.
+    uint32_t wave;
+};
+
+// Walks a spawn table in simulation time. Waves are activated through a cursor over the start-sorted
+// records and each active wave keeps its own next due time, so a tick costs the same however long the
+// table is. Every wave draws from its own Philox stream keyed by seed and wave index.
+class SpawnScheduler {
+public:
+    // Starts the table at nowMs; waves that started earlier fire one period after nowMs.
+    void Reset(std::shared_ptr<const SpawnTable> table, uint32_t seed, uint32_t nowMs = 0);
+    // Appends the spawns due in (previous call, nowMs]. fieldEmpty fires refill waves.
+    void Advance(uint32_t nowMs, int score, bool fieldEmpty, std::vector<SpawnRequest> &out);
+
+    // A wave that has started. trigger counts its firings and is all the random state the wave has.
+    struct ActiveWave {
+        uint32_t wave;
+        uint32_t nextMs;
+        uint32_t trigger;
+    };
+    // Enough to continue the walk exactly where it was, e.g. from a world snapshot.
+    struct Checkpoint {
+        uint32_t sourceHash = 0;
+        uint32_t seed = 0;
+        uint32_t resetMs = 0;
+        uint32_t cursor = 0;
+        std::vector<ActiveWave> active;
+    };
+    void Save(Checkpoint &checkpoint) const;
+    // False, leaving the scheduler unchanged, if the checkpoint does not belong to table.
+    bool Restore(std::shared_ptr<const SpawnTable> table, const Checkpoint &checkpoint);
+
+private:
+    void Fire(ActiveWave &active, int score, std::vector<SpawnRequest> &out);
+
+    std::shared_ptr<const SpawnTable> table_;
+    uint32_t seed_ = 0;
+    uint32_t resetMs_ = 0;
+    size_t cursor_ = 0;
+    std::vector<ActiveWave> active_;
+};
+
+#endif // SPAWN_SCHEDULE_H
@@ -0,0 +1,133 @@
+#include <hilog/log.h>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "world_snapshot.h"
+#include "plugin_common.h"
+
+namespace {
+// The file only grows, in whole pages, so repeated saves reuse one mapping.
+const size_t FILE_GRANULE = 4096;
+
+uint32_t Fnv1a(const uint8_t *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+} // namespace
+
+void SealWorldSnapshot(std::vector<uint8_t> &buffer) {
+    WorldSnapshotHeader *header = reinterpret_cast<WorldSnapshotHeader *>(buffer.data());
+    memcpy(header->magic, WORLD_SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = WORLD_SNAPSHOT_VERSION;
+    header->payloadBytes = static_cast<uint32_t>(buffer.size() - sizeof(WorldSnapshotHeader));
+    header->checksum = Fnv1a(buffer.data() + sizeof(WorldSnapshotHeader), header->payloadBytes);
+}
+
+bool ValidateWorldSnapshot(const uint8_t *data, size_t size) {
+    if (size < sizeof(WorldSnapshotHeader)) {
+        return false;
+    }
+    const WorldSnapshotHeader *header = reinterpret_cast<const WorldSnapshotHeader *>(data);
+    size_t expected = header->entityCount * sizeof(WorldSnapshotEntity) +
+                      header->activeWaveCount * sizeof(WorldSnapshotWave);
+    return memcmp(header->magic, WORLD_SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == WORLD_SNAPSHOT_VERSION && header->payloadBytes == expected &&
+           size - sizeof(WorldSnapshotHeader) >= expected &&
+           header->checksum == Fnv1a(data + sizeof(WorldSnapshotHeader), expected);
+}
+
+bool WorldSnapshotFile::Map(const std::string &path, size_t bytes) {
+    if (path == path_ && bytes <= size_) {
+        return true;
+    }
+    Close();
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        LOGE("World snapshot: cannot open %{public}s", path.c_str());
+        return false;
+    }
+    struct stat st;
+    size_t size = (bytes + FILE_GRANULE - 1) / FILE_GRANULE * FILE_GRANULE;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > size) {
+        size = static_cast<size_t>(st.st_size);
+    }
+    void *mapped = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mapped == MAP_FAILED) {
+        LOGE("World snapshot: cannot map %{public}s", path.c_str());
+        close(fd);
+        return false;
+    }
+    path_ = path;
+    fd_ = fd;
+    data_ = static_cast<uint8_t *>(mapped);
+    size_ = size;
+    return true;
+}
+
+bool WorldSnapshotFile::Write(const std::string &path, const std::vector<uint8_t> &snapshot) {
+    if (snapshot.size() < sizeof(WorldSnapshotHeader) || !Map(path, snapshot.size())) {
+        return false;
+    }
+    // Invalidate first and publish the magic last; the checksum catches anything in between.
+    memset(data_, 0, sizeof(WORLD_SNAPSHOT_MAGIC));
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(data_ + sizeof(WORLD_SNAPSHOT_MAGIC), snapshot.data() + sizeof(WORLD_SNAPSHOT_MAGIC),
+           snapshot.size() - sizeof(WORLD_SNAPSHOT_MAGIC));
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(data_, snapshot.data(), sizeof(WORLD_SNAPSHOT_MAGIC));
+    // No msync: the page cache outlives the process, which is what surface loss and app kills need.
+    return true;
+}
+
+void WorldSnapshotFile::Discard(const std::string &path) {
+    if (Map(path, sizeof(WorldSnapshotHeader))) {
+        memset(data_, 0, sizeof(WORLD_SNAPSHOT_MAGIC));
+    }
+}
+
+void WorldSnapshotFile::Close() {
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    path_.clear();
+    size_ = 0;
+}
+
+bool WorldSnapshotFile::Read(const std::string &path, std::vector<uint8_t> &snapshot) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    const uint8_t *data = static_cast<const uint8_t *>(mapped);
+    size_t size = static_cast<size_t>(st.st_size);
+    bool valid = ValidateWorldSnapshot(data, size);
+    if (valid) {
+        const WorldSnapshotHeader *header = reinterpret_cast<const WorldSnapshotHeader *>(data);
+        snapshot.assign(data, data + sizeof(WorldSnapshotHeader) + header->payloadBytes);
+    }
+    munmap(mapped, size);
+    return valid;
+}
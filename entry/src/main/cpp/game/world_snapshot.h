@@ -0,0 +1,96 @@
+#ifndef WORLD_SNAPSHOT_H
+#define WORLD_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary world snapshot, little endian: a 72-byte header, entityCount 48-byte entity records in archetype
+// order, then activeWaveCount 12-byte spawn wave cursors. Restoring it continues the run tick for tick;
+// the same file doubles as a checkpoint for headless runs.
+constexpr char WORLD_SNAPSHOT_MAGIC[4] = {'S', 'D', 'W', 'S'};
+constexpr uint16_t WORLD_SNAPSHOT_VERSION = 1;
+
+enum class SnapshotEntityKind : uint8_t { Player = 0, Obstacle };
+
+struct WorldSnapshotHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t entityCount;
+    // Bytes after the header and their FNV-1a, so a torn or stale write is rejected.
+    uint32_t payloadBytes;
+    uint32_t checksum;
+    uint32_t frame;
+    int32_t score;
+    double simSeconds;
+    float tickSeconds;
+    float accumulator;
+    float alpha;
+    int32_t pendingMoves;
+    uint32_t seed;
+    // Spawn table the cursors belong to, and the scheduler's walk position.
+    uint32_t spawnSourceHash;
+    uint32_t spawnResetMs;
+    uint32_t spawnCursor;
+    uint16_t activeWaveCount;
+    uint8_t collisionMode;
+    uint8_t gameOver;
+    uint32_t reserved;
+};
+
+struct WorldSnapshotEntity {
+    uint8_t kind;
+    uint8_t reserved;
+    // CollisionShape variant; masks are baked again from the atlas loaded at restore time.
+    uint16_t collisionVariant;
+    float x, y;
+    float velocityX, velocityY;
+    float width, height;
+    float r, g, b, a;
+    // PlayerControl speed, 0 for obstacles.
+    float speed;
+};
+
+struct WorldSnapshotWave {
+    uint32_t wave;
+    uint32_t nextMs;
+    uint32_t trigger;
+};
+
+static_assert(sizeof(WorldSnapshotHeader) == 72, "world snapshot header layout");
+static_assert(sizeof(WorldSnapshotEntity) == 48, "world snapshot entity layout");
+static_assert(sizeof(WorldSnapshotWave) == 12, "world snapshot wave layout");
+
+// Fills in magic, version, payloadBytes and checksum of a snapshot assembled in buffer.
+void SealWorldSnapshot(std::vector<uint8_t> &buffer);
+// True if data starts with a complete, intact snapshot of this version whose counts match its size.
+bool ValidateWorldSnapshot(const uint8_t *data, size_t size);
+
+// Keeps the snapshot file mapped so saving is a copy into the page cache, with no system calls once the
+// file is large enough. The header's magic is written last; a snapshot cut short fails validation.
+class WorldSnapshotFile {
+public:
+    WorldSnapshotFile() = default;
+    ~WorldSnapshotFile() { Close(); }
+    WorldSnapshotFile(const WorldSnapshotFile &) = delete;
+    WorldSnapshotFile &operator=(const WorldSnapshotFile &) = delete;
+
+    bool Write(const std::string &path, const std::vector<uint8_t> &snapshot);
+    // Invalidates the snapshot at path, so the next launch starts a new run.
+    void Discard(const std::string &path);
+    void Close();
+
+    // Copies a valid snapshot out of path.
+    static bool Read(const std::string &path, std::vector<uint8_t> &snapshot);
+
+private:
+    bool Map(const std::string &path, size_t bytes);
+
+    std::string path_;
+    int fd_ = -1;
+    uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+#endif // WORLD_SNAPSHOT_H
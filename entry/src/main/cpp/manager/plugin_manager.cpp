@@ -98,11 +98,6 @@ void PluginManager::SetNativeXComponent(std::string& id, OH_NativeXComponent* na
 }
 
 PluginRender *PluginManager::GetRender(std::string& id) {
-    if (pluginRenderMap_.find(id) == pluginRenderMap_.end()) {
-        PluginRender *instance = PluginRender::GetInstance(id);
-        pluginRenderMap_[id] = instance;
-        return instance;
-    } else {
-        return pluginRenderMap_[id];
-    }
+    // Not cached: PluginRender deletes itself when its surface is destroyed.
+    return PluginRender::GetInstance(id);
 }
\ No newline at end of file
@@ -26,8 +26,7 @@ class PluginManager {
 public:
     ~PluginManager() {}
 
-    static PluginManager* GetInstance()
-    {
+    static PluginManager* GetInstance() {
         return &PluginManager::manager_;
     }
 
@@ -48,7 +47,6 @@ private:
 
     std::string id_;
     std::unordered_map<std::string, OH_NativeXComponent*> nativeXComponentMap_;
-    std::unordered_map<std::string, PluginRender*> pluginRenderMap_;
 };
 
 #endif // _PLUGIN_MANAGER_H_
\ No newline at end of file
@@ -5,13 +5,27 @@
 #include "napi/native_api.h"
 
 EXTERN_C_START
-static napi_value Init(napi_env env, napi_value exports)
-{
+static napi_value Init(napi_env env, napi_value exports) {
     napi_property_descriptor desc[] = {
         { "moveLeft", nullptr, PluginRender::NapiMoveLeft, nullptr, nullptr, nullptr, napi_default, nullptr },
         { "moveRight", nullptr, PluginRender::NapiMoveRight, nullptr, nullptr, nullptr, napi_default, nullptr },
         { "restartGame", nullptr, PluginRender::NapiRestartGame, nullptr, nullptr, nullptr, napi_default, nullptr },
-        { "setGameOverCallback", nullptr, PluginRender::NapiSetGameOverCallback, nullptr, nullptr, nullptr, napi_default, nullptr }
+        { "setPaused", nullptr, PluginRender::NapiSetPaused, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setGameOverCallback", nullptr, PluginRender::NapiSetGameOverCallback, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setEventListener", nullptr, PluginRender::NapiSetEventListener, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setAdaptiveResolution", nullptr, PluginRender::NapiSetAdaptiveResolution, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setLateLatch", nullptr, PluginRender::NapiSetLateLatch, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setSoftwareRendering", nullptr, PluginRender::NapiSetSoftwareRendering, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setSnapshotPath", nullptr, PluginRender::NapiSetSnapshotPath, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "loadSpawnSchedule", nullptr, PluginRender::NapiLoadSpawnSchedule, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setCollisionMasks", nullptr, PluginRender::NapiSetCollisionMasks, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "getSharedState", nullptr, PluginRender::NapiGetSharedState, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "getMemoryStats", nullptr, PluginRender::NapiGetMemoryStats, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setMemoryBudget", nullptr, PluginRender::NapiSetMemoryBudget, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setTracing", nullptr, PluginRender::NapiSetTracing, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "dumpTrace", nullptr, PluginRender::NapiDumpTrace, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "startFrameCapture", nullptr, PluginRender::NapiStartFrameCapture, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "stopFrameCapture", nullptr, PluginRender::NapiStopFrameCapture, nullptr, nullptr, nullptr, napi_default, nullptr }
     };
 
     NAPI_CALL(env, napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc));
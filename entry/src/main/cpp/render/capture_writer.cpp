@@ -0,0 +1,207 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "capture_writer.h"
+#include "plugin_common.h"
+#include "tracing.h"
+
+namespace {
+const size_t TGA_HEADER_BYTES = 18;
+const uint8_t TGA_TRUECOLOR = 2;
+// Image descriptor bit set when the first row stored is the top one.
+const uint8_t TGA_TOP_ORIGIN = 0x20;
+
+void PutLe16(uint8_t *out, int value) {
+    out[0] = static_cast<uint8_t>(value & 0xff);
+    out[1] = static_cast<uint8_t>((value >> 8) & 0xff);
+}
+
+int GetLe16(const uint8_t *in) { return in[0] | (in[1] << 8); }
+} // namespace
+
+bool WriteFrameTga(const std::string &path, const CapturedFrame &frame) {
+    size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+    if (frame.width <= 0 || frame.height <= 0 || frame.width > 0xffff || frame.height > 0xffff ||
+        frame.rgba.size() < pixels * 4) {
+        return false;
+    }
+    uint8_t header[TGA_HEADER_BYTES] = {0};
+    header[2] = TGA_TRUECOLOR;
+    PutLe16(header + 12, frame.width);
+    PutLe16(header + 14, frame.height);
+    header[16] = 32;
+    header[17] = 8; // alpha bits, bottom-left origin
+    std::vector<uint8_t> bgra(pixels * 4);
+    for (size_t i = 0; i < pixels; i++) {
+        bgra[i * 4 + 0] = frame.rgba[i * 4 + 2];
+        bgra[i * 4 + 1] = frame.rgba[i * 4 + 1];
+        bgra[i * 4 + 2] = frame.rgba[i * 4 + 0];
+        bgra[i * 4 + 3] = frame.rgba[i * 4 + 3];
+    }
+
+    std::string tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    bool written = file && fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+                   fwrite(bgra.data(), 1, bgra.size(), file) == bgra.size();
+    if (file) {
+        written = fclose(file) == 0 && written;
+    }
+    if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ReadFrameTga(const std::string &path, CapturedFrame &frame) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + count);
+    }
+    fclose(file);
+
+    if (data.size() < TGA_HEADER_BYTES || data[1] != 0 || data[2] != TGA_TRUECOLOR ||
+        (data[16] != 24 && data[16] != 32)) {
+        return false;
+    }
+    int width = GetLe16(&data[12]);
+    int height = GetLe16(&data[14]);
+    size_t channels = data[16] / 8;
+    size_t offset = TGA_HEADER_BYTES + data[0];
+    size_t rowBytes = static_cast<size_t>(width) * channels;
+    if (width == 0 || height == 0 || data.size() < offset + rowBytes * height) {
+        return false;
+    }
+    bool topOrigin = (data[17] & TGA_TOP_ORIGIN) != 0;
+    frame.width = width;
+    frame.height = height;
+    frame.rgba.resize(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = &data[offset + rowBytes * (topOrigin ? height - 1 - y : y)];
+        uint8_t *out = &frame.rgba[static_cast<size_t>(y) * width * 4];
+        for (int x = 0; x < width; x++) {
+            out[x * 4 + 0] = row[x * channels + 2];
+            out[x * 4 + 1] = row[x * channels + 1];
+            out[x * 4 + 2] = row[x * channels + 0];
+            out[x * 4 + 3] = channels == 4 ? row[x * channels + 3] : 0xff;
+        }
+    }
+    return true;
+}
+
+FrameDiff CompareFrames(const CapturedFrame &frame, const CapturedFrame &reference, int tolerance) {
+    FrameDiff diff;
+    size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+    diff.sameSize = frame.width == reference.width && frame.height == reference.height &&
+                    frame.rgba.size() >= pixels * 4 && reference.rgba.size() >= pixels * 4;
+    if (!diff.sameSize) {
+        return diff;
+    }
+    for (size_t i = 0; i < pixels; i++) {
+        int pixelDelta = 0;
+        for (size_t c = 0; c < 4; c++) {
+            pixelDelta = std::max(pixelDelta, std::abs(frame.rgba[i * 4 + c] - reference.rgba[i * 4 + c]));
+        }
+        diff.maxDelta = std::max(diff.maxDelta, pixelDelta);
+        if (pixelDelta > tolerance) {
+            diff.mismatched++;
+        }
+    }
+    return diff;
+}
+
+bool CaptureWriter::Start(const std::string &directory) {
+    struct stat st;
+    if (stat(directory.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        LOGE("Frame capture: %{public}s is not a directory", directory.c_str());
+        return false;
+    }
+    Stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+    running_ = true;
+    stopping_ = false;
+    trackedQueue_.Reset(ResourceKind::Heap, "capture queue", 0);
+    thread_ = std::thread(&CaptureWriter::WriterMain, this);
+    return true;
+}
+
+void CaptureWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    trackedQueue_.Reset();
+}
+
+bool CaptureWriter::Submit(std::shared_ptr<const CapturedFrame> frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || queue_.size() >= MAX_QUEUED) {
+            stats_.dropped++;
+            return false;
+        }
+        queuedBytes_ += frame->rgba.size();
+        trackedQueue_.Resize(queuedBytes_);
+        queue_.push_back(std::move(frame));
+    }
+    wake_.notify_one();
+    return true;
+}
+
+CaptureWriterStats CaptureWriter::TakeStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CaptureWriterStats stats = stats_;
+    stats_ = {};
+    return stats;
+}
+
+void CaptureWriter::WriterMain() {
+    Tracer::SetThreadName("capture writer");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Stopping still writes what was queued before it.
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break;
+        }
+        std::shared_ptr<const CapturedFrame> frame = std::move(queue_.front());
+        queue_.pop_front();
+        std::string directory = directory_;
+        lock.unlock();
+
+        char name[32];
+        snprintf(name, sizeof(name), "/frame_%06u.tga", frame->frame);
+        bool written;
+        {
+            TRACE_SCOPE("WriteFrameTga");
+            written = WriteFrameTga(directory + name, *frame);
+        }
+        if (!written) {
+            LOGE("Frame capture: cannot write %{public}s%{public}s", directory.c_str(), name);
+        }
+
+        lock.lock();
+        queuedBytes_ -= frame->rgba.size();
+        trackedQueue_.Resize(queuedBytes_);
+        if (written) {
+            stats_.written++;
+        } else {
+            stats_.dropped++;
+        }
+    }
+}
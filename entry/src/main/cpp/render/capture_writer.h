@@ -0,0 +1,68 @@
+#ifndef CAPTURE_WRITER_H
+#define CAPTURE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "frame_capture.h"
+#include "resource_registry.h"
+
+// Uncompressed 32-bit TGA with a bottom-left origin, so GL rows go out as they were read. Sequences of
+// them feed video encoders directly, e.g. ffmpeg -framerate 60 -i frame_%06d.tga.
+bool WriteFrameTga(const std::string &path, const CapturedFrame &frame);
+// Reads what WriteFrameTga writes (and any uncompressed 24/32-bit TGA), bottom row first.
+bool ReadFrameTga(const std::string &path, CapturedFrame &frame);
+
+struct FrameDiff {
+    bool sameSize = false;
+    // Pixels with any channel further than the tolerance from the reference.
+    uint32_t mismatched = 0;
+    int maxDelta = 0;
+};
+
+// Golden-image comparison: a per-channel tolerance absorbs driver rounding, mismatched counts the rest.
+FrameDiff CompareFrames(const CapturedFrame &frame, const CapturedFrame &reference, int tolerance);
+
+struct CaptureWriterStats {
+    uint32_t written = 0;
+    // Queue full, or the file could not be written.
+    uint32_t dropped = 0;
+};
+
+// Encodes captured frames and writes them to a directory on its own thread. The queue holds a few frames;
+// when the disk cannot keep up further frames are dropped instead of piling up in memory.
+class CaptureWriter {
+public:
+    static constexpr size_t MAX_QUEUED = 6;
+
+    ~CaptureWriter() { Stop(); }
+
+    // Control thread. Restarts the writer on directory, which must exist.
+    bool Start(const std::string &directory);
+    // Control thread. Writes what is queued, then joins.
+    void Stop();
+    // Any thread; false if the frame was dropped.
+    bool Submit(std::shared_ptr<const CapturedFrame> frame);
+    // Returns the counters accumulated since the previous call.
+    CaptureWriterStats TakeStats();
+
+private:
+    void WriterMain();
+
+    std::string directory_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+    bool stopping_ = false;
+    std::deque<std::shared_ptr<const CapturedFrame>> queue_;
+    TrackedResource trackedQueue_;
+    uint64_t queuedBytes_ = 0;
+    CaptureWriterStats stats_;
+};
+
+#endif // CAPTURE_WRITER_H
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include "damage_tracker.h"
+
+namespace {
+// Extra pixels around every sprite so rasterization rounding never leaves stale edges behind.
+constexpr int32_t kDamagePadding = 2;
+
+bool IsEmptyRect(const DamageRect &r) { return r.w <= 0 || r.h <= 0; }
+
+bool Touches(const DamageRect &a, const DamageRect &b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+DamageRect Union(const DamageRect &a, const DamageRect &b) {
+    if (IsEmptyRect(a)) {
+        return b;
+    }
+    if (IsEmptyRect(b)) {
+        return a;
+    }
+    int32_t left = std::min(a.x, b.x);
+    int32_t bottom = std::min(a.y, b.y);
+    int32_t right = std::max(a.x + a.w, b.x + b.w);
+    int32_t top = std::max(a.y + a.h, b.y + b.h);
+    return {left, bottom, right - left, top - bottom};
+}
+
+int64_t Area(const DamageRect &r) { return IsEmptyRect(r) ? 0 : static_cast<int64_t>(r.w) * r.h; }
+
+bool SameRect(const DamageRect &a, const DamageRect &b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+} // namespace
+
+void DamageTracker::Resize(int32_t width, int32_t height) {
+    width_ = width;
+    height_ = height;
+    for (auto &slot : slots_) {
+        slot.valid = false;
+    }
+    framesRecorded_ = 0;
+    Invalidate();
+}
+
+void DamageTracker::Invalidate() { invalidated_ = true; }
+
+void DamageTracker::BeginFrame() {
+    head_ = (head_ + 1) % kHistory;
+    FrameDamage &frame = frames_[head_];
+    frame.count = 0;
+    frame.full = invalidated_;
+    invalidated_ = false;
+    for (auto &slot : slots_) {
+        slot.seen = false;
+    }
+}
+
+DamageRect DamageTracker::ToPixels(float cx, float cy, float w, float h) const {
+    float left = (cx - w / 2 + 1.0f) * 0.5f * width_;
+    float right = (cx + w / 2 + 1.0f) * 0.5f * width_;
+    float bottom = (cy - h / 2 + 1.0f) * 0.5f * height_;
+    float top = (cy + h / 2 + 1.0f) * 0.5f * height_;
+
+    int32_t x0 = std::max(0, static_cast<int32_t>(std::floor(left)) - kDamagePadding);
+    int32_t y0 = std::max(0, static_cast<int32_t>(std::floor(bottom)) - kDamagePadding);
+    int32_t x1 = std::min(width_, static_cast<int32_t>(std::ceil(right)) + kDamagePadding);
+    int32_t y1 = std::min(height_, static_cast<int32_t>(std::ceil(top)) + kDamagePadding);
+    if (x1 <= x0 || y1 <= y0) {
+        return {};
+    }
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+void DamageTracker::AddRect(FrameDamage &frame, DamageRect rect) {
+    if (frame.full || IsEmptyRect(rect)) {
+        return;
+    }
+
+    // Fold every rectangle the new one touches into it, so the list stays disjoint.
+    for (int i = 0; i < frame.count;) {
+        if (Touches(frame.rects[i], rect)) {
+            rect = Union(frame.rects[i], rect);
+            frame.rects[i] = frame.rects[--frame.count];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+
+    if (frame.count < kMaxRectsPerFrame) {
+        frame.rects[frame.count++] = rect;
+        return;
+    }
+
+    // Out of rectangles: merge into the one that grows the least.
+    int best = 0;
+    int64_t bestGrowth = INT64_MAX;
+    for (int i = 0; i < frame.count; i++) {
+        int64_t growth = Area(Union(frame.rects[i], rect)) - Area(frame.rects[i]);
+        if (growth < bestGrowth) {
+            bestGrowth = growth;
+            best = i;
+        }
+    }
+    frame.rects[best] = Union(frame.rects[best], rect);
+}
+
+void DamageTracker::TrackSprite(int slot, float cx, float cy, float w, float h) {
+    if (slot < 0 || slot >= kMaxSlots) {
+        // Untracked sprite: this frame has to be repainted in full, not just the next one.
+        frames_[head_].full = true;
+        frames_[head_].count = 0;
+        return;
+    }
+
+    SlotState &state = slots_[slot];
+    DamageRect current = ToPixels(cx, cy, w, h);
+    if (!state.valid) {
+        AddRect(frames_[head_], current);
+    } else if (!SameRect(state.rect, current)) {
+        AddRect(frames_[head_], Union(state.rect, current));
+    }
+    state.rect = current;
+    state.valid = true;
+    state.seen = true;
+}
+
+void DamageTracker::EndFrame() {
+    for (auto &slot : slots_) {
+        if (slot.valid && !slot.seen) {
+            AddRect(frames_[head_], slot.rect);
+            slot.valid = false;
+        }
+    }
+    framesRecorded_ = std::min(framesRecorded_ + 1, kHistory);
+}
+
+void DamageTracker::DropFrame() {
+    // BeginFrame recycled the oldest history entry, so the full history is no longer available.
+    head_ = (head_ - 1 + kHistory) % kHistory;
+    framesRecorded_ = std::max(0, std::min(framesRecorded_ - 1, kHistory - 1));
+}
+
+bool DamageTracker::CollectRegion(int bufferAge, std::vector<int32_t> &rects, DamageRect &bounds) const {
+    rects.clear();
+    bounds = {};
+    if (bufferAge <= 0 || bufferAge > framesRecorded_) {
+        return false;
+    }
+
+    // A buffer that is N frames old misses the damage of the current frame and the N - 1 before it.
+    FrameDamage region;
+    region.full = false;
+    for (int age = 0; age < bufferAge; age++) {
+        const FrameDamage &frame = frames_[(head_ - age + kHistory) % kHistory];
+        if (frame.full) {
+            return false;
+        }
+        for (int i = 0; i < frame.count; i++) {
+            AddRect(region, frame.rects[i]);
+        }
+    }
+
+    for (int i = 0; i < region.count; i++) {
+        const DamageRect &r = region.rects[i];
+        rects.insert(rects.end(), {r.x, r.y, r.w, r.h});
+        bounds = Union(bounds, r);
+    }
+    return true;
+}
+
+float DamageTracker::DamagedPercent() const {
+    const FrameDamage &frame = frames_[head_];
+    int64_t total = static_cast<int64_t>(width_) * height_;
+    if (frame.full || total <= 0) {
+        return 100.0f;
+    }
+    int64_t damaged = 0;
+    for (int i = 0; i < frame.count; i++) {
+        damaged += Area(frame.rects[i]);
+    }
+    return std::min(100.0f, 100.0f * static_cast<float>(damaged) / static_cast<float>(total));
+}
@@ -0,0 +1,66 @@
+#ifndef DAMAGE_TRACKER_H
+#define DAMAGE_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+
+// Rectangle in window pixels, origin at the bottom-left corner (EGL damage convention).
+struct DamageRect {
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t w = 0;
+    int32_t h = 0;
+};
+
+// Tracks which parts of the surface changed between frames. Every sprite is identified by a slot;
+// a moved sprite damages the union of its previous and current bounds, a vanished sprite damages
+// its previous bounds. A short per-frame history lets callers honour EGL buffer age.
+class DamageTracker {
+public:
+    static constexpr int kMaxSlots = 64;
+    static constexpr int kMaxRectsPerFrame = 8;
+    static constexpr int kHistory = 4;
+
+    void Resize(int32_t width, int32_t height);
+    void Invalidate();
+
+    void BeginFrame();
+    // Bounds are given in NDC as center and size, the same convention DrawRect uses.
+    void TrackSprite(int slot, float cx, float cy, float w, float h);
+    void EndFrame();
+    // Forgets an empty frame that was never presented, keeping the history aligned with buffer age.
+    void DropFrame();
+
+    // Fills rects (x, y, w, h quadruples) with the area that has to be repainted in a buffer whose
+    // content is bufferAge frames old. Returns false when the whole surface must be repainted.
+    bool CollectRegion(int bufferAge, std::vector<int32_t> &rects, DamageRect &bounds) const;
+
+    bool IsFullFrame() const { return frames_[head_].full; }
+    bool IsEmpty() const { return !frames_[head_].full && frames_[head_].count == 0; }
+    float DamagedPercent() const;
+
+private:
+    struct SlotState {
+        DamageRect rect;
+        bool valid = false;
+        bool seen = false;
+    };
+    struct FrameDamage {
+        DamageRect rects[kMaxRectsPerFrame];
+        int count = 0;
+        bool full = true;
+    };
+
+    DamageRect ToPixels(float cx, float cy, float w, float h) const;
+    static void AddRect(FrameDamage &frame, DamageRect rect);
+
+    SlotState slots_[kMaxSlots];
+    FrameDamage frames_[kHistory];
+    int head_ = 0;
+    int framesRecorded_ = 0;
+    int32_t width_ = 0;
+    int32_t height_ = 0;
+    bool invalidated_ = true;
+};
+
+#endif // DAMAGE_TRACKER_H
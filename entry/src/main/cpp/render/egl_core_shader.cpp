@@ -1,9 +1,13 @@
 #include <hilog/log.h>
-#include <random>
 #include <cmath>
 #include <functional>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
 #include "egl_core_shader.h"
 #include "plugin_common.h"
+#include "tracing.h"
 
 const char *GAME_SYNC_NAME = "openglVSync";
 
@@ -15,13 +19,30 @@ const char *GAME_SYNC_NAME = "openglVSync";
 #define EGL_GL_COLORSPACE_SRGB_KHR 0x3089
 #endif
 
+#ifndef EGL_BUFFER_AGE_KHR
+#define EGL_BUFFER_AGE_KHR 0x313D
+#endif
+
+const uint8_t SPRITE_LAYER = 0;
+const uint8_t SPRITE_PROGRAM = 0;
+const uint16_t NO_TEXTURE = 0;
+const int SPRITE_CORNERS = 4;
+const int DAMAGE_STATS_INTERVAL = 300;
+const float NOMINAL_FRAME_SECONDS = 1.0f / 60.0f;
+const float CLEAR_COLOR[4] = {0.04f, 0.04f, 0.1f, 1.0f};
+// Atlas pixels at least this opaque are solid for collision.
+const uint8_t COLLISION_ALPHA_THRESHOLD = 128;
+
 char vertexShader[] = "#version 300 es\n"
-                      "layout(location = 0) in vec4 a_position;\n"
-                      "layout(location = 1) in vec4 a_color;\n"
+                      "layout(location = 0) in vec2 a_corner;\n"
+                      "layout(location = 1) in vec4 a_rect;\n"
+                      "layout(location = 2) in vec4 a_color;\n"
+                      "const float kPositionRange = 4.0;\n"
                       "out vec4 v_color;\n"
                       "void main()\n"
                       "{\n"
-                      "   gl_Position = a_position;\n"
+                      "   vec4 rect = a_rect * kPositionRange;\n"
+                      "   gl_Position = vec4(rect.xy + a_corner * 0.5 * rect.zw, 0.0, 1.0);\n"
                       "   v_color = a_color;\n"
                       "}\n";
 
@@ -34,125 +55,29 @@ char fragmentShader[] = "#version 300 es\n"
                         "   fragColor = v_color;\n"
                         "}\n";
 
-struct GameObject {
-    float x, y;
-    float width, height;
-    float speedX, speedY;
-    bool active;
-};
-
-GameObject player;
-GameObject obstacles[25];
-int score = 0;
-bool gameOver = false;
-int frameCount = 0;
-std::mt19937 rng;
-
-static std::function<void(int)> g_gameOverCallback = nullptr;
-
-void InitGame() {
-    player.x = 0.0f;
-    player.y = -0.8f;
-    player.width = 0.15f;
-    player.height = 0.15f;
-    player.speedX = 0.04f;
-    player.active = true;
-
-    rng.seed(std::random_device{}());
-    for (int i = 0; i < 35; i++) {
-        obstacles[i].active = false;
-    }
-
-    score = 0;
-    gameOver = false;
-    frameCount = 0;
-    LOGI("Game initialized");
-}
-
-void SpawnObstacle() {
-    std::uniform_real_distribution<float> dist(-0.75f, 0.75f);
-
-    for (int i = 0; i < 25; i++) {
-        if (!obstacles[i].active) {
-            obstacles[i].x = dist(rng);
-            obstacles[i].y = 1.2f;
-            obstacles[i].width = 0.12f;
-            obstacles[i].height = 0.12f;
-            obstacles[i].speedY = -0.025f - (score / 1000.0f * 0.008f);
-            obstacles[i].active = true;
-            break;
-        }
-    }
-}
+// Swap chain depth assumed when estimating window surface memory.
+const int WINDOW_SURFACE_BUFFERS = 3;
+const int BYTES_PER_PIXEL = 4;
 
-bool CheckCollision(GameObject &a, GameObject &b) {
-    return (a.x < b.x + b.width && a.x + a.width > b.x && a.y < b.y + b.height && a.y + a.height > b.y);
+static uint64_t WindowSurfaceBytes(int w, int h) {
+    return static_cast<uint64_t>(w) * static_cast<uint64_t>(h) * BYTES_PER_PIXEL * WINDOW_SURFACE_BUFFERS;
 }
 
-void UpdateGame() {
-    if (gameOver)
-        return;
-
-    frameCount++;
-
-    bool allInactive = true;
-    for (int i = 0; i < 25; i++) {
-        if (obstacles[i].active) {
-            allInactive = false;
-            obstacles[i].y += obstacles[i].speedY;
-
-            if (CheckCollision(player, obstacles[i])) {
-                gameOver = true;
-                LOGI("COLLISION! GAME OVER! Final Score: %{public}d", score);
-
-                if (g_gameOverCallback) {
-                    LOGI("Callback exists, calling it now...");
-                    g_gameOverCallback(score);
-                    LOGI("Callback called");
-                } else {
-                    LOGE("Callback is NULL!");
-                }
-                return;
-            }
-
-            if (obstacles[i].y < -1.5f) {
-                obstacles[i].active = false;
-                score += 10;
-            }
-        }
-    }
-
-    if (frameCount % 25 == 0 || allInactive) {
-        SpawnObstacle();
+static bool HasEglExtension(const char *extensions, const char *name) {
+    if (!extensions) {
+        return false;
     }
-
-    std::uniform_int_distribution<int> randomSpawn(0, 100);
-    if (frameCount % 10 == 0 && randomSpawn(rng) < 30) { // %30 şans
-        SpawnObstacle();
+    size_t len = strlen(name);
+    for (const char *p = strstr(extensions, name); p; p = strstr(p + len, name)) {
+        bool startOk = (p == extensions) || (p[-1] == ' ');
+        bool endOk = (p[len] == ' ') || (p[len] == '\0');
+        if (startOk && endOk) {
+            return true;
+        }
     }
+    return false;
 }
 
-void DrawRect(float x, float y, float w, float h, float r, float g, float b, float a) {
-    GLfloat vertices[] = {x - w / 2, y - h / 2, x + w / 2, y - h / 2, x - w / 2, y + h / 2, x + w / 2, y + h / 2};
-
-    GLfloat colors[] = {r, g, b, a, r, g, b, a, r, g, b, a, r, g, b, a};
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, colors);
-    glEnableVertexAttribArray(1);
-
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-}
-
-struct SyncParam {
-    EGLCore *eglCore = nullptr;
-    void *window = nullptr;
-};
-
 static EGLConfig getConfig(EGLDisplay eglDisplay) {
     int attribList[] = {EGL_SURFACE_TYPE,
                         EGL_WINDOW_BIT,
@@ -176,21 +101,17 @@ static EGLConfig getConfig(EGLDisplay eglDisplay) {
     return configs;
 }
 
-void EGLCore::SetGameOverCallback(std::function<void(int)> callback) {
-    g_gameOverCallback = callback;
-    LOGI("Game over callback SET in EGLCore");
-}
-
 void EGLCore::OnSurfaceCreated(void *window, int w, int h) {
     LOGD("EGLCore::OnSurfaceCreated w=%{public}d, h=%{public}d", w, h);
     width_ = w;
     height_ = h;
 
-    InitGame();
+    mWorld.Init();
+    mScheduler.Reset();
+    mScheduler.SetState(FrameState::Play);
 
-    SyncParam *param = new SyncParam();
-    param->eglCore = this;
-    param->window = window;
+    // Read by the first vsync callback; held here rather than in a per-request allocation that was never freed.
+    mPendingWindow = window;
     mVsync = OH_NativeVSync_Create(GAME_SYNC_NAME, 3);
 
     if (!mVsync) {
@@ -198,214 +119,1008 @@ void EGLCore::OnSurfaceCreated(void *window, int w, int h) {
         return;
     }
 
-    OH_NativeVSync_RequestFrame(
-        mVsync,
-        [](long long timestamp, void *data) {
-            SyncParam *syncParam = (SyncParam *)data;
-            if (!syncParam)
-                return;
+    RequestVsync(&EGLCore::StartLoop);
+}
 
-            EGLCore *eglCore = syncParam->eglCore;
-            void *window = syncParam->window;
-            if (!eglCore || !window)
-                return;
+void EGLCore::StartLoop(long long timestamp) {
+    void *window = mPendingWindow;
+    if (!window)
+        return;
 
-            eglCore->mEglWindow = static_cast<EGLNativeWindowType>(window);
-            eglCore->mEGLDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (mForceSoftware.load() || !InitEGL(window)) {
+        // Without a usable GLES driver the game still runs, drawn on the CPU.
+        ReleaseEGL();
+        if (!mPresenter.Attach(window)) {
+            return;
+        }
+        mSoftware = true;
+    }
 
-            if (eglCore->mEGLDisplay == EGL_NO_DISPLAY) {
-                LOGE("Unable to get EGL display");
-                return;
-            }
+    if (!InitRenderer(width_, height_)) {
+        return;
+    }
+    // Here rather than in OnSurfaceCreated so the app has had the chance to set the path.
+    RestoreSnapshot();
+    LOGI("%{public}s initialized successfully, starting game loop", mSoftware ? "Software renderer" : "EGL");
+    GameLoop(timestamp);
+}
 
-            EGLint eglMajVers, eglMinVers;
-            if (!eglInitialize(eglCore->mEGLDisplay, &eglMajVers, &eglMinVers)) {
-                LOGE("Unable to initialize display");
-                return;
-            }
+bool EGLCore::InitEGL(void *window) {
+    mEglWindow = static_cast<EGLNativeWindowType>(window);
+    mEGLDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 
-            eglCore->mEGLConfig = getConfig(eglCore->mEGLDisplay);
-            if (!eglCore->mEGLConfig) {
-                LOGE("Config ERROR");
-                return;
-            }
+    if (mEGLDisplay == EGL_NO_DISPLAY) {
+        LOGE("Unable to get EGL display");
+        return false;
+    }
 
-            EGLint winAttribs[] = {EGL_GL_COLORSPACE_KHR, EGL_GL_COLORSPACE_SRGB_KHR, EGL_NONE};
-            eglCore->mEGLSurface =
-                eglCreateWindowSurface(eglCore->mEGLDisplay, eglCore->mEGLConfig, eglCore->mEglWindow, winAttribs);
+    EGLint eglMajVers, eglMinVers;
+    if (!eglInitialize(mEGLDisplay, &eglMajVers, &eglMinVers)) {
+        LOGE("Unable to initialize display");
+        return false;
+    }
 
-            if (!eglCore->mEGLSurface) {
-                LOGE("eglSurface is null");
-                return;
-            }
+    mEGLConfig = getConfig(mEGLDisplay);
+    if (!mEGLConfig) {
+        LOGE("Config ERROR");
+        return false;
+    }
+    InitDamageExtensions();
 
-            int attrib3_list[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
-            eglCore->mEGLContext =
-                eglCreateContext(eglCore->mEGLDisplay, eglCore->mEGLConfig, eglCore->mSharedEGLContext, attrib3_list);
+    EGLint winAttribs[] = {EGL_GL_COLORSPACE_KHR, EGL_GL_COLORSPACE_SRGB_KHR, EGL_NONE};
+    mEGLSurface = eglCreateWindowSurface(mEGLDisplay, mEGLConfig, mEglWindow, winAttribs);
 
-            if (!eglMakeCurrent(eglCore->mEGLDisplay, eglCore->mEGLSurface, eglCore->mEGLSurface,
-                                eglCore->mEGLContext)) {
-                LOGE("eglMakeCurrent error = %{public}d", eglGetError());
-                return;
-            }
+    if (!mEGLSurface) {
+        LOGE("eglSurface is null");
+        return false;
+    }
+    mTrackedSurface.Reset(ResourceKind::Surface, "window surface", WindowSurfaceBytes(width_, height_));
+
+    EGLint attrib3_list[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+    // The loader context comes first so the render context joins its share group.
+    mSharedEGLContext = mUploader.Start(mEGLDisplay, mEGLConfig, attrib3_list);
+    mEGLContext = eglCreateContext(mEGLDisplay, mEGLConfig, mSharedEGLContext, attrib3_list);
+    if (mEGLContext == EGL_NO_CONTEXT && mSharedEGLContext != EGL_NO_CONTEXT) {
+        LOGE("Shared context rejected, uploading on the render thread");
+        mUploader.Stop();
+        mSharedEGLContext = EGL_NO_CONTEXT;
+        mEGLContext = eglCreateContext(mEGLDisplay, mEGLConfig, EGL_NO_CONTEXT, attrib3_list);
+    }
 
-            eglCore->mProgramHandle = eglCore->CreateProgram(vertexShader, fragmentShader);
-            if (!eglCore->mProgramHandle) {
-                LOGE("Could not create program");
-                return;
-            }
+    if (!eglMakeCurrent(mEGLDisplay, mEGLSurface, mEGLSurface, mEGLContext)) {
+        LOGE("eglMakeCurrent error = %{public}d", eglGetError());
+        return false;
+    }
+    return true;
+}
 
-            LOGI("EGL initialized successfully, starting game loop");
-            eglCore->GameLoop();
-        },
-        param);
+void EGLCore::ReleaseEGL() {
+    // The GL objects go away with the context.
+    mSceneFbo = 0;
+    mSceneColor = 0;
+    mSceneWidth = 0;
+    mSceneHeight = 0;
+    mSpriteVao = 0;
+    mSpriteCornerVbo = 0;
+    mSpriteInstanceVbo = 0;
+    mProgramHandle = 0;
+    mSpriteProgram = 0;
+    mTrackedSceneFbo.Reset();
+    mTrackedSceneColor.Reset();
+    mTrackedSpriteVao.Reset();
+    mTrackedSpriteCorners.Reset();
+    mTrackedSpriteInstances.Reset();
+    mTrackedSurface.Reset();
+    mCapture.Abandon();
+    mSpriteInstanceCapacity = 0;
+    mUploader.Stop();
+    mSharedEGLContext = EGL_NO_CONTEXT;
+    if (mEGLDisplay != EGL_NO_DISPLAY) {
+        eglMakeCurrent(mEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+    if (mEGLContext != EGL_NO_CONTEXT) {
+        eglDestroyContext(mEGLDisplay, mEGLContext);
+        mEGLContext = EGL_NO_CONTEXT;
+    }
+    if (mEGLSurface != EGL_NO_SURFACE) {
+        eglDestroySurface(mEGLDisplay, mEGLSurface);
+        mEGLSurface = EGL_NO_SURFACE;
+    }
+    mSwapBuffersWithDamage = nullptr;
+    mSetDamageRegion = nullptr;
 }
 
-void EGLCore::GameLoop() {
-    if (!eglMakeCurrent(mEGLDisplay, mEGLSurface, mEGLSurface, mEGLContext)) {
-        LOGE("GameLoop: eglMakeCurrent error = %{public}d", eglGetError());
+void EGLCore::FallBackToSoftware() {
+    LOGE("Falling back to software rendering");
+    ReleaseEGL();
+    if (!mPresenter.Attach(mPendingWindow)) {
+        LOGE("Software rendering unavailable, nothing can be drawn");
+        return;
+    }
+    mSoftware = true;
+    InitRenderer(width_, height_);
+}
+
+void EGLCore::InitDamageExtensions() {
+    const char *extensions = eglQueryString(mEGLDisplay, EGL_EXTENSIONS);
+    if (HasEglExtension(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+        mSwapBuffersWithDamage = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+    } else if (HasEglExtension(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+        mSwapBuffersWithDamage = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+    }
+    if (HasEglExtension(extensions, "EGL_KHR_partial_update")) {
+        mSetDamageRegion =
+            reinterpret_cast<PFNEGLSETDAMAGEREGIONKHRPROC>(eglGetProcAddress("eglSetDamageRegionKHR"));
+    }
+    LOGI("Damage presentation: swap_with_damage=%{public}d partial_update=%{public}d",
+         mSwapBuffersWithDamage != nullptr, mSetDamageRegion != nullptr);
+}
+
+void EGLCore::LatchInput(bool inputApplied) {
+    mPlayerLatched = false;
+    if (!mLateLatch.load()) {
+        // Moves reach the screen only once a tick has applied them.
+        if (inputApplied) {
+            mInput.Latch();
+        }
         return;
     }
+    // Latched before the pending count is read: a move queued in between is drawn but measured a frame late,
+    // never measured without being drawn.
+    mInput.Latch();
+    if (mScheduler.State() != FrameState::Play || mWorld.IsGameOver()) {
+        return;
+    }
+    // The frame reaches the display about one frame interval from now.
+    float horizon = mSmoothedFps > 0.0f ? 1.0f / mSmoothedFps : NOMINAL_FRAME_SECONDS;
+    mLatchedPlayerX = mWorld.PredictPlayerX(mWorld.PendingMoves(), mInput.Extrapolate(horizon));
+    mPlayerLatched = true;
+}
+
+float EGLCore::SpriteX(Entity entity, float x) const {
+    return mPlayerLatched && entity == mWorld.Player() ? mLatchedPlayerX : x;
+}
+
+void EGLCore::TrackFrameDamage() {
+    mDamage.BeginFrame();
+    // Entity indices are stable for an entity's lifetime and reused lowest-first, so they double as slots.
+    mWorld.EachSprite([this](Entity entity, float x, float y, const Extent &extent, const Sprite &) {
+        mDamage.TrackSprite(static_cast<int>(entity.index), SpriteX(entity, x), y, extent.width, extent.height);
+    });
+    mDamage.EndFrame();
+}
+
+bool EGLCore::PrepareDamageRegion(DamageRect &scissor) {
+    if (!mSetDamageRegion) {
+        return false;
+    }
+
+    EGLint bufferAge = 0;
+    if (!eglQuerySurface(mEGLDisplay, mEGLSurface, EGL_BUFFER_AGE_KHR, &bufferAge)) {
+        return false;
+    }
+    // An empty rectangle list would mean "the whole surface" to EGL, so repaint everything instead.
+    if (!mDamage.CollectRegion(bufferAge, mDamageRects, scissor) || mDamageRects.empty()) {
+        return false;
+    }
+    return mSetDamageRegion(mEGLDisplay, mEGLSurface, mDamageRects.data(),
+                            static_cast<EGLint>(mDamageRects.size() / 4)) == EGL_TRUE;
+}
+
+void EGLCore::PresentFrame() {
+    DamageRect bounds;
+    if (mSwapBuffersWithDamage && mDamage.CollectRegion(1, mDamageRects, bounds) && !mDamageRects.empty()) {
+        mSwapBuffersWithDamage(mEGLDisplay, mEGLSurface, mDamageRects.data(),
+                               static_cast<EGLint>(mDamageRects.size() / 4));
+    } else {
+        eglSwapBuffers(mEGLDisplay, mEGLSurface);
+    }
+}
 
-    UpdateGame();
+void EGLCore::SetAdaptiveResolution(bool enabled, const ResolutionScalerConfig &config) {
+    std::lock_guard<std::mutex> lock(mScalerMutex);
+    mAdaptiveResolution = enabled;
+    mScaler.Configure(config);
+    LOGI("Adaptive resolution %{public}s, scale range [%{public}.2f, %{public}.2f]", enabled ? "on" : "off",
+         mScaler.Config().minScale, mScaler.Config().maxScale);
+}
 
-    glViewport(0, 0, width_, height_);
-    glClearColor(0.04f, 0.04f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(mProgramHandle);
+void EGLCore::SetLateLatch(bool enabled) {
+    mLateLatch.store(enabled);
+    LOGI("Late input latch %{public}s", enabled ? "on" : "off");
+}
 
-    if (player.active) {
-        DrawRect(player.x, player.y, player.width, player.height, 0.0f, 1.0f, 1.0f, 1.0f);
+void EGLCore::SetObstacleLimit(size_t limit) {
+    mWorld.SetObstacleLimit(limit);
+    LOGI("Obstacle limit %{public}zu", limit);
+}
+
+bool EGLCore::StartFrameCapture(FrameCaptureConfig config) {
+    if (config.directory.empty()) {
+        mCaptureWriter.Stop();
+    } else if (!mCaptureWriter.Start(config.directory)) {
+        return false;
+    }
+    LOGI("Frame capture started: every %{public}u frames, limit %{public}u, to %{public}s", config.everyN,
+         config.maxFrames, config.directory.empty() ? "native sink" : config.directory.c_str());
+    {
+        std::lock_guard<std::mutex> lock(mCaptureMutex);
+        mPendingCapture = std::move(config);
+        mCaptureEnabled = true;
     }
+    mCaptureChanged.store(true);
+    if (mVsync && mScheduler.Wake()) {
+        RequestNextFrame();
+    }
+    return true;
+}
 
-    for (int i = 0; i < 25; i++) {
-        if (obstacles[i].active) {
-            DrawRect(obstacles[i].x, obstacles[i].y, obstacles[i].width, obstacles[i].height, 1.0f, 0.2f, 0.2f, 1.0f);
+void EGLCore::StopFrameCapture() {
+    {
+        std::lock_guard<std::mutex> lock(mCaptureMutex);
+        mPendingCapture = {};
+        mCaptureEnabled = false;
+    }
+    mCaptureChanged.store(true);
+    // Readbacks still in flight on the render thread are dropped by the stopped writer.
+    mCaptureWriter.Stop();
+    LOGI("Frame capture stopped");
+}
+
+void EGLCore::SetSoftwareRendering(bool enabled) {
+    mForceSoftware.store(enabled);
+    LOGI("Software rendering %{public}s from the next surface", enabled ? "on" : "off");
+}
+
+void EGLCore::SetSnapshotPath(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mSnapshotMutex);
+    mSnapshotPath = path;
+    LOGI("World snapshots at %{public}s", path.c_str());
+}
+
+bool EGLCore::SaveSnapshot() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mSnapshotMutex);
+        path = mSnapshotPath;
+    }
+    if (path.empty()) {
+        return false;
+    }
+    if (mWorld.IsGameOver()) {
+        // A finished run is not worth resuming; the next surface starts a new one.
+        mSnapshotFile.Discard(path);
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!mWorld.SaveSnapshot(static_cast<uint32_t>(mFramesPresented), mSnapshotBuffer) ||
+        !mSnapshotFile.Write(path, mSnapshotBuffer)) {
+        return false;
+    }
+    float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    LOGI("World snapshot saved: %{public}zu bytes in %{public}.1f us", mSnapshotBuffer.size(), us);
+    return true;
+}
+
+bool EGLCore::RestoreSnapshot() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mSnapshotMutex);
+        path = mSnapshotPath;
+    }
+    if (path.empty()) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    uint32_t frame = 0;
+    if (!WorldSnapshotFile::Read(path, mSnapshotBuffer) || !mWorld.RestoreSnapshot(mSnapshotBuffer, frame)) {
+        return false;
+    }
+    mFramesPresented = static_cast<int32_t>(frame);
+    mInput.Reset();
+    mDamage.Invalidate();
+    if (mWorld.IsGameOver()) {
+        mScheduler.SetState(FrameState::GameOver);
+    }
+    float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    LOGI("World snapshot restored: frame %{public}u in %{public}.1f us", frame, us);
+    return true;
+}
+
+bool EGLCore::LoadSpawnSchedule(const std::string &text, const std::string &cachePath) {
+    std::shared_ptr<const SpawnTable> table = SpawnTable::LoadOrCompile(text, cachePath);
+    if (!table) {
+        LOGE("Spawn schedule rejected, keeping the current one");
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mSpawnTableMutex);
+    mPendingSpawnTable = table;
+    return true;
+}
+
+std::shared_ptr<const CollisionAtlas> EGLCore::BuildCollisionMasks(const uint8_t *rgba, int width, int height,
+                                                                   int frameWidth, int frameHeight) {
+    std::shared_ptr<const CollisionAtlas> atlas =
+        CollisionAtlas::FromRgba(rgba, width, height, frameWidth, frameHeight, COLLISION_ALPHA_THRESHOLD);
+    if (!atlas) {
+        LOGE("Collision atlas %{public}dx%{public}d has no whole %{public}dx%{public}d frame", width, height,
+             frameWidth, frameHeight);
+    }
+    return atlas;
+}
+
+void EGLCore::SetCollisionMasks(std::shared_ptr<const CollisionAtlas> atlas) {
+    std::lock_guard<std::mutex> lock(mCollisionAtlasMutex);
+    mPendingCollisionAtlas = std::move(atlas);
+    mCollisionAtlasChanged = true;
+}
+
+bool EGLCore::EnsureSceneTarget() {
+    float scale;
+    {
+        std::lock_guard<std::mutex> lock(mScalerMutex);
+        scale = mAdaptiveResolution ? mScaler.Scale() : 1.0f;
+    }
+
+    if (scale >= 0.999f) {
+        if (mSceneFbo) {
+            DestroySceneTarget();
+            mDamage.Invalidate();
+        }
+        return false;
+    }
+
+    int sceneWidth = std::max(1, static_cast<int>(width_ * scale + 0.5f));
+    int sceneHeight = std::max(1, static_cast<int>(height_ * scale + 0.5f));
+    if (mSceneFbo && sceneWidth == mSceneWidth && sceneHeight == mSceneHeight) {
+        return true;
+    }
+    uint64_t sceneBytes = static_cast<uint64_t>(sceneWidth) * sceneHeight * BYTES_PER_PIXEL;
+    uint64_t currentBytes = static_cast<uint64_t>(mSceneWidth) * mSceneHeight * BYTES_PER_PIXEL;
+    if (sceneBytes > currentBytes &&
+        !ResourceRegistry::GetInstance()->Fits(ResourceKind::Renderbuffer, sceneBytes - currentBytes)) {
+        // The scene target only exists to save GPU time; drop it rather than go over the memory budget.
+        LOGE("Scene target of %{public}dx%{public}d is over budget, rendering at native resolution", sceneWidth,
+             sceneHeight);
+        if (mSceneFbo) {
+            DestroySceneTarget();
+            mDamage.Invalidate();
         }
+        std::lock_guard<std::mutex> lock(mScalerMutex);
+        mAdaptiveResolution = false;
+        return false;
     }
 
-    glFlush();
-    glFinish();
-    eglSwapBuffers(mEGLDisplay, mEGLSurface);
+    if (!mSceneFbo) {
+        GL().GenFramebuffers(1, &mSceneFbo);
+        GL().GenRenderbuffers(1, &mSceneColor);
+    }
+    // sRGB storage so the blit encodes exactly like rendering straight into the sRGB window surface.
+    GL().BindRenderbuffer(GL_RENDERBUFFER, mSceneColor);
+    GL().RenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, sceneWidth, sceneHeight);
+    mGL.BindFramebuffer(GL_FRAMEBUFFER, mSceneFbo);
+    GL().FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mSceneColor);
+    GLenum status = GL().CheckFramebufferStatus(GL_FRAMEBUFFER);
+    mGL.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOGE("Scene framebuffer incomplete: 0x%{public}x, rendering at native resolution", status);
+        DestroySceneTarget();
+        std::lock_guard<std::mutex> lock(mScalerMutex);
+        mAdaptiveResolution = false;
+        return false;
+    }
 
-    if (!gameOver) {
-        OH_NativeVSync_RequestFrame(
-            mVsync, [](long long timestamp, void *data) { (reinterpret_cast<EGLCore *>(data))->GameLoop(); },
-            (void *)this);
+    mSceneWidth = sceneWidth;
+    mSceneHeight = sceneHeight;
+    if (!mTrackedSceneFbo.Active()) {
+        mTrackedSceneFbo.Reset(ResourceKind::Framebuffer, "scene target", 0);
+        mTrackedSceneColor.Reset(ResourceKind::Renderbuffer, "scene target", sceneBytes);
     } else {
-        LOGI("Game loop stopped - Game Over");
+        mTrackedSceneColor.Resize(sceneBytes);
     }
+    mDamage.Invalidate();
+    return true;
 }
 
-void EGLCore::MovePlayerLeft() {
-    if (gameOver || !player.active)
-        return;
-    player.x -= player.speedX;
-    if (player.x - player.width / 2 < -1.0f) {
-        player.x = -1.0f + player.width / 5;
+void EGLCore::DestroySceneTarget() {
+    if (mSceneFbo) {
+        mGL.OnFramebufferDeleted(mSceneFbo);
+        GL().DeleteFramebuffers(1, &mSceneFbo);
+        GL().DeleteRenderbuffers(1, &mSceneColor);
     }
+    mSceneFbo = 0;
+    mSceneColor = 0;
+    mSceneWidth = 0;
+    mSceneHeight = 0;
+    mTrackedSceneFbo.Reset();
+    mTrackedSceneColor.Reset();
 }
 
-void EGLCore::MovePlayerRight() {
-    if (gameOver || !player.active)
+void EGLCore::UpdateRenderScale(float frameMs) {
+    std::lock_guard<std::mutex> lock(mScalerMutex);
+    if (mAdaptiveResolution && mScaler.AddFrameTime(frameMs)) {
+        LOGI("Render scale -> %{public}.2f (smoothed frame %{public}.2f ms)", mScaler.Scale(),
+             mScaler.SmoothedFrameMs());
+    }
+}
+
+bool EGLCore::CreateSpriteGeometry() {
+    GL().GenVertexArrays(1, &mSpriteVao);
+    GLuint buffers[2] = {0, 0};
+    GL().GenBuffers(2, buffers);
+    mSpriteCornerVbo = buffers[0];
+    mSpriteInstanceVbo = buffers[1];
+    if (!mSpriteVao || !mSpriteCornerVbo || !mSpriteInstanceVbo) {
+        return false;
+    }
+    mTrackedSpriteVao.Reset(ResourceKind::VertexArray, "sprites", 0);
+    mTrackedSpriteInstances.Reset(ResourceKind::Buffer, "sprite instances", 0);
+    mSpriteInstanceCapacity = 0;
+
+    // The attribute layout never changes, so it is recorded in the vertex array once.
+    static const int8_t corners[SPRITE_CORNERS * 2] = {-1, -1, 1, -1, -1, 1, 1, 1};
+    mGL.BindVertexArray(mSpriteVao);
+    mGL.BindBuffer(GL_ARRAY_BUFFER, mSpriteCornerVbo);
+    GL().BufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    mTrackedSpriteCorners.Reset(ResourceKind::Buffer, "sprites", sizeof(corners));
+    GL().VertexAttribPointer(0, 2, GL_BYTE, GL_FALSE, 0, nullptr);
+    GL().EnableVertexAttribArray(0);
+
+    mGL.BindBuffer(GL_ARRAY_BUFFER, mSpriteInstanceVbo);
+    const GLsizei stride = sizeof(SpriteInstance);
+    GL().VertexAttribPointer(1, 4, GL_SHORT, GL_TRUE, stride,
+                             reinterpret_cast<const void *>(offsetof(SpriteInstance, x)));
+    GL().VertexAttribDivisor(1, 1);
+    GL().EnableVertexAttribArray(1);
+    GL().VertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                             reinterpret_cast<const void *>(offsetof(SpriteInstance, color)));
+    GL().VertexAttribDivisor(2, 1);
+    GL().EnableVertexAttribArray(2);
+    return true;
+}
+
+void EGLCore::BuildFrame() {
+    TRACE_SCOPE("BuildFrame");
+    mRenderQueue.Clear();
+    // Everything shares one layer/program/texture, so depth alone keeps the original draw order.
+    uint32_t depth = 0;
+    mWorld.EachSprite([this, &depth](Entity entity, float x, float y, const Extent &extent, const Sprite &sprite) {
+        mRenderQueue.Push({RenderKey::Make(SPRITE_LAYER, SPRITE_PROGRAM, NO_TEXTURE, depth++), SpriteX(entity, x), y,
+                           extent.width, extent.height, PackColor(sprite.r, sprite.g, sprite.b, sprite.a), 0});
+    });
+    mRenderQueue.Sort();
+}
+
+void EGLCore::SubmitBatch(const RenderBatch &batch) {
+    if (RenderKey::Program(batch.stateKey) != SPRITE_PROGRAM) {
+        LOGE("SubmitBatch: unknown program %{public}d", RenderKey::Program(batch.stateKey));
         return;
+    }
+    if (!mSoftware && !mProgramHandle) {
+        return;
+    }
+    mBatchInstances.resize(batch.count);
+    for (size_t i = 0; i < batch.count; i++) {
+        const RenderCommand &cmd = batch.commands[i];
+        mBatchInstances[i] = {QuantizeSpriteCoord(cmd.x), QuantizeSpriteCoord(cmd.y), QuantizeSpriteCoord(cmd.width),
+                              QuantizeSpriteCoord(cmd.height), cmd.color};
+    }
+    if (mSoftware) {
+        mRasterizer.SubmitSprites(mBatchInstances.data(), mBatchInstances.size());
+        mSpritesDrawn += batch.count;
+        return;
+    }
 
-    player.x += player.speedX;
-    if (player.x + player.width / 2 > 1.0f) {
-        player.x = 1.0f - player.width / 5;
+    mGL.UseProgram(mProgramHandle);
+    mGL.BindVertexArray(mSpriteVao);
+    mGL.BindBuffer(GL_ARRAY_BUFFER, mSpriteInstanceVbo);
+
+    // Orphan the previous contents so the upload never waits for the GPU to finish reading them.
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(mBatchInstances.size() * sizeof(SpriteInstance));
+    GL().BufferData(GL_ARRAY_BUFFER, bytes, mBatchInstances.data(), GL_STREAM_DRAW);
+    if (static_cast<uint64_t>(bytes) > mSpriteInstanceCapacity) {
+        mSpriteInstanceCapacity = static_cast<uint64_t>(bytes);
+        mTrackedSpriteInstances.Resize(mSpriteInstanceCapacity);
     }
+    GL().DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, SPRITE_CORNERS, static_cast<GLsizei>(batch.count));
+    mSpritesDrawn += batch.count;
+    mSpriteBytesUploaded += bytes;
 }
 
-void EGLCore::RestartGame() {
-    LOGI("Restarting game...");
-    InitGame();
-    if (mVsync) {
-        GameLoop();
+void EGLCore::DrawScene(int viewportWidth, int viewportHeight, const DamageRect *scissor) {
+    TRACE_SCOPE("DrawScene");
+    mGL.Viewport(0, 0, viewportWidth, viewportHeight);
+    mGL.SetScissorTest(scissor != nullptr);
+    if (scissor) {
+        mGL.Scissor(scissor->x, scissor->y, scissor->w, scissor->h);
     }
+    mGL.ClearColor(CLEAR_COLOR[0], CLEAR_COLOR[1], CLEAR_COLOR[2], CLEAR_COLOR[3]);
+    GL().Clear(GL_COLOR_BUFFER_BIT);
+
+    mRenderQueue.Submit([this](const RenderBatch &batch) { SubmitBatch(batch); });
 }
 
-void EGLCore::Update() { eglSwapBuffers(mEGLDisplay, mEGLSurface); }
+bool EGLCore::DrawGLFrame(bool offscreen, DamageRect &scissor) {
+    bool partial = PrepareDamageRegion(scissor);
+    if (offscreen) {
+        // The scene buffer is ours and always one frame old, so only this frame's damage is redrawn.
+        DamageRect bounds;
+        bool scenePartial = mDamage.CollectRegion(1, mDamageRects, bounds) && !mDamageRects.empty();
+        DamageRect sceneScissor;
+        if (scenePartial) {
+            float fx = static_cast<float>(mSceneWidth) / width_;
+            float fy = static_cast<float>(mSceneHeight) / height_;
+            int x0 = std::max(0, static_cast<int>(bounds.x * fx) - 1);
+            int y0 = std::max(0, static_cast<int>(bounds.y * fy) - 1);
+            int x1 = std::min(mSceneWidth, static_cast<int>((bounds.x + bounds.w) * fx) + 2);
+            int y1 = std::min(mSceneHeight, static_cast<int>((bounds.y + bounds.h) * fy) + 2);
+            sceneScissor = {x0, y0, x1 - x0, y1 - y0};
+        }
 
-GLuint EGLCore::LoadShader(GLenum type, const char *shaderSrc) {
-    GLuint shader = glCreateShader(type);
-    if (shader == 0)
-        return 0;
-
-    glShaderSource(shader, 1, &shaderSrc, nullptr);
-    glCompileShader(shader);
-
-    GLint compiled;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (!compiled) {
-        GLint infoLen = 0;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 1) {
-            char *infoLog = (char *)malloc(sizeof(char) * infoLen);
-            glGetShaderInfoLog(shader, infoLen, nullptr, infoLog);
-            LOGE("Shader compile error: %{public}s", infoLog);
-            free(infoLog);
+        mGL.BindFramebuffer(GL_FRAMEBUFFER, mSceneFbo);
+        DrawScene(mSceneWidth, mSceneHeight, scenePartial ? &sceneScissor : nullptr);
+
+        // Upscale in a single blit; the scissor test limits it to the window damage region.
+        mGL.BindFramebuffer(GL_READ_FRAMEBUFFER, mSceneFbo);
+        mGL.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        mGL.SetScissorTest(partial);
+        if (partial) {
+            mGL.Scissor(scissor.x, scissor.y, scissor.w, scissor.h);
         }
-        glDeleteShader(shader);
-        return 0;
+        GL().BlitFramebuffer(0, 0, mSceneWidth, mSceneHeight, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        mGL.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    } else {
+        DrawScene(width_, height_, partial ? &scissor : nullptr);
     }
-    return shader;
+
+    // Queued behind the draws; the pixels are picked up by Poll() in a later frame.
+    mCapture.Capture(mGL, width_, height_, mFramesPresented + 1, mWorld.SimSeconds());
+    {
+        TRACE_SCOPE("glFinish");
+        GL().Flush();
+        GL().Finish();
+    }
+    return partial;
 }
 
-GLuint EGLCore::CreateProgram(const char *vertexShader, const char *fragShader) {
-    GLuint vertex = LoadShader(GL_VERTEX_SHADER, vertexShader);
-    GLuint fragment = LoadShader(GL_FRAGMENT_SHADER, fragShader);
-    GLuint program = glCreateProgram();
-
-    if (vertex == 0 || fragment == 0 || program == 0)
-        return 0;
-
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
-    glLinkProgram(program);
-
-    GLint linked;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint infoLen = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
-        if (infoLen > 1) {
-            char *infoLog = (char *)malloc(sizeof(char) * infoLen);
-            glGetProgramInfoLog(program, infoLen, nullptr, infoLog);
-            LOGE("Program link error: %{public}s", infoLog);
-            free(infoLog);
+bool EGLCore::DrawSoftwareFrame(DamageRect &bounds) {
+    TRACE_SCOPE("DrawScene");
+    mRasterizer.Resize(width_, height_);
+    // The framebuffer is ours and always one frame old, so only this frame's damage is redrawn.
+    bool partial = mDamage.CollectRegion(1, mDamageRects, bounds) && !mDamageRects.empty();
+    mRasterizer.Begin(CLEAR_COLOR[0], CLEAR_COLOR[1], CLEAR_COLOR[2], CLEAR_COLOR[3]);
+    mRenderQueue.Submit([this](const RenderBatch &batch) { SubmitBatch(batch); });
+    mRasterizer.Resolve(*mJobs, partial ? &mDamageRects : nullptr);
+    mCapture.CapturePixels(mRasterizer.Pixels(), mRasterizer.Width(), mRasterizer.Height(), mFramesPresented + 1,
+                           mWorld.SimSeconds());
+    return partial;
+}
+
+void EGLCore::PresentSoftwareFrame() {
+    DamageRect bounds;
+    bool partial = mDamage.CollectRegion(1, mDamageRects, bounds) && !mDamageRects.empty();
+    mPresenter.Present(mRasterizer.Pixels(), mRasterizer.Width(), mRasterizer.Height(),
+                       partial ? &mDamageRects : nullptr);
+}
+
+bool EGLCore::InitRenderer(int w, int h) {
+    width_ = w;
+    height_ = h;
+    if (mForceSoftware.load()) {
+        mSoftware = true;
+    }
+    if (mSoftware) {
+        mRasterizer.Resize(width_, height_);
+        mDamage.Resize(width_, height_);
+        return true;
+    }
+    // Compiled by the loader thread; sprites are drawn from the first frame that finds it ready.
+    mProgramHandle = 0;
+    mSpriteProgram = mUploader.CompileProgram(vertexShader, fragmentShader, "sprites");
+
+    mGL.Invalidate();
+    if (!CreateSpriteGeometry()) {
+        LOGE("Could not create sprite geometry");
+        return false;
+    }
+
+    mDamage.Resize(width_, height_);
+    return true;
+}
+
+void EGLCore::RequestVsync(void (EGLCore::*frame)(long long timestamp)) {
+    struct Request {
+        std::shared_ptr<LoopContext> loop;
+        void (EGLCore::*frame)(long long timestamp);
+    };
+    // Freed by the callback. A request the platform drops with a destroyed vsync keeps its small context.
+    Request *request = new Request {mLoop, frame};
+    int ret = OH_NativeVSync_RequestFrame(
+        mVsync,
+        [](long long timestamp, void *data) {
+            std::unique_ptr<Request> request(static_cast<Request *>(data));
+            std::lock_guard<std::mutex> lock(request->loop->mutex);
+            EGLCore *eglCore = request->loop->core;
+            // A callback that was already queued when the surface, or the whole EGLCore, went away.
+            if (eglCore && eglCore->mVsync) {
+                (eglCore->*request->frame)(timestamp);
+            }
+        },
+        request);
+    if (ret != 0) {
+        LOGE("OH_NativeVSync_RequestFrame failed: %{public}d", ret);
+        delete request;
+    }
+}
+
+void EGLCore::RequestNextFrame() { RequestVsync(&EGLCore::GameLoop); }
+
+bool EGLCore::RenderFrame(float deltaSeconds) {
+    auto frameStart = std::chrono::steady_clock::now();
+    ApplyPendingSize();
+    mGL.BeginFrame();
+    if (!mSoftware && mUploader.Poll()) {
+        mGL.Invalidate();
+    }
+    if (!mProgramHandle && mSpriteProgram) {
+        mProgramHandle = mUploader.Name(mSpriteProgram);
+        if (mUploader.State(mSpriteProgram) == GpuResourceState::Failed) {
+            LOGE("Could not create program");
+            mSpriteProgram = 0;
+            // A driver that cannot compile the sprite shader cannot draw the game either.
+            mFallbackPending = true;
         }
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        glDeleteProgram(program);
-        return 0;
     }
+    {
+        std::lock_guard<std::mutex> lock(mSpawnTableMutex);
+        if (mPendingSpawnTable) {
+            mWorld.SetSpawnTable(std::move(mPendingSpawnTable));
+            mPendingSpawnTable = nullptr;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mCollisionAtlasMutex);
+        if (mCollisionAtlasChanged) {
+            mWorld.SetCollisionMasks(std::move(mPendingCollisionAtlas));
+            mPendingCollisionAtlas = nullptr;
+            mCollisionAtlasChanged = false;
+        }
+    }
+    if (mCaptureChanged.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mCaptureMutex);
+        if (mCaptureEnabled) {
+            mCapture.Configure(std::move(mPendingCapture), [this](std::shared_ptr<CapturedFrame> frame) {
+                mCaptureWriter.Submit(std::move(frame));
+            });
+            // A parked loop may have nothing to redraw; start from a complete frame.
+            mDamage.Invalidate();
+        } else {
+            mCapture.Stop();
+        }
+    }
+    mCapture.Poll(mGL);
+    if (mRestartPending.exchange(false)) {
+        mWorld.Init();
+        mInput.Reset();
+    }
+    if (mSnapshotPending.exchange(false)) {
+        SaveSnapshot();
+    }
+    if (mScheduler.State() != FrameState::Paused) {
+        TRACE_SCOPE("UpdateGame");
+        mWorld.Advance(*mJobs, deltaSeconds);
+        size_t entityBytes = mWorld.Entities().CapacityBytes();
+        if (entityBytes != mEntityBytes) {
+            mEntityBytes = entityBytes;
+            mTrackedEntities.Resize(entityBytes);
+        }
+        if (mWorld.IsGameOver() && mScheduler.State() == FrameState::Play) {
+            mScheduler.SetState(FrameState::GameOver);
+        }
+    }
+    LatchInput(mWorld.TakeInputApplied());
+    bool offscreen = !mSoftware && EnsureSceneTarget();
+    TrackFrameDamage();
+
+    bool sceneChanged = !mDamage.IsEmpty();
+    if (!sceneChanged) {
+        // The previous frame is still on screen and still correct.
+        mDamage.DropFrame();
+    } else {
+        BuildFrame();
+        DamageRect scissor;
+        bool partial = mSoftware ? DrawSoftwareFrame(scissor) : DrawGLFrame(offscreen, scissor);
+        // glFinish has waited for the GPU, so this covers both simulation/submission and GPU time. The
+        // software rasterizer is done when it returns.
+        float frameMs =
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        if (!mSoftware) {
+            UpdateRenderScale(frameMs);
+        }
+        mLastFrameMs = frameMs;
+
+        float total = static_cast<float>(width_) * static_cast<float>(height_);
+        mDamagedPercentSum += mDamage.DamagedPercent();
+        mTouchedPercentSum += (partial && total > 0) ? 100.0f * scissor.w * scissor.h / total : 100.0f;
+        if (!mProgramHandle && mSpriteProgram) {
+            // Sprites were skipped; redraw all of them once the program is ready.
+            mDamage.Invalidate();
+        }
+    }
+    PublishSharedState(deltaSeconds, sceneChanged);
+    PostGameEvents();
+    return sceneChanged;
+}
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    return program;
+void EGLCore::PostGameEvents() {
+    TRACE_SCOPE("PostGameEvents");
+    mWorld.TakeEvents(mGameEvents);
+    for (const GameEvent &event : mGameEvents) {
+        mEvents->Post(event);
+    }
+    FrameState state = mScheduler.State();
+    if (state != mReportedState) {
+        mReportedState = state;
+        mEvents->Post({GameEventType::StateChanged, static_cast<int32_t>(state), 0.0f, 0.0f});
+    }
+    mEvents->Flush();
+}
+
+void EGLCore::PublishSharedState(float deltaSeconds, bool presented) {
+    if (deltaSeconds > 0.0f) {
+        float fps = 1.0f / deltaSeconds;
+        mSmoothedFps = mSmoothedFps > 0.0f ? mSmoothedFps + (fps - mSmoothedFps) * 0.1f : fps;
+    }
+
+    SharedStateValues values;
+    if (presented) {
+        mFramesPresented++;
+    }
+    values.frame = mFramesPresented;
+    values.score = mWorld.Score();
+    values.state = static_cast<int32_t>(mScheduler.State());
+    values.obstacles = mWorld.ObstacleCount();
+    if (const Position *player = mWorld.PlayerPosition()) {
+        values.playerX = player->x;
+        values.playerY = player->y;
+    }
+    values.fps = mSmoothedFps;
+    values.frameMs = mLastFrameMs;
+    {
+        std::lock_guard<std::mutex> lock(mScalerMutex);
+        values.renderScale = mAdaptiveResolution ? mScaler.Scale() : 1.0f;
+    }
+    values.simSeconds = static_cast<float>(mWorld.SimSeconds());
+    values.inputLatencyMs = mInput.SmoothedLatencyMs();
+    mShared->Publish(values);
+    TRACE_COUNTER("fps", values.fps);
+    TRACE_COUNTER("frameMs", values.frameMs);
+    TRACE_COUNTER("obstacles", values.obstacles);
+}
+
+void EGLCore::GameLoop(long long timestamp) {
+    Tracer::SetThreadName("render");
+    TRACE_SCOPE("GameLoop");
+    if (!mScheduler.OnVsync()) {
+        RequestNextFrame();
+        return;
+    }
+    // Simulation time follows the vsync timestamps: the time base only moves on frames that run, so the
+    // delta covers the vsyncs the scheduler skipped and the published fps is the rendered rate.
+    float deltaSeconds = mLastVsyncTimestamp > 0 ? static_cast<float>(timestamp - mLastVsyncTimestamp) * 1e-9f
+                                                 : NOMINAL_FRAME_SECONDS;
+    mLastVsyncTimestamp = timestamp;
+
+    if (!mSoftware && !eglMakeCurrent(mEGLDisplay, mEGLSurface, mEGLSurface, mEGLContext)) {
+        LOGE("GameLoop: eglMakeCurrent error = %{public}d", eglGetError());
+        return;
+    }
+
+    bool sceneChanged = RenderFrame(deltaSeconds);
+    if (sceneChanged && mSoftware) {
+        TRACE_SCOPE("PresentWindowBuffer");
+        PresentSoftwareFrame();
+        mInput.OnPresented();
+    } else if (sceneChanged) {
+        TRACE_SCOPE("eglSwapBuffers");
+        PresentFrame();
+        mInput.OnPresented();
+    }
+    if (mFallbackPending) {
+        mFallbackPending = false;
+        FallBackToSoftware();
+        mDamage.Invalidate();
+    }
+
+    mScheduler.OnFrameDone(sceneChanged);
+    mGLCallsIssued += mGL.FrameStats().issued;
+    mGLCallsElided += mGL.FrameStats().elided;
+
+    if (++mStatFrames >= DAMAGE_STATS_INTERVAL) {
+        FrameSchedulerStats frameStats = mScheduler.Stats();
+        LOGI("Damage stats: damaged=%{public}.1f%% touched=%{public}.1f%% per frame",
+             mDamagedPercentSum / mStatFrames, mTouchedPercentSum / mStatFrames);
+        LOGI("Frame stats: rendered %{public}llu of %{public}llu vsyncs, skipped=%{public}llu parks=%{public}llu",
+             (unsigned long long)frameStats.framesRendered, (unsigned long long)frameStats.vsyncs,
+             (unsigned long long)frameStats.vsyncsSkipped, (unsigned long long)frameStats.parks);
+        LOGI("GL state stats: issued=%{public}.1f elided=%{public}.1f calls per frame",
+             static_cast<float>(mGLCallsIssued) / mStatFrames, static_cast<float>(mGLCallsElided) / mStatFrames);
+        mDamagedPercentSum = 0.0f;
+        mTouchedPercentSum = 0.0f;
+        CollisionStats collisionStats = mWorld.TakeCollisionStats();
+        if (collisionStats.ticks > 0) {
+            LOGI("Collision stats: %{public}.2f box hits, %{public}.2f mask tests (%{public}llu cleared) per tick, "
+                 "avg=%{public}.1f max=%{public}.1f us",
+                 static_cast<float>(collisionStats.boxHits) / collisionStats.ticks,
+                 static_cast<float>(collisionStats.maskTests) / collisionStats.ticks,
+                 (unsigned long long)collisionStats.maskMisses, collisionStats.totalUs / collisionStats.ticks,
+                 collisionStats.maxUs);
+        }
+        if (mSpritesDrawn > 0) {
+            LOGI("Sprite stats: %{public}.1f sprites per frame, %{public}.1f bytes uploaded per sprite",
+                 static_cast<float>(mSpritesDrawn) / mStatFrames,
+                 static_cast<float>(mSpriteBytesUploaded) / mSpritesDrawn);
+        }
+        EventBusStats eventStats = mEvents->TakeStats();
+        LOGI("Event stats: posted=%{public}llu coalesced=%{public}llu dropped=%{public}llu batches=%{public}llu "
+             "deferred=%{public}llu max depth=%{public}u",
+             (unsigned long long)eventStats.posted, (unsigned long long)eventStats.coalesced,
+             (unsigned long long)eventStats.dropped, (unsigned long long)eventStats.batches,
+             (unsigned long long)eventStats.deferred, eventStats.maxDepth);
+        InputLatencyStats inputStats = mInput.TakeStats();
+        if (inputStats.samples > 0) {
+            LOGI("Input stats (late latch %{public}s): latency avg=%{public}.1f max=%{public}.1f ms over %{public}u "
+                 "frames", mLateLatch.load() ? "on" : "off", inputStats.totalMs / inputStats.samples,
+                 inputStats.maxMs, inputStats.samples);
+        }
+        GpuUploaderStats uploadStats = mUploader.TakeStats();
+        if (uploadStats.submitted > 0 || uploadStats.completed > 0 || uploadStats.failed > 0) {
+            uint32_t finished = uploadStats.completed + uploadStats.failed;
+            LOGI("Upload stats (%{public}s): submitted=%{public}u completed=%{public}u failed=%{public}u "
+                 "bytes=%{public}llu latency avg=%{public}.2f max=%{public}.2f ms",
+                 mUploader.Threaded() ? "loader thread" : "inline", uploadStats.submitted, uploadStats.completed,
+                 uploadStats.failed, (unsigned long long)uploadStats.bytesUploaded,
+                 finished > 0 ? uploadStats.totalLatencyMs / finished : 0.0f, uploadStats.maxLatencyMs);
+        }
+        SoftwareRasterStats rasterStats = mRasterizer.TakeStats();
+        if (rasterStats.frames > 0) {
+            LOGI("Software raster stats: %{public}.1f sprites, %{public}.1f tiles drawn, %{public}.1f kept per frame",
+                 static_cast<float>(rasterStats.sprites) / rasterStats.frames,
+                 static_cast<float>(rasterStats.tilesDrawn) / rasterStats.frames,
+                 static_cast<float>(rasterStats.tilesKept) / rasterStats.frames);
+        }
+        FrameCaptureStats captureStats = mCapture.TakeStats();
+        CaptureWriterStats writerStats = mCaptureWriter.TakeStats();
+        if (captureStats.captured > 0 || captureStats.delivered > 0 || captureStats.dropped > 0) {
+            LOGI("Capture stats: captured=%{public}u delivered=%{public}u dropped=%{public}u failed=%{public}u "
+                 "written=%{public}u write drops=%{public}u latency avg=%{public}.2f max=%{public}.2f ms",
+                 captureStats.captured, captureStats.delivered, captureStats.dropped, captureStats.failed,
+                 writerStats.written, writerStats.dropped,
+                 captureStats.delivered > 0 ? captureStats.totalLatencyMs / captureStats.delivered : 0.0f,
+                 captureStats.maxLatencyMs);
+        }
+        mSpritesDrawn = 0;
+        mSpriteBytesUploaded = 0;
+        mGLCallsIssued = 0;
+        mGLCallsElided = 0;
+        mStatFrames = 0;
+    }
+
+    if (mScheduler.ShouldContinue()) {
+        RequestNextFrame();
+    } else {
+        // The next vsync after waking starts a fresh time base.
+        mLastVsyncTimestamp = 0;
+        LOGI("Game loop parked - scene is static");
+    }
+}
+
+void EGLCore::MovePlayerLeft() {
+    if (mWorld.IsGameOver() || mScheduler.State() == FrameState::Paused)
+        return;
+    // Applied by the render thread at the start of the next tick.
+    mWorld.QueueMove(-1);
+    mInput.OnMove(-1);
+    if (mVsync && mScheduler.Wake()) {
+        RequestNextFrame();
+    }
+}
+
+void EGLCore::MovePlayerRight() {
+    if (mWorld.IsGameOver() || mScheduler.State() == FrameState::Paused)
+        return;
+    // Applied by the render thread at the start of the next tick.
+    mWorld.QueueMove(1);
+    mInput.OnMove(1);
+    if (mVsync && mScheduler.Wake()) {
+        RequestNextFrame();
+    }
+}
+
+void EGLCore::RestartGame() {
+    LOGI("Restarting game...");
+    // The world is reset on the render thread at the start of the next frame.
+    mRestartPending.store(true);
+    mScheduler.SetState(FrameState::Play);
+    if (mVsync && mScheduler.Wake()) {
+        RequestNextFrame();
+    }
+}
+
+void EGLCore::SetPaused(bool paused) {
+    LOGI("Game %{public}s", paused ? "paused" : "resumed");
+    if (paused) {
+        mScheduler.SetState(FrameState::Paused);
+        // Written by the render thread on the frame that wakes for the pause.
+        mSnapshotPending.store(true);
+    } else {
+        mScheduler.SetState(mWorld.IsGameOver() ? FrameState::GameOver : FrameState::Play);
+    }
+    if (mVsync && mScheduler.Wake()) {
+        RequestNextFrame();
+    }
+}
+
+void EGLCore::Update() { eglSwapBuffers(mEGLDisplay, mEGLSurface); }
+
+GLuint EGLCore::LoadShader(GLenum type, const char *shaderSrc) { return BuildShader(type, shaderSrc); }
+
+GLuint EGLCore::CreateProgram(const char *vertexShader, const char *fragShader) {
+    return BuildProgram(vertexShader, fragShader);
 }
 
 GLuint EGLCore::CreateProgramError(const char *vertexShader, const char *fragShader) { return 0; }
 
+EGLCore::~EGLCore() {
+    // Waits for a vsync callback that is running; the ones still queued find no core.
+    std::lock_guard<std::mutex> lock(mLoop->mutex);
+    mLoop->core = nullptr;
+}
+
 void EGLCore::OnSurfaceDestroyed() {
     LOGI("EGLCore::OnSurfaceDestroyed");
-    if (mVsync) {
-        OH_NativeVSync_Destroy(mVsync);
+    OH_NativeVSync *vsync = nullptr;
+    {
+        // Destroying the vsync does not wait for a callback that is running; the lock does, and the callbacks
+        // that come after it find no vsync and return.
+        std::lock_guard<std::mutex> lock(mLoop->mutex);
+        vsync = mVsync;
         mVsync = nullptr;
     }
-    if (mEGLContext != EGL_NO_CONTEXT) {
-        eglDestroyContext(mEGLDisplay, mEGLContext);
-        mEGLContext = EGL_NO_CONTEXT;
-    }
-    if (mEGLSurface != EGL_NO_SURFACE) {
-        eglDestroySurface(mEGLDisplay, mEGLSurface);
-        mEGLSurface = EGL_NO_SURFACE;
+    if (vsync) {
+        OH_NativeVSync_Destroy(vsync);
     }
+    // The game loop has stopped, so the world can be saved from this thread.
+    SaveSnapshot();
+    mSnapshotFile.Close();
+    ReleaseEGL();
+    // The next surface tries GLES again unless software rendering was asked for.
+    mPresenter.Detach();
+    mSoftware = false;
+    mFallbackPending = false;
 }
 
 void EGLCore::OnSurfaceChanged(void *window, int32_t w, int32_t h) {
-    width_ = w;
-    height_ = h;
+    // Applied by the render thread at the start of the next frame; the size and damage state are its own.
+    mPendingSize.store((static_cast<uint64_t>(static_cast<uint32_t>(w)) << 32) | static_cast<uint32_t>(h));
+    if (mVsync && mScheduler.Wake()) {
+        RequestNextFrame();
+    }
+}
+
+void EGLCore::ApplyPendingSize() {
+    uint64_t size = mPendingSize.exchange(0);
+    if (size == 0) {
+        return;
+    }
+    width_ = static_cast<int32_t>(size >> 32);
+    height_ = static_cast<int32_t>(size & 0xffffffffu);
+    if (mTrackedSurface.Active()) {
+        mTrackedSurface.Resize(WindowSurfaceBytes(width_, height_));
+    }
+    mDamage.Resize(width_, height_);
 }
 
 void EGLCore::DrawSquare() {}
@@ -1,26 +1,88 @@
 #ifndef EGL_CORE_SHADER_H
 #define EGL_CORE_SHADER_H
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 #include <GLES3/gl3.h>
 #include <native_vsync/native_vsync.h>
 #include <string>
+#include <vector>
+#include "damage_tracker.h"
+#include "resolution_scaler.h"
+#include "frame_scheduler.h"
+#include "render_queue.h"
+#include "gl_state_cache.h"
+#include "gl_dispatch.h"
+#include "job_system.h"
+#include "game_world.h"
+#include "world_snapshot.h"
+#include "shared_state.h"
+#include "event_bus.h"
+#include "gpu_uploader.h"
+#include "resource_registry.h"
+#include "input_latch.h"
+#include "frame_capture.h"
+#include "capture_writer.h"
+#include "sprite_instance.h"
+#include "software_rasterizer.h"
+#include "window_presenter.h"
 
 class EGLCore {
 public:
-    EGLCore(std::string &id) : mId(id) {}
+    EGLCore(std::string &id) : mId(id), mJobs(std::make_unique<JobSystem>()) { mLoop->core = this; }
+    ~EGLCore();
     
     void OnSurfaceCreated(void *window, int w, int h);
     void OnSurfaceChanged(void *window, int32_t w, int32_t h);
     void OnSurfaceDestroyed();
-    void GameLoop();
+    void GameLoop(long long timestamp);
+    // Renderer setup and one frame of simulation and drawing, without any EGL calls. GameLoop wraps
+    // these with the surface; with a recording GL backend they run headless.
+    bool InitRenderer(int w, int h);
+    // deltaSeconds is the display time since the previous frame; the simulation ticks at its own rate.
+    bool RenderFrame(float deltaSeconds);
     void Update();
     
     void MovePlayerLeft();
     void MovePlayerRight();
     void RestartGame();
-    void SetGameOverCallback(std::function<void(int)> callback);
+    void SetPaused(bool paused);
+    // Game events for JS; the owner installs the sink. Batches are flushed once per rendered frame.
+    std::shared_ptr<EventBus> Events() { return mEvents; }
+    void SetAdaptiveResolution(bool enabled, const ResolutionScalerConfig &config);
+    // Off: the player is drawn where the last tick left it, as before.
+    void SetLateLatch(bool enabled);
+    // Most obstacles alive at once (GameWorld::kDefaultObstacleLimit unless changed, at most kMaxObstacleLimit).
+    // Any thread.
+    void SetObstacleLimit(size_t limit);
+    // Draws on the CPU and presents through the window's buffer queue instead of GLES, from the next surface
+    // (or InitRenderer in headless runs). The renderer also falls back to it when EGL or the sprite shader
+    // cannot be set up.
+    void SetSoftwareRendering(bool enabled);
+    // Compiles or maps the spawn table on the calling thread; the render thread switches to it next frame.
+    bool LoadSpawnSchedule(const std::string &text, const std::string &cachePath);
+    // Builds collision masks from the alpha of an RGBA atlas of frameWidth x frameHeight frames on the calling
+    // thread. Returns null and logs when the atlas holds no whole frame.
+    static std::shared_ptr<const CollisionAtlas> BuildCollisionMasks(const uint8_t *rgba, int width, int height,
+                                                                     int frameWidth, int frameHeight);
+    // The render thread switches to the masks next frame; null turns pixel-accurate collision off. Any thread.
+    void SetCollisionMasks(std::shared_ptr<const CollisionAtlas> atlas);
+    // World snapshots: saved on pause and surface loss, restored when the next surface starts. Any thread.
+    void SetSnapshotPath(const std::string &path);
+    // Render thread, or before the game loop runs; headless runs use them as checkpoints.
+    bool SaveSnapshot();
+    bool RestoreSnapshot();
+    // Reads rendered frames back without stalling and hands them to config.sink and, when a directory is
+    // given, to a writer thread as TGA files. Any thread; applied from the next frame, which is redrawn in full.
+    bool StartFrameCapture(FrameCaptureConfig config);
+    void StopFrameCapture();
+    // Live state block republished every frame; see shared_state.h for the layout.
+    std::shared_ptr<SharedState> Shared() { return mShared; }
     
     GLuint LoadShader(GLenum type, const char *shaderSrc);
     GLuint CreateProgram(const char *vertexShader, const char *fragShader);
@@ -32,17 +94,148 @@ public:
     void switchSpecular();
 
 private:
+    // Runs frame on the next vsync unless the surface, or this EGLCore, has gone by then.
+    void RequestVsync(void (EGLCore::*frame)(long long timestamp));
+    void RequestNextFrame();
+    void StartLoop(long long timestamp);
+    void ApplyPendingSize();
+    bool InitEGL(void *window);
+    // Drops the contexts, the surface and every GL object with them.
+    void ReleaseEGL();
+    void FallBackToSoftware();
+    void InitDamageExtensions();
+    void LatchInput(bool inputApplied);
+    float SpriteX(Entity entity, float x) const;
+    void TrackFrameDamage();
+    bool PrepareDamageRegion(DamageRect &scissor);
+    void PresentFrame();
+    bool CreateSpriteGeometry();
+    void BuildFrame();
+    void SubmitBatch(const RenderBatch &batch);
+    void DrawScene(int viewportWidth, int viewportHeight, const DamageRect *scissor);
+    // Draw the built frame; both return whether only the damage region was repainted, and its bounds.
+    bool DrawGLFrame(bool offscreen, DamageRect &scissor);
+    bool DrawSoftwareFrame(DamageRect &bounds);
+    void PresentSoftwareFrame();
+    bool EnsureSceneTarget();
+    void DestroySceneTarget();
+    void UpdateRenderScale(float frameMs);
+    void PublishSharedState(float deltaSeconds, bool presented);
+    void PostGameEvents();
+
     std::string mId;
+    std::unique_ptr<JobSystem> mJobs;
     EGLNativeWindowType mEglWindow;
+    void *mPendingWindow = nullptr;
     EGLDisplay mEGLDisplay = EGL_NO_DISPLAY;
     EGLConfig mEGLConfig = nullptr;
     EGLContext mEGLContext = EGL_NO_CONTEXT;
+    // Loader context of mUploader; the render context is created in its share group.
     EGLContext mSharedEGLContext = EGL_NO_CONTEXT;
     EGLSurface mEGLSurface = nullptr;
-    GLuint mProgramHandle;
+    GpuUploader mUploader;
+    GpuResourceId mSpriteProgram = 0;
+    GLuint mProgramHandle = 0;
     OH_NativeVSync *mVsync = nullptr;
+    // Shared with every queued vsync callback, so one that fires after this EGLCore was deleted finds no core
+    // rather than freed memory. The mutex is held by the callbacks while they run; mVsync is written under it
+    // once the loop is live.
+    struct LoopContext {
+        std::mutex mutex;
+        EGLCore *core = nullptr;
+    };
+    std::shared_ptr<LoopContext> mLoop = std::make_shared<LoopContext>();
     int width_ = 0;
     int height_ = 0;
+    // Width in the high half, height in the low half, from OnSurfaceChanged; 0 when nothing is pending.
+    std::atomic<uint64_t> mPendingSize {0};
+
+    DamageTracker mDamage;
+    std::vector<EGLint> mDamageRects;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC mSwapBuffersWithDamage = nullptr;
+    PFNEGLSETDAMAGEREGIONKHRPROC mSetDamageRegion = nullptr;
+    float mDamagedPercentSum = 0.0f;
+    float mTouchedPercentSum = 0.0f;
+    int mStatFrames = 0;
+
+    std::mutex mScalerMutex;
+    ResolutionScaler mScaler;
+    // Off until the app asks for it; devices that keep up should not pay for the offscreen pass.
+    bool mAdaptiveResolution = false;
+    GLuint mSceneFbo = 0;
+    GLuint mSceneColor = 0;
+    int mSceneWidth = 0;
+    int mSceneHeight = 0;
+
+    RenderQueue mRenderQueue;
+    std::vector<SpriteInstance> mBatchInstances;
+    GLStateCache mGL;
+    GLuint mSpriteVao = 0;
+    GLuint mSpriteCornerVbo = 0;
+    GLuint mSpriteInstanceVbo = 0;
+    uint64_t mSpritesDrawn = 0;
+    uint64_t mSpriteBytesUploaded = 0;
+    uint64_t mGLCallsIssued = 0;
+    uint64_t mGLCallsElided = 0;
+
+    // Software backend: active after SetSoftwareRendering or when the GL setup failed.
+    std::atomic<bool> mForceSoftware {false};
+    bool mSoftware = false;
+    bool mFallbackPending = false;
+    SoftwareRasterizer mRasterizer;
+    WindowPresenter mPresenter;
+
+    GameWorld mWorld;
+    std::mutex mSpawnTableMutex;
+    std::shared_ptr<const SpawnTable> mPendingSpawnTable;
+    std::mutex mCollisionAtlasMutex;
+    std::shared_ptr<const CollisionAtlas> mPendingCollisionAtlas;
+    bool mCollisionAtlasChanged = false;
+    long long mLastVsyncTimestamp = 0;
+    FrameScheduler mScheduler;
+    std::atomic<bool> mRestartPending {false};
+    std::mutex mSnapshotMutex;
+    std::string mSnapshotPath;
+    std::atomic<bool> mSnapshotPending {false};
+    WorldSnapshotFile mSnapshotFile;
+    std::vector<uint8_t> mSnapshotBuffer;
+
+    // Player position sampled just before the frame is built; see LatchInput.
+    InputLatch mInput;
+    std::atomic<bool> mLateLatch {true};
+    bool mPlayerLatched = false;
+    float mLatchedPlayerX = 0.0f;
+
+    FrameCapture mCapture;
+    CaptureWriter mCaptureWriter;
+    std::mutex mCaptureMutex;
+    FrameCaptureConfig mPendingCapture;
+    bool mCaptureEnabled = false;
+    std::atomic<bool> mCaptureChanged {false};
+
+    // Batches in flight to JS keep the bus alive after this EGLCore is deleted.
+    std::shared_ptr<EventBus> mEvents = std::make_shared<EventBus>();
+    std::vector<GameEvent> mGameEvents;
+    FrameState mReportedState = FrameState::Play;
+
+    // Shared with the ArrayBuffers handed to ArkTS, which may outlive this EGLCore.
+    std::shared_ptr<SharedState> mShared = std::make_shared<SharedState>();
+    // Frames drawn and presented; restored along with a world snapshot so capture names keep increasing.
+    int32_t mFramesPresented = 0;
+    float mSmoothedFps = 0.0f;
+    float mLastFrameMs = 0.0f;
+
+    // Registry entries for the objects above; GL ones are dropped with the context on surface loss.
+    TrackedResource mTrackedSelf {ResourceKind::Heap, "EGLCore", sizeof(EGLCore)};
+    TrackedResource mTrackedEntities {ResourceKind::Heap, "entities", 0};
+    TrackedResource mTrackedSurface;
+    TrackedResource mTrackedSceneFbo;
+    TrackedResource mTrackedSceneColor;
+    TrackedResource mTrackedSpriteVao;
+    TrackedResource mTrackedSpriteCorners;
+    TrackedResource mTrackedSpriteInstances;
+    uint64_t mSpriteInstanceCapacity = 0;
+    size_t mEntityBytes = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include "event_bus.h"
+
+EventBus::EventBus() : freeMask_((1u << kPoolSize) - 1) { ResetCoalescing(); }
+
+EventBatch *EventBus::Acquire() {
+    uint32_t mask = freeMask_.load(std::memory_order_acquire);
+    while (mask != 0) {
+        uint32_t lowest = mask & (~mask + 1);
+        if (freeMask_.compare_exchange_weak(mask, mask & ~lowest, std::memory_order_acq_rel)) {
+            int index = 0;
+            while ((lowest >> index) != 1u) {
+                index++;
+            }
+            pool_[index].count = 0;
+            return &pool_[index];
+        }
+    }
+    return nullptr;
+}
+
+void EventBus::Release(EventBatch *batch) {
+    if (!batch) {
+        return;
+    }
+    batch->count = 0;
+    freeMask_.fetch_or(1u << static_cast<uint32_t>(batch - pool_), std::memory_order_release);
+}
+
+void EventBus::SetSink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    sink_ = std::move(sink);
+}
+
+bool EventBus::Coalesces(GameEventType type) const {
+    return type == GameEventType::ScoreChanged || type == GameEventType::StateChanged;
+}
+
+void EventBus::ResetCoalescing() {
+    std::fill(std::begin(coalesceIndex_), std::end(coalesceIndex_), -1);
+    spawnCount_ = 0;
+}
+
+bool EventBus::EvictSpawn() {
+    GameEvent *events = current_->events;
+    for (uint32_t i = current_->count; i-- > 0;) {
+        if (events[i].type != GameEventType::Spawn) {
+            continue;
+        }
+        std::copy(events + i + 1, events + current_->count, events + i);
+        current_->count--;
+        spawnCount_--;
+        for (int32_t &index : coalesceIndex_) {
+            if (index > static_cast<int32_t>(i)) {
+                index--;
+            }
+        }
+        stats_.dropped++;
+        return true;
+    }
+    return false;
+}
+
+void EventBus::Post(const GameEvent &event) {
+    stats_.posted++;
+    int type = static_cast<int>(event.type);
+    if (type < 0 || type >= static_cast<int>(GameEventType::Count)) {
+        stats_.dropped++;
+        return;
+    }
+    if (!current_) {
+        current_ = Acquire();
+    }
+    if (!current_) {
+        stats_.dropped++;
+        return;
+    }
+
+    if (Coalesces(event.type) && coalesceIndex_[type] >= 0) {
+        current_->events[coalesceIndex_[type]] = event;
+        stats_.coalesced++;
+        return;
+    }
+    bool spawn = event.type == GameEventType::Spawn;
+    if (spawn && spawnCount_ >= kSpawnSlots) {
+        stats_.dropped++;
+        return;
+    }
+    if (current_->count >= EventBatch::kCapacity && (spawn || !EvictSpawn())) {
+        stats_.dropped++;
+        return;
+    }
+    if (Coalesces(event.type)) {
+        coalesceIndex_[type] = static_cast<int32_t>(current_->count);
+    }
+    if (spawn) {
+        spawnCount_++;
+    }
+    current_->events[current_->count++] = event;
+    stats_.maxDepth = std::max(stats_.maxDepth, current_->count);
+}
+
+void EventBus::Flush() {
+    if (!current_ || current_->count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    if (!sink_) {
+        // Nobody is listening; do not let stale events pile up.
+        stats_.dropped += current_->count;
+        current_->count = 0;
+        ResetCoalescing();
+        return;
+    }
+
+    EventBatch *next = Acquire();
+    if (!next) {
+        // JS still holds every other batch: keep collecting and try again next frame.
+        stats_.deferred++;
+        return;
+    }
+    EventBatch *batch = current_;
+    current_ = next;
+    ResetCoalescing();
+    stats_.batches++;
+    if (!sink_(batch)) {
+        stats_.dropped += batch->count;
+        Release(batch);
+    }
+}
+
+EventBusStats EventBus::TakeStats() {
+    EventBusStats stats = stats_;
+    stats_ = EventBusStats();
+    return stats;
+}
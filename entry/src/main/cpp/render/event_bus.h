@@ -0,0 +1,70 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include "game_events.h"
+#include "resource_registry.h"
+
+struct EventBatch {
+    static constexpr size_t kCapacity = 128;
+    GameEvent events[kCapacity];
+    uint32_t count = 0;
+};
+
+struct EventBusStats {
+    uint64_t posted = 0;
+    uint64_t coalesced = 0;
+    uint64_t dropped = 0;
+    uint64_t batches = 0;
+    // Flushes postponed because every batch was still with JS.
+    uint64_t deferred = 0;
+    uint32_t maxDepth = 0;
+};
+
+// Engine-to-JS event channel. The render thread posts into the current batch and hands it to the sink
+// at most once per frame; the sink forwards it over one threadsafe-function call and the JS side gives
+// it back with Release. Batches come from a fixed pool, so posting never allocates. Score and state
+// events replace an earlier one of the same type that has not been flushed yet. When a batch fills up,
+// for instance while JS holds every other batch, spawn events are dropped first: they may take at most
+// kSpawnSlots slots, and a full batch gives up its newest spawn for any other event.
+class EventBus {
+public:
+    static constexpr int kPoolSize = 4;
+    static constexpr uint32_t kSpawnSlots = EventBatch::kCapacity - 16;
+    // Returns false if the batch could not be queued; the bus then takes it back.
+    using Sink = std::function<bool(EventBatch *batch)>;
+
+    EventBus();
+
+    // Any thread.
+    void SetSink(Sink sink);
+    void Release(EventBatch *batch);
+
+    // Render thread.
+    void Post(const GameEvent &event);
+    void Flush();
+    // Returns the counters accumulated since the previous call.
+    EventBusStats TakeStats();
+
+private:
+    EventBatch *Acquire();
+    bool Coalesces(GameEventType type) const;
+    bool EvictSpawn();
+    void ResetCoalescing();
+
+    EventBatch pool_[kPoolSize];
+    std::atomic<uint32_t> freeMask_;
+    EventBatch *current_ = nullptr;
+    int32_t coalesceIndex_[static_cast<int>(GameEventType::Count)];
+    uint32_t spawnCount_ = 0;
+    std::mutex sinkMutex_;
+    Sink sink_;
+    EventBusStats stats_;
+    TrackedResource tracked_ {ResourceKind::Heap, "EventBus", sizeof(EventBus)};
+};
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,178 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include "frame_capture.h"
+#include "gl_dispatch.h"
+#include "tracing.h"
+#include "plugin_common.h"
+
+namespace {
+const uint64_t BYTES_PER_PIXEL = 4;
+
+float MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+void FrameCapture::Configure(FrameCaptureConfig config, Deliver deliver) {
+    config_ = std::move(config);
+    if (config_.everyN == 0) {
+        config_.everyN = 1;
+    }
+    deliver_ = std::move(deliver);
+    rendered_ = 0;
+    taken_ = 0;
+    active_ = true;
+}
+
+void FrameCapture::Stop() {
+    active_ = false;
+}
+
+bool FrameCapture::Due() {
+    return active_ && rendered_++ % config_.everyN == 0;
+}
+
+void FrameCapture::Taken() {
+    stats_.captured++;
+    if (config_.maxFrames > 0 && ++taken_ >= config_.maxFrames) {
+        LOGI("Frame capture: %{public}u frames taken, stopping", taken_);
+        active_ = false;
+    }
+}
+
+void FrameCapture::Capture(GLStateCache &gl, int width, int height, uint32_t frame, double simSeconds) {
+    if (width <= 0 || height <= 0 || !Due()) {
+        return;
+    }
+    Slot &slot = slots_[next_];
+    if (slot.fence) {
+        // Still waiting on the GPU; a blocking wait here is exactly what the ring is for avoiding.
+        stats_.dropped++;
+        return;
+    }
+    TRACE_SCOPE("CaptureFrame");
+    uint64_t bytes = static_cast<uint64_t>(width) * height * BYTES_PER_PIXEL;
+    if (bytes > slot.capacity) {
+        if (!ResourceRegistry::GetInstance()->Fits(ResourceKind::Buffer, bytes - slot.capacity)) {
+            stats_.dropped++;
+            return;
+        }
+        if (!slot.buffer) {
+            GL().GenBuffers(1, &slot.buffer);
+        }
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        GL().BufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        slot.capacity = bytes;
+        if (slot.tracked.Active()) {
+            slot.tracked.Resize(bytes);
+        } else {
+            slot.tracked.Reset(ResourceKind::Buffer, "frame capture", bytes);
+        }
+    }
+    gl.BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    // With a pack buffer bound the pointer is an offset, and the copy is queued instead of waited for.
+    GL().ReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = GL().FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.frame = frame;
+    slot.simSeconds = simSeconds;
+    slot.issued = std::chrono::steady_clock::now();
+    next_ = (next_ + 1) % RING_SIZE;
+    Taken();
+}
+
+void FrameCapture::CapturePixels(const uint32_t *pixels, int width, int height, uint32_t frame, double simSeconds) {
+    if (width <= 0 || height <= 0 || !Due()) {
+        return;
+    }
+    Taken();
+    auto captured = std::make_shared<CapturedFrame>();
+    captured->frame = frame;
+    captured->simSeconds = simSeconds;
+    captured->width = width;
+    captured->height = height;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pixels);
+    captured->rgba.assign(bytes, bytes + static_cast<size_t>(width) * height * BYTES_PER_PIXEL);
+    Publish(std::move(captured));
+}
+
+void FrameCapture::Poll(GLStateCache &gl) {
+    // Fences signal in submission order, so stop at the first one that has not.
+    for (int i = 0; i < RING_SIZE; i++) {
+        Slot &slot = slots_[(next_ + i) % RING_SIZE];
+        if (slot.fence && !Collect(gl, slot)) {
+            break;
+        }
+    }
+}
+
+bool FrameCapture::Collect(GLStateCache &gl, Slot &slot) {
+    GLenum result = GL().ClientWaitSync(slot.fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    GL().DeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (result == GL_WAIT_FAILED) {
+        stats_.failed++;
+        return true;
+    }
+    float latencyMs = MillisecondsSince(slot.issued);
+    stats_.totalLatencyMs += latencyMs;
+    stats_.maxLatencyMs = std::max(stats_.maxLatencyMs, latencyMs);
+
+    TRACE_SCOPE("CollectFrame");
+    auto frame = std::make_shared<CapturedFrame>();
+    frame->frame = slot.frame;
+    frame->simSeconds = slot.simSeconds;
+    frame->width = slot.width;
+    frame->height = slot.height;
+    size_t bytes = static_cast<size_t>(slot.width) * slot.height * BYTES_PER_PIXEL;
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    void *mapped = GL().MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+    if (mapped) {
+        frame->rgba.assign(static_cast<const uint8_t *>(mapped), static_cast<const uint8_t *>(mapped) + bytes);
+        GL().UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        LOGE("Frame capture: cannot map readback of frame %{public}u", slot.frame);
+        stats_.failed++;
+        return true;
+    }
+
+    Publish(std::move(frame));
+    return true;
+}
+
+void FrameCapture::Publish(std::shared_ptr<CapturedFrame> frame) {
+    stats_.delivered++;
+    if (config_.sink) {
+        config_.sink(*frame);
+    }
+    if (deliver_) {
+        deliver_(std::move(frame));
+    }
+}
+
+void FrameCapture::Abandon() {
+    for (Slot &slot : slots_) {
+        if (slot.fence) {
+            stats_.dropped++;
+        }
+        slot.buffer = 0;
+        slot.capacity = 0;
+        slot.fence = nullptr;
+        slot.tracked.Reset();
+    }
+    next_ = 0;
+}
+
+FrameCaptureStats FrameCapture::TakeStats() {
+    FrameCaptureStats stats = stats_;
+    stats_ = {};
+    return stats;
+}
@@ -0,0 +1,101 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GLES3/gl3.h>
+#include "gl_state_cache.h"
+#include "resource_registry.h"
+
+// One frame as it was presented: RGBA8 rows, bottom row first as GL reads them.
+struct CapturedFrame {
+    // Published frame number and simulation time the image belongs to.
+    uint32_t frame = 0;
+    double simSeconds = 0.0;
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgba;
+};
+
+struct FrameCaptureConfig {
+    // Images are written here as frame_<frame>.tga; empty writes nothing.
+    std::string directory;
+    // Capture every Nth rendered frame.
+    uint32_t everyN = 1;
+    // Stop after this many captures; 0 = until stopped.
+    uint32_t maxFrames = 0;
+    // Render thread, for native consumers such as golden-image checks. Keep it short.
+    std::function<void(const CapturedFrame &frame)> sink;
+};
+
+struct FrameCaptureStats {
+    uint32_t captured = 0;
+    uint32_t delivered = 0;
+    // The ring was still waiting on the GPU, or the readback buffer was over the memory budget.
+    uint32_t dropped = 0;
+    uint32_t failed = 0;
+    // Readback request to first Poll() that saw its fence signaled.
+    float maxLatencyMs = 0.0f;
+    float totalLatencyMs = 0.0f;
+};
+
+// Reads rendered frames back through a ring of pixel pack buffers. Capture() queues glReadPixels into the
+// next buffer and fences it; Poll() maps the buffers whose fences have signaled, a frame or two later, so
+// the render thread never waits on the GPU for a readback. When every buffer is still in flight the
+// frame is dropped rather than stalled on. Render thread only, with the context current.
+class FrameCapture {
+public:
+    using Deliver = std::function<void(std::shared_ptr<CapturedFrame> frame)>;
+    static constexpr int RING_SIZE = 3;
+
+    // Applies to the next rendered frame; readbacks in flight are still delivered.
+    void Configure(FrameCaptureConfig config, Deliver deliver);
+    void Stop();
+    bool Active() const { return active_; }
+
+    // After the frame is drawn and before it is swapped; reads the window framebuffer.
+    void Capture(GLStateCache &gl, int width, int height, uint32_t frame, double simSeconds);
+    // Same schedule for frames rendered on the CPU (RGBA8, bottom row first); delivered right away.
+    void CapturePixels(const uint32_t *pixels, int width, int height, uint32_t frame, double simSeconds);
+    // Once per frame. Delivers finished readbacks in capture order; never blocks.
+    void Poll(GLStateCache &gl);
+    // The context is gone, and the buffers and fences with it.
+    void Abandon();
+    // Returns the counters accumulated since the previous call.
+    FrameCaptureStats TakeStats();
+
+private:
+    struct Slot {
+        GLuint buffer = 0;
+        uint64_t capacity = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        uint32_t frame = 0;
+        double simSeconds = 0.0;
+        std::chrono::steady_clock::time_point issued;
+        TrackedResource tracked;
+    };
+
+    // Counts the frame against everyN and maxFrames.
+    bool Due();
+    void Taken();
+    bool Collect(GLStateCache &gl, Slot &slot);
+    void Publish(std::shared_ptr<CapturedFrame> frame);
+
+    Slot slots_[RING_SIZE];
+    // Next slot to capture into; the oldest readback in flight is the first pending one after it.
+    int next_ = 0;
+    bool active_ = false;
+    FrameCaptureConfig config_;
+    Deliver deliver_;
+    uint32_t rendered_ = 0;
+    uint32_t taken_ = 0;
+    FrameCaptureStats stats_;
+};
+
+#endif // FRAME_CAPTURE_H
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include "frame_scheduler.h"
+
+FrameScheduler::FrameScheduler() {
+    divisors_[static_cast<int>(FrameState::Play)] = 1;
+    divisors_[static_cast<int>(FrameState::Paused)] = 4;
+    divisors_[static_cast<int>(FrameState::GameOver)] = 4;
+}
+
+void FrameScheduler::SetState(FrameState state) {
+    state_.store(state, std::memory_order_relaxed);
+}
+
+void FrameScheduler::SetVsyncDivisor(FrameState state, int divisor) {
+    if (state == FrameState::Count) {
+        return;
+    }
+    divisors_[static_cast<int>(state)] = std::max(1, divisor);
+}
+
+bool FrameScheduler::OnVsync() {
+    vsyncs_.fetch_add(1, std::memory_order_relaxed);
+    if (wakePending_.exchange(false)) {
+        // Input or a state change: answer on this vsync instead of waiting for the divisor.
+        idleFrames_ = 0;
+        vsyncPhase_ = 0;
+        return true;
+    }
+
+    int divisor = divisors_[static_cast<int>(State())];
+    if (++vsyncPhase_ < divisor) {
+        vsyncsSkipped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    vsyncPhase_ = 0;
+    return true;
+}
+
+void FrameScheduler::OnFrameDone(bool sceneChanged) {
+    if (sceneChanged) {
+        framesRendered_.fetch_add(1, std::memory_order_relaxed);
+        idleFrames_ = 0;
+    } else {
+        idleFrames_++;
+    }
+}
+
+bool FrameScheduler::ShouldContinue() {
+    if (State() == FrameState::Play || idleFrames_ < kIdleFramesBeforePark) {
+        return true;
+    }
+
+    parked_.store(true);
+    parks_.fetch_add(1, std::memory_order_relaxed);
+    // A Wake() that raced with parking either saw parked_ and requests the vsync itself,
+    // or left wakePending_ behind for us to pick up here.
+    if (wakePending_.load() && parked_.exchange(false)) {
+        return true;
+    }
+    return false;
+}
+
+bool FrameScheduler::Wake() {
+    wakePending_.store(true);
+    return parked_.exchange(false);
+}
+
+void FrameScheduler::Reset() {
+    idleFrames_ = 0;
+    vsyncPhase_ = 0;
+    parked_.store(false);
+    wakePending_.store(false);
+}
+
+FrameSchedulerStats FrameScheduler::Stats() const {
+    FrameSchedulerStats stats;
+    stats.vsyncs = vsyncs_.load(std::memory_order_relaxed);
+    stats.framesRendered = framesRendered_.load(std::memory_order_relaxed);
+    stats.vsyncsSkipped = vsyncsSkipped_.load(std::memory_order_relaxed);
+    stats.parks = parks_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,56 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+
+enum class FrameState { Play = 0, Paused, GameOver, Count };
+
+struct FrameSchedulerStats {
+    uint64_t vsyncs = 0;
+    uint64_t framesRendered = 0;
+    uint64_t vsyncsSkipped = 0;
+    uint64_t parks = 0;
+};
+
+// Decides which vsyncs produce a frame. Every state renders on every Nth vsync only, and once a paused
+// or finished game has been static for a few frames the loop parks and stops requesting vsyncs altogether.
+// A game in play never parks: the simulation advances even while nothing visible changes, for instance
+// while the next obstacles are still above the screen. Wake() may be called from any thread and restarts
+// a parked loop right away.
+class FrameScheduler {
+public:
+    FrameScheduler();
+
+    void SetState(FrameState state);
+    FrameState State() const { return state_.load(std::memory_order_relaxed); }
+    void SetVsyncDivisor(FrameState state, int divisor);
+
+    // Called on the render thread for every vsync. Returns true when this vsync should render.
+    bool OnVsync();
+    // Called on the render thread after a frame; sceneChanged is false when nothing was drawn.
+    void OnFrameDone(bool sceneChanged);
+    // Returns true when the render thread should request another vsync, otherwise the loop parks.
+    bool ShouldContinue();
+    // Returns true when the loop was parked and the caller has to request a vsync to restart it.
+    bool Wake();
+    void Reset();
+
+    FrameSchedulerStats Stats() const;
+
+private:
+    static constexpr int kIdleFramesBeforePark = 2;
+
+    std::atomic<FrameState> state_ {FrameState::Play};
+    std::atomic<bool> parked_ {false};
+    std::atomic<bool> wakePending_ {false};
+    int divisors_[static_cast<int>(FrameState::Count)];
+    int vsyncPhase_ = 0;
+    int idleFrames_ = 0;
+    std::atomic<uint64_t> vsyncs_ {0};
+    std::atomic<uint64_t> framesRendered_ {0};
+    std::atomic<uint64_t> vsyncsSkipped_ {0};
+    std::atomic<uint64_t> parks_ {0};
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,14 @@
+#include "gl_dispatch.h"
+
+const GLDispatch &NativeGLDispatch() {
+    static const GLDispatch native = {
+#define GL_DISPATCH_NATIVE(name) &gl##name,
+        GL_DISPATCH_FUNCTIONS(GL_DISPATCH_NATIVE)
+#undef GL_DISPATCH_NATIVE
+    };
+    return native;
+}
+
+const GLDispatch *g_glDispatch = &NativeGLDispatch();
+
+void SetGLDispatch(const GLDispatch *dispatch) { g_glDispatch = dispatch ? dispatch : &NativeGLDispatch(); }
@@ -0,0 +1,40 @@
+#ifndef GL_DISPATCH_H
+#define GL_DISPATCH_H
+
+#include <GLES3/gl3.h>
+
+// Every GLES entry point the renderer uses. Render code calls them through GL() so the backend can be
+// swapped, e.g. for GLRecorder, which runs frames without a GPU and counts what they would cost.
+#define GL_DISPATCH_FUNCTIONS(X)                                                                        \
+    X(CreateShader) X(ShaderSource) X(CompileShader) X(GetShaderiv) X(GetShaderInfoLog) X(DeleteShader) \
+    X(CreateProgram) X(AttachShader) X(LinkProgram) X(GetProgramiv) X(GetProgramInfoLog)               \
+    X(DeleteProgram) X(UseProgram)                                                                      \
+    X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray)                                         \
+    X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData)                         \
+    X(VertexAttribPointer) X(VertexAttribDivisor) X(EnableVertexAttribArray)                            \
+    X(DrawArrays) X(DrawArraysInstanced) X(DrawElements)                                                \
+    X(GenFramebuffers) X(DeleteFramebuffers) X(BindFramebuffer) X(CheckFramebufferStatus)               \
+    X(BlitFramebuffer) X(GenRenderbuffers) X(DeleteRenderbuffers) X(BindRenderbuffer)                   \
+    X(RenderbufferStorage) X(FramebufferRenderbuffer)                                                   \
+    X(GenTextures) X(DeleteTextures) X(ActiveTexture) X(BindTexture) X(TexImage2D) X(TexSubImage2D)     \
+    X(TexParameteri)                                                                                    \
+    X(Enable) X(Disable) X(BlendFunc) X(Scissor) X(Viewport) X(ClearColor) X(Clear) X(Flush) X(Finish) \
+    X(FenceSync) X(ClientWaitSync) X(DeleteSync) X(GetError)                                            \
+    X(ReadPixels) X(MapBufferRange) X(UnmapBuffer)
+
+struct GLDispatch {
+#define GL_DISPATCH_MEMBER(name) decltype(&gl##name) name;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_MEMBER)
+#undef GL_DISPATCH_MEMBER
+};
+
+extern const GLDispatch *g_glDispatch;
+
+inline const GLDispatch &GL() { return *g_glDispatch; }
+
+// The table that forwards straight to the GLES driver.
+const GLDispatch &NativeGLDispatch();
+// Installs a backend for the calling process; nullptr restores the native one.
+void SetGLDispatch(const GLDispatch *dispatch);
+
+#endif // GL_DISPATCH_H
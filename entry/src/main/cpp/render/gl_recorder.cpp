@@ -0,0 +1,237 @@
+#include "gl_recorder.h"
+
+GLRecorder *GLRecorder::active_ = nullptr;
+
+namespace {
+void Rec(const char *name, GLOp op, uint64_t amount = 0) {
+    if (GLRecorder *recorder = GLRecorder::Active()) {
+        recorder->Record(name, op, amount);
+    }
+}
+
+void GenNames(const char *name, GLsizei n, GLuint *names) {
+    Rec(name, GLOp::Create);
+    GLRecorder *recorder = GLRecorder::Active();
+    for (GLsizei i = 0; i < n; i++) {
+        names[i] = recorder ? recorder->NextName() : 0;
+    }
+}
+
+uint64_t PixelBytes(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    uint64_t channels = 4;
+    switch (format) {
+        case GL_RED:
+        case GL_ALPHA:
+        case GL_LUMINANCE:
+            channels = 1;
+            break;
+        case GL_RG:
+        case GL_LUMINANCE_ALPHA:
+            channels = 2;
+            break;
+        case GL_RGB:
+            channels = 3;
+            break;
+        default:
+            break;
+    }
+    uint64_t channelBytes = (type == GL_FLOAT) ? 4 : ((type == GL_HALF_FLOAT) ? 2 : 1);
+    if (type == GL_UNSIGNED_SHORT_5_6_5 || type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1) {
+        return static_cast<uint64_t>(width) * height * 2;
+    }
+    return static_cast<uint64_t>(width) * height * channels * channelBytes;
+}
+
+GLuint GL_APIENTRY CreateShader(GLenum) {
+    GLuint name = GLRecorder::Active() ? GLRecorder::Active()->NextName() : 0;
+    Rec("glCreateShader", GLOp::Create);
+    return name;
+}
+void GL_APIENTRY ShaderSource(GLuint, GLsizei, const GLchar *const *, const GLint *) { Rec("glShaderSource", GLOp::Create); }
+void GL_APIENTRY CompileShader(GLuint) { Rec("glCompileShader", GLOp::Create); }
+void GL_APIENTRY GetShaderiv(GLuint, GLenum pname, GLint *params) {
+    Rec("glGetShaderiv", GLOp::Query);
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+void GL_APIENTRY GetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+    Rec("glGetShaderInfoLog", GLOp::Query);
+    if (length) {
+        *length = 0;
+    }
+    if (infoLog && bufSize > 0) {
+        infoLog[0] = '\0';
+    }
+}
+void GL_APIENTRY DeleteShader(GLuint) { Rec("glDeleteShader", GLOp::Delete); }
+GLuint GL_APIENTRY CreateProgram() {
+    GLuint name = GLRecorder::Active() ? GLRecorder::Active()->NextName() : 0;
+    Rec("glCreateProgram", GLOp::Create);
+    return name;
+}
+void GL_APIENTRY AttachShader(GLuint, GLuint) { Rec("glAttachShader", GLOp::Create); }
+void GL_APIENTRY LinkProgram(GLuint) { Rec("glLinkProgram", GLOp::Create); }
+void GL_APIENTRY GetProgramiv(GLuint, GLenum pname, GLint *params) {
+    Rec("glGetProgramiv", GLOp::Query);
+    *params = (pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+void GL_APIENTRY GetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+    GetShaderInfoLog(0, bufSize, length, infoLog);
+}
+void GL_APIENTRY DeleteProgram(GLuint) { Rec("glDeleteProgram", GLOp::Delete); }
+void GL_APIENTRY UseProgram(GLuint) { Rec("glUseProgram", GLOp::Bind); }
+
+void GL_APIENTRY GenVertexArrays(GLsizei n, GLuint *arrays) { GenNames("glGenVertexArrays", n, arrays); }
+void GL_APIENTRY DeleteVertexArrays(GLsizei, const GLuint *) { Rec("glDeleteVertexArrays", GLOp::Delete); }
+void GL_APIENTRY BindVertexArray(GLuint) { Rec("glBindVertexArray", GLOp::Bind); }
+void GL_APIENTRY GenBuffers(GLsizei n, GLuint *buffers) { GenNames("glGenBuffers", n, buffers); }
+void GL_APIENTRY DeleteBuffers(GLsizei, const GLuint *) { Rec("glDeleteBuffers", GLOp::Delete); }
+void GL_APIENTRY BindBuffer(GLenum, GLuint) { Rec("glBindBuffer", GLOp::Bind); }
+void GL_APIENTRY BufferData(GLenum, GLsizeiptr size, const void *data, GLenum) {
+    // A null pointer only (re)allocates storage, nothing crosses the bus.
+    Rec("glBufferData", GLOp::Upload, data ? static_cast<uint64_t>(size) : 0);
+}
+void GL_APIENTRY BufferSubData(GLenum, GLintptr, GLsizeiptr size, const void *) {
+    Rec("glBufferSubData", GLOp::Upload, static_cast<uint64_t>(size));
+}
+void GL_APIENTRY VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void *) {
+    Rec("glVertexAttribPointer", GLOp::State);
+}
+void GL_APIENTRY VertexAttribDivisor(GLuint, GLuint) { Rec("glVertexAttribDivisor", GLOp::State); }
+void GL_APIENTRY EnableVertexAttribArray(GLuint) { Rec("glEnableVertexAttribArray", GLOp::State); }
+void GL_APIENTRY DrawArrays(GLenum, GLint, GLsizei count) { Rec("glDrawArrays", GLOp::Draw, count); }
+void GL_APIENTRY DrawArraysInstanced(GLenum, GLint, GLsizei count, GLsizei instances) {
+    Rec("glDrawArraysInstanced", GLOp::Draw, static_cast<uint64_t>(count) * instances);
+}
+void GL_APIENTRY DrawElements(GLenum, GLsizei count, GLenum, const void *) { Rec("glDrawElements", GLOp::Draw, count); }
+
+void GL_APIENTRY GenFramebuffers(GLsizei n, GLuint *framebuffers) { GenNames("glGenFramebuffers", n, framebuffers); }
+void GL_APIENTRY DeleteFramebuffers(GLsizei, const GLuint *) { Rec("glDeleteFramebuffers", GLOp::Delete); }
+void GL_APIENTRY BindFramebuffer(GLenum, GLuint) { Rec("glBindFramebuffer", GLOp::Bind); }
+GLenum GL_APIENTRY CheckFramebufferStatus(GLenum) {
+    Rec("glCheckFramebufferStatus", GLOp::Query);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+void GL_APIENTRY BlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) {
+    Rec("glBlitFramebuffer", GLOp::Draw);
+}
+void GL_APIENTRY GenRenderbuffers(GLsizei n, GLuint *renderbuffers) {
+    GenNames("glGenRenderbuffers", n, renderbuffers);
+}
+void GL_APIENTRY DeleteRenderbuffers(GLsizei, const GLuint *) { Rec("glDeleteRenderbuffers", GLOp::Delete); }
+void GL_APIENTRY BindRenderbuffer(GLenum, GLuint) { Rec("glBindRenderbuffer", GLOp::Bind); }
+void GL_APIENTRY RenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) { Rec("glRenderbufferStorage", GLOp::Create); }
+void GL_APIENTRY FramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) {
+    Rec("glFramebufferRenderbuffer", GLOp::State);
+}
+
+void GL_APIENTRY GenTextures(GLsizei n, GLuint *textures) { GenNames("glGenTextures", n, textures); }
+void GL_APIENTRY DeleteTextures(GLsizei, const GLuint *) { Rec("glDeleteTextures", GLOp::Delete); }
+void GL_APIENTRY ActiveTexture(GLenum) { Rec("glActiveTexture", GLOp::Bind); }
+void GL_APIENTRY BindTexture(GLenum, GLuint) { Rec("glBindTexture", GLOp::Bind); }
+void GL_APIENTRY TexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type,
+                            const void *pixels) {
+    Rec("glTexImage2D", GLOp::Upload, pixels ? PixelBytes(width, height, format, type) : 0);
+}
+void GL_APIENTRY TexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                               const void *) {
+    Rec("glTexSubImage2D", GLOp::Upload, PixelBytes(width, height, format, type));
+}
+void GL_APIENTRY TexParameteri(GLenum, GLenum, GLint) { Rec("glTexParameteri", GLOp::State); }
+
+void GL_APIENTRY Enable(GLenum) { Rec("glEnable", GLOp::State); }
+void GL_APIENTRY Disable(GLenum) { Rec("glDisable", GLOp::State); }
+void GL_APIENTRY BlendFunc(GLenum, GLenum) { Rec("glBlendFunc", GLOp::State); }
+void GL_APIENTRY Scissor(GLint, GLint, GLsizei, GLsizei) { Rec("glScissor", GLOp::State); }
+void GL_APIENTRY Viewport(GLint, GLint, GLsizei, GLsizei) { Rec("glViewport", GLOp::State); }
+void GL_APIENTRY ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) { Rec("glClearColor", GLOp::State); }
+void GL_APIENTRY Clear(GLbitfield) { Rec("glClear", GLOp::Clear); }
+void GL_APIENTRY Flush() { Rec("glFlush", GLOp::Sync); }
+void GL_APIENTRY Finish() { Rec("glFinish", GLOp::Sync); }
+GLsync GL_APIENTRY FenceSync(GLenum, GLbitfield) {
+    Rec("glFenceSync", GLOp::Sync);
+    // Any non-null handle will do; it is never dereferenced.
+    GLuint name = GLRecorder::Active() ? GLRecorder::Active()->NextName() : 0;
+    return reinterpret_cast<GLsync>(static_cast<uintptr_t>(name));
+}
+GLenum GL_APIENTRY ClientWaitSync(GLsync, GLbitfield, GLuint64) {
+    Rec("glClientWaitSync", GLOp::Sync);
+    return GL_ALREADY_SIGNALED;
+}
+void GL_APIENTRY DeleteSync(GLsync) { Rec("glDeleteSync", GLOp::Delete); }
+void GL_APIENTRY ReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, void *) {
+    Rec("glReadPixels", GLOp::Readback, PixelBytes(width, height, format, type));
+}
+void *GL_APIENTRY MapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+    Rec("glMapBufferRange", GLOp::Sync);
+    GLRecorder *recorder = GLRecorder::Active();
+    return recorder ? recorder->MapScratch(static_cast<size_t>(length)) : nullptr;
+}
+GLboolean GL_APIENTRY UnmapBuffer(GLenum) {
+    Rec("glUnmapBuffer", GLOp::Sync);
+    return GL_TRUE;
+}
+GLenum GL_APIENTRY GetError() {
+    Rec("glGetError", GLOp::Query);
+    return GL_NO_ERROR;
+}
+
+const GLDispatch &RecordingGLDispatch() {
+    static const GLDispatch recording = {
+#define GL_DISPATCH_RECORDING(name) &name,
+        GL_DISPATCH_FUNCTIONS(GL_DISPATCH_RECORDING)
+#undef GL_DISPATCH_RECORDING
+    };
+    return recording;
+}
+} // namespace
+
+GLRecorder::~GLRecorder() { Uninstall(); }
+
+void GLRecorder::Install() {
+    active_ = this;
+    SetGLDispatch(&RecordingGLDispatch());
+}
+
+void GLRecorder::Uninstall() {
+    if (active_ == this) {
+        active_ = nullptr;
+        SetGLDispatch(nullptr);
+    }
+}
+
+void GLRecorder::Reset() {
+    stats_ = {};
+    calls_.clear();
+}
+
+void GLRecorder::Record(const char *name, GLOp op, uint64_t amount) {
+    calls_.push_back({name, op, amount});
+    stats_.calls++;
+    switch (op) {
+        case GLOp::Draw:
+            stats_.drawCalls++;
+            stats_.verticesDrawn += amount;
+            break;
+        case GLOp::Bind:
+            stats_.bindCalls++;
+            break;
+        case GLOp::State:
+            stats_.stateCalls++;
+            break;
+        case GLOp::Upload:
+            stats_.uploadCalls++;
+            stats_.uploadBytes += amount;
+            break;
+        case GLOp::Readback:
+            stats_.readbackCalls++;
+            stats_.readbackBytes += amount;
+            break;
+        default:
+            break;
+    }
+}
+
+bool GLRecorder::WithinBudget(const GLFrameBudget &budget) const {
+    return stats_.drawCalls <= budget.maxDrawCalls && stats_.uploadBytes <= budget.maxUploadBytes &&
+           stats_.bindCalls + stats_.stateCalls <= budget.maxStateChanges;
+}
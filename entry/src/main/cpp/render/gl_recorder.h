@@ -0,0 +1,70 @@
+#ifndef GL_RECORDER_H
+#define GL_RECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "gl_dispatch.h"
+
+enum class GLOp : uint8_t { Draw, Bind, State, Upload, Readback, Create, Delete, Clear, Query, Sync };
+
+struct GLRecordedCall {
+    const char *name;
+    GLOp op;
+    uint64_t amount; // bytes for uploads and readbacks, vertices for draws
+};
+
+struct GLRecorderStats {
+    uint32_t calls = 0;
+    uint32_t drawCalls = 0;
+    uint32_t bindCalls = 0;
+    uint32_t stateCalls = 0;
+    uint32_t uploadCalls = 0;
+    uint64_t uploadBytes = 0;
+    uint32_t readbackCalls = 0;
+    uint64_t readbackBytes = 0;
+    uint64_t verticesDrawn = 0;
+};
+
+struct GLFrameBudget {
+    uint32_t maxDrawCalls = UINT32_MAX;
+    uint64_t maxUploadBytes = UINT64_MAX;
+    uint32_t maxStateChanges = UINT32_MAX;
+};
+
+// GL backend that records instead of rendering, so frames can be measured on machines without a GPU.
+// Object creation hands out fresh names, status queries report success and nothing is drawn. Readbacks
+// return zeroed pixels.
+class GLRecorder {
+public:
+    ~GLRecorder();
+
+    // Routes GL() to this recorder until Uninstall() or destruction.
+    void Install();
+    void Uninstall();
+    // Clears the call log and counters; call at the start of every measured frame.
+    void Reset();
+
+    const GLRecorderStats &Stats() const { return stats_; }
+    const std::vector<GLRecordedCall> &Calls() const { return calls_; }
+    bool WithinBudget(const GLFrameBudget &budget) const;
+
+    static GLRecorder *Active() { return active_; }
+    void Record(const char *name, GLOp op, uint64_t amount = 0);
+    GLuint NextName() { return nextName_++; }
+    // Zeroed memory standing in for a mapped buffer; valid until the next call.
+    void *MapScratch(size_t bytes) {
+        mapped_.assign(bytes, 0);
+        return mapped_.data();
+    }
+
+private:
+    static GLRecorder *active_;
+
+    GLRecorderStats stats_;
+    std::vector<GLRecordedCall> calls_;
+    GLuint nextName_ = 1;
+    std::vector<uint8_t> mapped_;
+};
+
+#endif // GL_RECORDER_H
@@ -0,0 +1,167 @@
+#include "gl_state_cache.h"
+
+int GLStateCache::BufferSlot(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER:
+            return 0;
+        case GL_ELEMENT_ARRAY_BUFFER:
+            return 1;
+        case GL_PIXEL_PACK_BUFFER:
+            return 2;
+        case GL_PIXEL_UNPACK_BUFFER:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+void GLStateCache::Invalidate() { known_ = 0; }
+
+void GLStateCache::UseProgram(GLuint program) {
+    if (Changed(PROGRAM, program != program_)) {
+        program_ = program;
+        GL().UseProgram(program);
+    }
+}
+
+void GLStateCache::BindVertexArray(GLuint vao) {
+    if (Changed(VERTEX_ARRAY, vao != vertexArray_)) {
+        vertexArray_ = vao;
+        GL().BindVertexArray(vao);
+        // The element array binding is part of the vertex array object.
+        known_ &= ~(BUFFER_FIRST << BufferSlot(GL_ELEMENT_ARRAY_BUFFER));
+    }
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer) {
+    int slot = BufferSlot(target);
+    if (slot < 0) {
+        frame_.issued++;
+        GL().BindBuffer(target, buffer);
+        return;
+    }
+    if (Changed(BUFFER_FIRST << slot, buffer != buffers_[slot])) {
+        buffers_[slot] = buffer;
+        GL().BindBuffer(target, buffer);
+    }
+}
+
+void GLStateCache::BindFramebuffer(GLenum target, GLuint framebuffer) {
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool differs = (read && ((known_ & READ_FRAMEBUFFER) == 0 || readFramebuffer_ != framebuffer)) ||
+                   (draw && ((known_ & DRAW_FRAMEBUFFER) == 0 || drawFramebuffer_ != framebuffer));
+    uint32_t bits = (read ? static_cast<uint32_t>(READ_FRAMEBUFFER) : 0u) |
+                    (draw ? static_cast<uint32_t>(DRAW_FRAMEBUFFER) : 0u);
+    if (Changed(bits, differs)) {
+        if (read) {
+            readFramebuffer_ = framebuffer;
+        }
+        if (draw) {
+            drawFramebuffer_ = framebuffer;
+        }
+        GL().BindFramebuffer(target, framebuffer);
+    }
+}
+
+void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture) {
+    if (unit >= kMaxTextureUnits) {
+        frame_.issued += 2;
+        GL().ActiveTexture(GL_TEXTURE0 + unit);
+        GL().BindTexture(target, texture);
+        known_ &= ~ACTIVE_UNIT;
+        return;
+    }
+    uint32_t textureBit = TEXTURE_FIRST << unit;
+    bool differs = (known_ & textureBit) == 0 || textures_[unit] != texture || textureTargets_[unit] != target;
+    if (!differs) {
+        frame_.elided++;
+        return;
+    }
+    if (Changed(ACTIVE_UNIT, unit != activeUnit_)) {
+        activeUnit_ = unit;
+        GL().ActiveTexture(GL_TEXTURE0 + unit);
+    }
+    Changed(textureBit, true);
+    textures_[unit] = texture;
+    textureTargets_[unit] = target;
+    GL().BindTexture(target, texture);
+}
+
+void GLStateCache::SetBlend(bool enabled) {
+    if (Changed(BLEND, enabled != blend_)) {
+        blend_ = enabled;
+        if (enabled) {
+            GL().Enable(GL_BLEND);
+        } else {
+            GL().Disable(GL_BLEND);
+        }
+    }
+}
+
+void GLStateCache::BlendFunc(GLenum src, GLenum dst) {
+    if (Changed(BLEND_FUNC, src != blendSrc_ || dst != blendDst_)) {
+        blendSrc_ = src;
+        blendDst_ = dst;
+        GL().BlendFunc(src, dst);
+    }
+}
+
+void GLStateCache::SetScissorTest(bool enabled) {
+    if (Changed(SCISSOR_TEST, enabled != scissorTest_)) {
+        scissorTest_ = enabled;
+        if (enabled) {
+            GL().Enable(GL_SCISSOR_TEST);
+        } else {
+            GL().Disable(GL_SCISSOR_TEST);
+        }
+    }
+}
+
+void GLStateCache::Scissor(GLint x, GLint y, GLsizei w, GLsizei h) {
+    if (Changed(SCISSOR, x != scissor_.x || y != scissor_.y || w != scissor_.w || h != scissor_.h)) {
+        scissor_ = {x, y, w, h};
+        GL().Scissor(x, y, w, h);
+    }
+}
+
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    if (Changed(VIEWPORT, x != viewport_.x || y != viewport_.y || w != viewport_.w || h != viewport_.h)) {
+        viewport_ = {x, y, w, h};
+        GL().Viewport(x, y, w, h);
+    }
+}
+
+void GLStateCache::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (Changed(CLEAR_COLOR,
+                r != clearColor_[0] || g != clearColor_[1] || b != clearColor_[2] || a != clearColor_[3])) {
+        clearColor_[0] = r;
+        clearColor_[1] = g;
+        clearColor_[2] = b;
+        clearColor_[3] = a;
+        GL().ClearColor(r, g, b, a);
+    }
+}
+
+void GLStateCache::OnBufferDeleted(GLuint buffer) {
+    for (int slot = 0; slot < 4; slot++) {
+        if (buffers_[slot] == buffer) {
+            buffers_[slot] = 0;
+        }
+    }
+}
+
+void GLStateCache::OnVertexArrayDeleted(GLuint vao) {
+    if (vertexArray_ == vao) {
+        vertexArray_ = 0;
+    }
+}
+
+void GLStateCache::OnFramebufferDeleted(GLuint framebuffer) {
+    if (readFramebuffer_ == framebuffer) {
+        readFramebuffer_ = 0;
+    }
+    if (drawFramebuffer_ == framebuffer) {
+        drawFramebuffer_ = 0;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <cstdint>
+#include "gl_dispatch.h"
+
+struct GLStateStats {
+    uint32_t issued = 0;
+    uint32_t elided = 0;
+};
+
+// Shadows the GL state the renderer touches and drops calls that would not change anything.
+// All binds of the render thread go through one instance; Invalidate() after the context changed
+// or after code outside the cache touched the state.
+class GLStateCache {
+public:
+    static constexpr int kMaxTextureUnits = 8;
+    static constexpr int kMaxVertexAttribs = 8;
+
+    void Invalidate();
+
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vao);
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindFramebuffer(GLenum target, GLuint framebuffer);
+    void BindTexture(GLuint unit, GLenum target, GLuint texture);
+    void SetBlend(bool enabled);
+    void BlendFunc(GLenum src, GLenum dst);
+    void SetScissorTest(bool enabled);
+    void Scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+    void Viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+    void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+    // Forget a deleted object so a later object reusing the name is bound again.
+    void OnBufferDeleted(GLuint buffer);
+    void OnVertexArrayDeleted(GLuint vao);
+    void OnFramebufferDeleted(GLuint framebuffer);
+
+    void BeginFrame() { frame_ = {}; }
+    const GLStateStats &FrameStats() const { return frame_; }
+
+private:
+    struct Rect {
+        GLint x, y;
+        GLsizei w, h;
+    };
+
+    enum StateBit : uint32_t {
+        PROGRAM = 1u << 0,
+        VERTEX_ARRAY = 1u << 1,
+        BUFFER_FIRST = 1u << 2, // one bit per buffer slot, 4 slots
+        READ_FRAMEBUFFER = 1u << 6,
+        DRAW_FRAMEBUFFER = 1u << 7,
+        ACTIVE_UNIT = 1u << 8,
+        TEXTURE_FIRST = 1u << 9, // one bit per texture unit, kMaxTextureUnits units
+        BLEND = 1u << 17,
+        BLEND_FUNC = 1u << 18,
+        SCISSOR_TEST = 1u << 19,
+        SCISSOR = 1u << 20,
+        VIEWPORT = 1u << 21,
+        CLEAR_COLOR = 1u << 22,
+    };
+
+    // Counts the call and reports whether it has to reach the driver.
+    bool Changed(uint32_t bit, bool differs) {
+        bool issue = (known_ & bit) == 0 || differs;
+        known_ |= bit;
+        if (issue) {
+            frame_.issued++;
+        } else {
+            frame_.elided++;
+        }
+        return issue;
+    }
+    static int BufferSlot(GLenum target);
+
+    uint32_t known_ = 0;
+    GLuint program_ = 0;
+    GLuint vertexArray_ = 0;
+    GLuint buffers_[4] = {0};
+    GLuint readFramebuffer_ = 0;
+    GLuint drawFramebuffer_ = 0;
+    GLuint activeUnit_ = 0;
+    GLenum textureTargets_[kMaxTextureUnits] = {0};
+    GLuint textures_[kMaxTextureUnits] = {0};
+    bool blend_ = false;
+    GLenum blendSrc_ = GL_ONE;
+    GLenum blendDst_ = GL_ZERO;
+    bool scissorTest_ = false;
+    Rect scissor_ = {0, 0, 0, 0};
+    Rect viewport_ = {0, 0, 0, 0};
+    GLfloat clearColor_[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    GLStateStats frame_;
+};
+
+#endif // GL_STATE_CACHE_H
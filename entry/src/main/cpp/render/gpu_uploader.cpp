@@ -0,0 +1,416 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "gl_dispatch.h"
+#include "gpu_uploader.h"
+#include "plugin_common.h"
+#include "tracing.h"
+
+namespace {
+bool HasExtension(const char *extensions, const char *name) {
+    if (!extensions) {
+        return false;
+    }
+    size_t len = strlen(name);
+    for (const char *p = strstr(extensions, name); p; p = strstr(p + len, name)) {
+        if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ResourceKind RegistryKind(int kind) {
+    static const ResourceKind kinds[] = {ResourceKind::Texture, ResourceKind::Buffer, ResourceKind::Program};
+    return kinds[kind];
+}
+
+float MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+GLuint BuildShader(GLenum type, const char *source) {
+    GLuint shader = GL().CreateShader(type);
+    if (shader == 0) {
+        return 0;
+    }
+
+    GL().ShaderSource(shader, 1, &source, nullptr);
+    GL().CompileShader(shader);
+
+    GLint compiled;
+    GL().GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        GLint infoLen = 0;
+        GL().GetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
+        if (infoLen > 1) {
+            char *infoLog = (char *)malloc(sizeof(char) * infoLen);
+            GL().GetShaderInfoLog(shader, infoLen, nullptr, infoLog);
+            LOGE("Shader compile error: %{public}s", infoLog);
+            free(infoLog);
+        }
+        GL().DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint BuildProgram(const char *vertexSource, const char *fragmentSource) {
+    GLuint vertex = BuildShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragment = BuildShader(GL_FRAGMENT_SHADER, fragmentSource);
+    GLuint program = GL().CreateProgram();
+
+    if (vertex == 0 || fragment == 0 || program == 0) {
+        return 0;
+    }
+
+    GL().AttachShader(program, vertex);
+    GL().AttachShader(program, fragment);
+    GL().LinkProgram(program);
+
+    GLint linked;
+    GL().GetProgramiv(program, GL_LINK_STATUS, &linked);
+    GL().DeleteShader(vertex);
+    GL().DeleteShader(fragment);
+    if (!linked) {
+        GLint infoLen = 0;
+        GL().GetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
+        if (infoLen > 1) {
+            char *infoLog = (char *)malloc(sizeof(char) * infoLen);
+            GL().GetProgramInfoLog(program, infoLen, nullptr, infoLog);
+            LOGE("Program link error: %{public}s", infoLog);
+            free(infoLog);
+        }
+        GL().DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+GpuUploader::~GpuUploader() { Stop(); }
+
+EGLContext GpuUploader::Start(EGLDisplay display, EGLConfig config, const EGLint *contextAttribs) {
+    Stop();
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        LOGE("GpuUploader: loader context failed (0x%{public}x), uploading on the render thread", eglGetError());
+        return EGL_NO_CONTEXT;
+    }
+
+    // The loader never draws; without surfaceless support it needs a dummy surface to be made current.
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            LOGE("GpuUploader: no surfaceless or pbuffer support, uploading on the render thread");
+            eglDestroyContext(display, context);
+            return EGL_NO_CONTEXT;
+        }
+    }
+
+    display_ = display;
+    context_ = context;
+    surface_ = surface;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        loaderFailed_ = false;
+    }
+    thread_ = std::thread(&GpuUploader::LoaderMain, this);
+    LOGI("GpuUploader: loader thread started (%{public}s)", surface == EGL_NO_SURFACE ? "surfaceless" : "pbuffer");
+    return context;
+}
+
+void GpuUploader::Stop() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        thread_.join();
+    }
+    if (context_ != EGL_NO_CONTEXT) {
+        eglDestroyContext(display_, context_);
+    }
+    if (surface_ != EGL_NO_SURFACE) {
+        eglDestroySurface(display_, surface_);
+    }
+    display_ = EGL_NO_DISPLAY;
+    context_ = EGL_NO_CONTEXT;
+    surface_ = EGL_NO_SURFACE;
+
+    // Fences still in flight and finished objects belong to a share group that is going away with the
+    // surface; this is only called when it does.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Completion &completion : inFlight_) {
+        entries_[completion.id - 1].state = GpuResourceState::Failed;
+    }
+    inFlight_.clear();
+    for (Entry &entry : entries_) {
+        ResourceRegistry::GetInstance()->Untrack(entry.tracked);
+        entry.tracked = 0;
+        entry.name = 0;
+        if (entry.state == GpuResourceState::Ready) {
+            entry.state = GpuResourceState::Failed;
+        }
+    }
+    stopping_ = false;
+}
+
+bool GpuUploader::Threaded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return context_ != EGL_NO_CONTEXT && !loaderFailed_;
+}
+
+GpuResourceId GpuUploader::UploadTexture(int width, int height, std::vector<uint8_t> rgba, const char *owner) {
+    Job job {};
+    job.kind = Kind::Texture;
+    job.owner = owner;
+    job.width = width;
+    job.height = height;
+    job.bytes = std::move(rgba);
+    return Submit(std::move(job));
+}
+
+GpuResourceId GpuUploader::UploadBuffer(GLenum target, std::vector<uint8_t> bytes, GLenum usage, const char *owner) {
+    Job job {};
+    job.kind = Kind::Buffer;
+    job.owner = owner;
+    job.target = target;
+    job.usage = usage;
+    job.bytes = std::move(bytes);
+    return Submit(std::move(job));
+}
+
+GpuResourceId GpuUploader::CompileProgram(std::string vertexSource, std::string fragmentSource, const char *owner) {
+    Job job {};
+    job.kind = Kind::Program;
+    job.owner = owner;
+    job.vertexSource = std::move(vertexSource);
+    job.fragmentSource = std::move(fragmentSource);
+    return Submit(std::move(job));
+}
+
+GpuResourceId GpuUploader::Submit(Job job) {
+    GpuResourceId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry entry;
+        entry.kind = job.kind;
+        entry.owner = job.owner;
+        entries_.push_back(entry);
+        id = static_cast<GpuResourceId>(entries_.size());
+        job.id = id;
+        job.submitted = std::chrono::steady_clock::now();
+        jobs_.push_back(std::move(job));
+        stats_.submitted++;
+    }
+    wake_.notify_one();
+    return id;
+}
+
+GLuint GpuUploader::Execute(const Job &job, uint64_t &bytes) {
+    TRACE_SCOPE("upload");
+    GLuint name = 0;
+    bytes = job.bytes.size();
+    if (job.kind != Kind::Program &&
+        !ResourceRegistry::GetInstance()->Fits(RegistryKind(static_cast<int>(job.kind)), bytes)) {
+        LOGE("GpuUploader: %{public}s upload of %{public}llu bytes for %{public}s is over budget",
+             ResourceKindName(RegistryKind(static_cast<int>(job.kind))), (unsigned long long)bytes, job.owner);
+        return 0;
+    }
+    switch (job.kind) {
+        case Kind::Texture:
+            if (job.width <= 0 || job.height <= 0 ||
+                job.bytes.size() != static_cast<size_t>(job.width) * static_cast<size_t>(job.height) * 4) {
+                LOGE("GpuUploader: texture %{public}u has %{public}zu bytes for %{public}dx%{public}d RGBA", job.id,
+                     job.bytes.size(), job.width, job.height);
+                return 0;
+            }
+            GL().GenTextures(1, &name);
+            GL().BindTexture(GL_TEXTURE_2D, name);
+            GL().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            GL().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            GL().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            GL().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            GL().TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, job.width, job.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                            job.bytes.data());
+            GL().BindTexture(GL_TEXTURE_2D, 0);
+            break;
+        case Kind::Buffer:
+            GL().GenBuffers(1, &name);
+            GL().BindBuffer(job.target, name);
+            GL().BufferData(job.target, static_cast<GLsizeiptr>(job.bytes.size()), job.bytes.data(), job.usage);
+            GL().BindBuffer(job.target, 0);
+            break;
+        case Kind::Program:
+            name = BuildProgram(job.vertexSource.c_str(), job.fragmentSource.c_str());
+            if (name) {
+                // The driver's copy is not queryable; the size of its binary is the closest estimate.
+                GLint binaryLength = 0;
+                GL().GetProgramiv(name, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+                bytes = static_cast<uint64_t>(std::max(binaryLength, 0));
+            }
+            break;
+    }
+    return name;
+}
+
+void GpuUploader::LoaderMain() {
+    Tracer::SetThreadName("gpu loader");
+    if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+        LOGE("GpuUploader: loader eglMakeCurrent failed (0x%{public}x), uploading on the render thread",
+             eglGetError());
+        std::lock_guard<std::mutex> lock(mutex_);
+        loaderFailed_ = true;
+        return;
+    }
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                break;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        uint64_t bytes = 0;
+        GLuint name = Execute(job, bytes);
+        GLsync fence = nullptr;
+        if (name) {
+            fence = GL().FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            if (!fence) {
+                // No fence to poll, so make the upload complete before anyone can see the name.
+                GL().Finish();
+            }
+        }
+        // Submit the fence, otherwise the render thread could poll it forever.
+        GL().Flush();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_.push_back({job.id, name, fence, bytes, job.submitted});
+    }
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+bool GpuUploader::Poll() {
+    std::deque<Job> inlineJobs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (context_ == EGL_NO_CONTEXT || loaderFailed_) {
+            inlineJobs.swap(jobs_);
+        }
+    }
+    for (const Job &job : inlineJobs) {
+        uint64_t bytes = 0;
+        GLuint name = Execute(job, bytes);
+        std::lock_guard<std::mutex> lock(mutex_);
+        Publish({job.id, name, nullptr, bytes, job.submitted}, name != 0);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t kept = 0;
+    for (const Completion &completion : inFlight_) {
+        if (completion.name == 0 || !completion.fence) {
+            Publish(completion, completion.name != 0);
+            continue;
+        }
+        // A zero timeout only queries the fence. Objects completed in another context must be bound again
+        // here before their new contents are guaranteed visible, which first use does anyway.
+        GLenum status = GL().ClientWaitSync(completion.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            inFlight_[kept++] = completion;
+            continue;
+        }
+        GL().DeleteSync(completion.fence);
+        Publish(completion, status != GL_WAIT_FAILED);
+    }
+    inFlight_.resize(kept);
+    return !inlineJobs.empty();
+}
+
+void GpuUploader::Publish(const Completion &completion, bool ok) {
+    Entry &entry = entries_[completion.id - 1];
+    float latencyMs = MillisecondsSince(completion.submitted);
+    stats_.maxLatencyMs = std::max(stats_.maxLatencyMs, latencyMs);
+    stats_.totalLatencyMs += latencyMs;
+    if (!ok) {
+        entry.state = GpuResourceState::Failed;
+        stats_.failed++;
+        DeleteObject(entry, completion.name);
+        return;
+    }
+    stats_.completed++;
+    stats_.bytesUploaded += completion.bytes;
+    if (entry.released) {
+        DeleteObject(entry, completion.name);
+        return;
+    }
+    entry.state = GpuResourceState::Ready;
+    entry.name = completion.name;
+    ResourceKind kind = RegistryKind(static_cast<int>(entry.kind));
+    entry.tracked = ResourceRegistry::GetInstance()->Track(kind, entry.owner, completion.bytes);
+}
+
+GpuResourceState GpuUploader::State(GpuResourceId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == 0 || id > entries_.size()) {
+        return GpuResourceState::Failed;
+    }
+    return entries_[id - 1].state;
+}
+
+GLuint GpuUploader::Name(GpuResourceId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == 0 || id > entries_.size() || entries_[id - 1].state != GpuResourceState::Ready) {
+        return 0;
+    }
+    return entries_[id - 1].name;
+}
+
+void GpuUploader::Release(GpuResourceId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == 0 || id > entries_.size() || entries_[id - 1].released) {
+        return;
+    }
+    Entry &entry = entries_[id - 1];
+    entry.released = true;
+    if (entry.state == GpuResourceState::Ready) {
+        DeleteObject(entry, entry.name);
+        entry.name = 0;
+    }
+}
+
+void GpuUploader::DeleteObject(Entry &entry, GLuint name) {
+    ResourceRegistry::GetInstance()->Untrack(entry.tracked);
+    entry.tracked = 0;
+    if (name == 0) {
+        return;
+    }
+    switch (entry.kind) {
+        case Kind::Texture:
+            GL().DeleteTextures(1, &name);
+            break;
+        case Kind::Buffer:
+            GL().DeleteBuffers(1, &name);
+            break;
+        case Kind::Program:
+            GL().DeleteProgram(name);
+            break;
+    }
+}
+
+GpuUploaderStats GpuUploader::TakeStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GpuUploaderStats stats = stats_;
+    stats_ = GpuUploaderStats();
+    return stats;
+}
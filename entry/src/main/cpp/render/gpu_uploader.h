@@ -0,0 +1,128 @@
+#ifndef GPU_UPLOADER_H
+#define GPU_UPLOADER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+#include "resource_registry.h"
+
+// 0 is never a valid id.
+using GpuResourceId = uint32_t;
+
+enum class GpuResourceState : uint8_t { Pending = 0, Ready, Failed };
+
+struct GpuUploaderStats {
+    uint32_t submitted = 0;
+    uint32_t completed = 0;
+    uint32_t failed = 0;
+    uint64_t bytesUploaded = 0;
+    // Submission to first Poll() that saw the fence signaled.
+    float maxLatencyMs = 0.0f;
+    float totalLatencyMs = 0.0f;
+};
+
+// Compiles and links a program on the current context. Returns 0 and logs on failure.
+GLuint BuildShader(GLenum type, const char *source);
+GLuint BuildProgram(const char *vertexSource, const char *fragmentSource);
+
+// Creates textures, buffers and programs off the render thread. The loader thread owns a context in the
+// render context's share group; after each upload it inserts a fence, and the render thread only hands
+// out the GL name once Poll() sees that fence signaled, so nothing ever waits on the GPU mid-frame.
+// When no loader context can be made (no surfaceless or pbuffer support, or no EGL at all as in headless
+// runs) the queued work is done by Poll() on the render thread instead and is ready immediately.
+class GpuUploader {
+public:
+    ~GpuUploader();
+
+    // Render thread, before the render context is created. Returns the loader context that the render
+    // context must share with, or EGL_NO_CONTEXT when uploads stay on the render thread.
+    EGLContext Start(EGLDisplay display, EGLConfig config, const EGLint *contextAttribs);
+    // Joins the loader thread and destroys its context. Objects it created live on in the share group.
+    void Stop();
+    // False when uploads run inline in Poll().
+    bool Threaded() const;
+
+    // Any thread. Data is copied into the job; owner is a static tag for the resource registry. Textures
+    // and buffers that would exceed their memory budget fail instead of being created.
+    GpuResourceId UploadTexture(int width, int height, std::vector<uint8_t> rgba, const char *owner);
+    GpuResourceId UploadBuffer(GLenum target, std::vector<uint8_t> bytes, GLenum usage, const char *owner);
+    GpuResourceId CompileProgram(std::string vertexSource, std::string fragmentSource, const char *owner);
+
+    // Render thread, once per frame. Publishes uploads whose fences have signaled; never blocks. Returns
+    // true if it ran uploads inline, which leaves other bindings on the calling context.
+    bool Poll();
+    GpuResourceState State(GpuResourceId id) const;
+    // The GL name once the resource is Ready, otherwise 0.
+    GLuint Name(GpuResourceId id) const;
+    // Render thread. Deletes the object, or drops it as soon as a pending upload completes.
+    void Release(GpuResourceId id);
+    // Returns the counters accumulated since the previous call.
+    GpuUploaderStats TakeStats();
+
+private:
+    enum class Kind : uint8_t { Texture, Buffer, Program };
+
+    struct Job {
+        GpuResourceId id;
+        Kind kind;
+        const char *owner;
+        GLenum target;
+        GLenum usage;
+        int width;
+        int height;
+        std::vector<uint8_t> bytes;
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    struct Completion {
+        GpuResourceId id;
+        GLuint name;
+        GLsync fence;
+        // Estimated resident size.
+        uint64_t bytes;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    struct Entry {
+        Kind kind;
+        const char *owner;
+        GpuResourceState state = GpuResourceState::Pending;
+        GLuint name = 0;
+        ResourceHandle tracked = 0;
+        bool released = false;
+    };
+
+    GpuResourceId Submit(Job job);
+    // Runs on whichever thread has a context current; returns 0 on failure.
+    GLuint Execute(const Job &job, uint64_t &bytes);
+    // mutex_ held.
+    void Publish(const Completion &completion, bool ok);
+    // mutex_ held. Deletes the entry's object and drops it from the registry.
+    void DeleteObject(Entry &entry, GLuint name);
+    void LoaderMain();
+
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLSurface surface_ = EGL_NO_SURFACE;
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool loaderFailed_ = false;
+    std::deque<Job> jobs_;
+    std::vector<Completion> inFlight_;
+    std::vector<Entry> entries_;
+    GpuUploaderStats stats_;
+};
+
+#endif // GPU_UPLOADER_H
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include "input_latch.h"
+#include "tracing.h"
+
+namespace {
+const float LATENCY_SMOOTHING = 0.1f;
+
+float Seconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<float>(duration).count();
+}
+} // namespace
+
+void InputLatch::OnMove(int direction) {
+    Clock::time_point now = Clock::now();
+    uint64_t flow = 0;
+    if (Tracer::Enabled()) {
+        flow = Tracer::NewFlowId();
+        Tracer::GetInstance()->FlowStart("input", flow);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (flow != 0 && unshownFlows_.size() < kHistorySize) {
+        unshownFlows_.push_back(flow);
+    }
+    history_[head_] = {now, direction > 0 ? 1 : -1};
+    head_ = (head_ + 1) % kHistorySize;
+    count_ = std::min(count_ + 1, kHistorySize);
+    if (!hasUnshown_) {
+        hasUnshown_ = true;
+        oldestUnshown_ = now;
+    }
+}
+
+void InputLatch::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    count_ = 0;
+    hasUnshown_ = false;
+    unshownFlows_.clear();
+}
+
+float InputLatch::Extrapolate(float horizonSeconds) {
+    Clock::time_point now = Clock::now();
+    int moves = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0) {
+            return 0.0f;
+        }
+        const Move &newest = history_[(head_ + kHistorySize - 1) % kHistorySize];
+        if (Seconds(now - newest.time) > kGestureIdleSeconds) {
+            return 0.0f;
+        }
+        for (size_t i = 1; i <= count_; i++) {
+            const Move &move = history_[(head_ + kHistorySize - i) % kHistorySize];
+            if (Seconds(now - move.time) > kVelocityWindowSeconds) {
+                break;
+            }
+            moves += move.direction;
+        }
+    }
+    float velocity = moves / kVelocityWindowSeconds;
+    return velocity * std::clamp(horizonSeconds, 0.0f, kMaxHorizonSeconds);
+}
+
+void InputLatch::Latch() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!hasUnshown_) {
+        return;
+    }
+    // A frame that was never presented passes its oldest input on to the next one.
+    if (!latched_ || oldestUnshown_ < latchedInput_) {
+        latchedInput_ = oldestUnshown_;
+    }
+    latched_ = true;
+    hasUnshown_ = false;
+    latchedFlows_.insert(latchedFlows_.end(), unshownFlows_.begin(), unshownFlows_.end());
+    unshownFlows_.clear();
+}
+
+void InputLatch::OnPresented() {
+    if (!latched_) {
+        return;
+    }
+    latched_ = false;
+    for (uint64_t flow : latchedFlows_) {
+        Tracer::GetInstance()->FlowEnd("input", flow);
+    }
+    latchedFlows_.clear();
+    float ms = Seconds(Clock::now() - latchedInput_) * 1000.0f;
+    smoothedMs_ = smoothedMs_ == 0.0f ? ms : smoothedMs_ + (ms - smoothedMs_) * LATENCY_SMOOTHING;
+    stats_.samples++;
+    stats_.totalMs += ms;
+    stats_.maxMs = std::max(stats_.maxMs, ms);
+}
+
+InputLatencyStats InputLatch::TakeStats() {
+    InputLatencyStats stats = stats_;
+    stats_ = InputLatencyStats();
+    return stats;
+}
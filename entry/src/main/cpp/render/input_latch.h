@@ -0,0 +1,67 @@
+#ifndef INPUT_LATCH_H
+#define INPUT_LATCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct InputLatencyStats {
+    uint32_t samples = 0;
+    float totalMs = 0.0f;
+    float maxMs = 0.0f;
+};
+
+// Timing side of late-latched input. Moves are still applied by the simulation at its next tick; this
+// class records when they arrived, estimates the gesture velocity so the frame builder can extrapolate
+// the player a little past the newest input, and measures how long the oldest input shown by a frame
+// took to reach the display. While tracing, each move starts an "input" flow that ends in the present of
+// the frame showing it.
+class InputLatch {
+public:
+    static constexpr float kVelocityWindowSeconds = 0.1f;
+    // A gesture that sent nothing for this long has stopped; nothing is extrapolated any more.
+    static constexpr float kGestureIdleSeconds = 0.06f;
+    static constexpr float kMaxHorizonSeconds = 0.05f;
+
+    // Any thread, once per queued move.
+    void OnMove(int direction);
+    void Reset();
+
+    // Render thread. Moves expected to arrive within horizonSeconds, capped at kMaxHorizonSeconds.
+    float Extrapolate(float horizonSeconds);
+    // The frame being built shows every move received so far.
+    void Latch();
+    // That frame has been handed to the display. Ends the input flows on the slice open at the call.
+    void OnPresented();
+    float SmoothedLatencyMs() const { return smoothedMs_; }
+    // Returns the samples accumulated since the previous call.
+    InputLatencyStats TakeStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t kHistorySize = 32;
+
+    struct Move {
+        Clock::time_point time;
+        int direction;
+    };
+
+    std::mutex mutex_;
+    Move history_[kHistorySize];
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool hasUnshown_ = false;
+    Clock::time_point oldestUnshown_;
+    std::vector<uint64_t> unshownFlows_;
+
+    // Render thread only.
+    bool latched_ = false;
+    Clock::time_point latchedInput_;
+    std::vector<uint64_t> latchedFlows_;
+    float smoothedMs_ = 0.0f;
+    InputLatencyStats stats_;
+};
+
+#endif // INPUT_LATCH_H
@@ -1,45 +1,179 @@
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <hilog/log.h>
+#include <rawfile/raw_file.h>
+#include <rawfile/raw_file_manager.h>
 #include "common/plugin_common.h"
 #include "manager/plugin_manager.h"
 #include "native_common.h"
 #include "render/plugin_render.h"
+#include "tracing.h"
 
 std::unordered_map<std::string, PluginRender *> PluginRender::instance_;
 OH_NativeXComponent_Callback PluginRender::callback_;
 
-static napi_threadsafe_function g_gameOverTsfn = nullptr;
+// One threadsafe function carries every engine event batch to the JS thread. It is created on first use
+// and lives as long as the module; listeners are swapped through the refs below.
+static std::atomic<napi_threadsafe_function> g_eventsTsfn {nullptr};
+static napi_ref g_eventListenerRef = nullptr;
+static napi_ref g_gameOverRef = nullptr;
+// Settings made through NAPI. Each surface gets a new EGLCore, which starts from these. JS thread only.
+struct EngineSettings {
+    std::string snapshotPath;
+    bool softwareRendering = false;
+    bool adaptiveResolution = false;
+    ResolutionScalerConfig resolution;
+    bool lateLatch = true;
+    // Compiled tables are cached on disk, so loading again on a new surface maps the cache.
+    std::string spawnText;
+    std::string spawnCachePath;
+    std::shared_ptr<const CollisionAtlas> collisionMasks;
+    bool capturing = false;
+    FrameCaptureConfig capture;
+};
+static EngineSettings g_settings;
+
+static void ApplySettings(EGLCore *core) {
+    if (!g_settings.snapshotPath.empty()) {
+        core->SetSnapshotPath(g_settings.snapshotPath);
+    }
+    if (g_settings.softwareRendering) {
+        core->SetSoftwareRendering(true);
+    }
+    if (g_settings.adaptiveResolution) {
+        core->SetAdaptiveResolution(true, g_settings.resolution);
+    }
+    if (!g_settings.lateLatch) {
+        core->SetLateLatch(false);
+    }
+    if (!g_settings.spawnText.empty()) {
+        core->LoadSpawnSchedule(g_settings.spawnText, g_settings.spawnCachePath);
+    }
+    if (g_settings.collisionMasks) {
+        core->SetCollisionMasks(g_settings.collisionMasks);
+    }
+    if (g_settings.capturing) {
+        core->StartFrameCapture(g_settings.capture);
+    }
+}
 
-struct GameOverPayload {
-    int score;
+struct EventDelivery {
+    std::shared_ptr<EventBus> bus;
+    EventBatch *batch;
+    // Links the flush on the render thread to this delivery in a trace.
+    uint64_t flow;
 };
 
-static void CallGameOverJS(napi_env env, napi_value js_callback, void *context, void *data) {
-    std::unique_ptr<GameOverPayload> payload(static_cast<GameOverPayload *>(data));
+static napi_value CreateEventObject(napi_env env, const GameEvent &event) {
+    napi_value object;
+    napi_value field;
+    napi_create_object(env, &object);
+    napi_create_int32(env, static_cast<int32_t>(event.type), &field);
+    napi_set_named_property(env, object, "type", field);
+    napi_create_int32(env, event.value, &field);
+    napi_set_named_property(env, object, "value", field);
+    napi_create_double(env, event.x, &field);
+    napi_set_named_property(env, object, "x", field);
+    napi_create_double(env, event.y, &field);
+    napi_set_named_property(env, object, "y", field);
+    return object;
+}
 
-    if (env == nullptr || js_callback == nullptr) {
-        LOGE("CallGameOverJS: env or js_callback is null");
+static void CallEventsJS(napi_env env, napi_value js_callback, void *context, void *data) {
+    std::unique_ptr<EventDelivery> delivery(static_cast<EventDelivery *>(data));
+    TRACE_SCOPE("CallEventsJS");
+    Tracer::GetInstance()->FlowEnd("events", delivery->flow);
+    if (env == nullptr) {
+        delivery->bus->Release(delivery->batch);
         return;
     }
 
-    napi_value scoreArg;
-    napi_status status = napi_create_int32(env, payload->score, &scoreArg);
-    if (status != napi_ok) {
-        LOGE("Failed to create score argument");
-        return;
+    const EventBatch &batch = *delivery->batch;
+    napi_value events;
+    napi_create_array_with_length(env, batch.count, &events);
+    int32_t finalScore = -1;
+    for (uint32_t i = 0; i < batch.count; i++) {
+        napi_set_element(env, events, i, CreateEventObject(env, batch.events[i]));
+        if (batch.events[i].type == GameEventType::GameOver) {
+            finalScore = batch.events[i].value;
+        }
     }
+    // Everything JS needs has been copied out; the render thread may refill the batch.
+    delivery->bus->Release(delivery->batch);
 
     napi_value undefined;
     napi_get_undefined(env, &undefined);
-
+    napi_value callback = nullptr;
     napi_value result;
-    status = napi_call_function(env, undefined, js_callback, 1, &scoreArg, &result);
+    if (g_eventListenerRef != nullptr && napi_get_reference_value(env, g_eventListenerRef, &callback) == napi_ok &&
+        callback != nullptr) {
+        if (napi_call_function(env, undefined, callback, 1, &events, &result) != napi_ok) {
+            LOGE("CallEventsJS: event listener failed");
+        }
+    }
+    callback = nullptr;
+    if (finalScore >= 0 && g_gameOverRef != nullptr &&
+        napi_get_reference_value(env, g_gameOverRef, &callback) == napi_ok && callback != nullptr) {
+        TRACE_SCOPE("gameOverCallback");
+        napi_value scoreArg;
+        napi_create_int32(env, finalScore, &scoreArg);
+        if (napi_call_function(env, undefined, callback, 1, &scoreArg, &result) == napi_ok) {
+            LOGI("Game over callback called with score: %{public}d", finalScore);
+        } else {
+            LOGE("CallEventsJS: game over callback failed");
+        }
+    }
+}
 
-    if (status == napi_ok) {
-        LOGI("✅ Game over callback called successfully with score: %{public}d", payload->score);
-    } else {
-        LOGE("❌ Failed to call game over callback, status: %{public}d", status);
+static bool EnsureEventChannel(napi_env env) {
+    if (g_eventsTsfn.load() != nullptr) {
+        return true;
+    }
+    napi_value resourceName;
+    napi_create_string_utf8(env, "EngineEventsTSFN", NAPI_AUTO_LENGTH, &resourceName);
+    napi_threadsafe_function tsfn = nullptr;
+    napi_status status = napi_create_threadsafe_function(env, nullptr, nullptr, resourceName, 0, 1, nullptr, nullptr,
+                                                         nullptr, CallEventsJS, &tsfn);
+    if (status != napi_ok) {
+        LOGE("Failed to create events threadsafe function, status: %{public}d", status);
+        return false;
+    }
+    // Do not hold the event loop open for a channel that may stay idle.
+    napi_unref_threadsafe_function(env, tsfn);
+    g_eventsTsfn.store(tsfn);
+    return true;
+}
+
+// Replaces the reference in slot with value, or clears it if value is not a function.
+static void StoreCallbackRef(napi_env env, napi_ref &slot, napi_value value) {
+    if (slot != nullptr) {
+        napi_delete_reference(env, slot);
+        slot = nullptr;
     }
+    napi_valuetype type = napi_undefined;
+    if (value != nullptr && napi_typeof(env, value, &type) == napi_ok && type == napi_function) {
+        napi_create_reference(env, value, 1, &slot);
+    }
+}
+
+static void ConnectEventSink(const std::shared_ptr<EventBus> &bus) {
+    std::weak_ptr<EventBus> weakBus = bus;
+    bus->SetSink([weakBus](EventBatch *batch) {
+        napi_threadsafe_function tsfn = g_eventsTsfn.load();
+        std::shared_ptr<EventBus> owner = weakBus.lock();
+        if (tsfn == nullptr || !owner) {
+            return false;
+        }
+        auto *delivery = new EventDelivery{owner, batch, Tracer::NewFlowId()};
+        Tracer::GetInstance()->FlowStart("events", delivery->flow);
+        if (napi_call_threadsafe_function(tsfn, delivery, napi_tsfn_nonblocking) != napi_ok) {
+            delete delivery;
+            return false;
+        }
+        return true;
+    });
 }
 
 void OnSurfaceCreatedCB(OH_NativeXComponent *component, void *window) {
@@ -86,8 +220,25 @@ void OnSurfaceDestroyedCB(OH_NativeXComponent *component, void *window) {
     render->OnSurfaceDestroyed(component, window);
 }
 
+static void LogBudgetExceeded(const BudgetExceeded &event) {
+    const char *name = event.pool ? (event.index == static_cast<int>(ResourcePool::Gpu) ? "gpu" : "cpu")
+                                  : ResourceKindName(static_cast<ResourceKind>(event.index));
+    LOGE("Memory budget exceeded: %{public}s at %{public}llu of %{public}llu bytes after an allocation by "
+         "%{public}s",
+         name, (unsigned long long)event.bytes, (unsigned long long)event.budgetBytes, event.owner);
+    ResourceSnapshot snapshot = ResourceRegistry::GetInstance()->Snapshot();
+    size_t shown = std::min<size_t>(snapshot.owners.size(), 3);
+    for (size_t i = 0; i < shown; i++) {
+        LOGE("  %{public}s: %{public}u objects, %{public}llu bytes", snapshot.owners[i].owner.c_str(),
+             snapshot.owners[i].count, (unsigned long long)snapshot.owners[i].bytes);
+    }
+}
+
 PluginRender::PluginRender(std::string &id) : id_(id) {
+    ResourceRegistry::GetInstance()->SetBudgetCallback(LogBudgetExceeded);
     eglCore_ = new EGLCore(id);
+    ConnectEventSink(eglCore_->Events());
+    ApplySettings(eglCore_);
     auto renderCallback = PluginRender::GetNXComponentCallback();
     renderCallback->OnSurfaceCreated = OnSurfaceCreatedCB;
     renderCallback->OnSurfaceChanged = OnSurfaceChangedCB;
@@ -139,27 +290,39 @@ void PluginRender::OnSurfaceDestroyed(OH_NativeXComponent *component, void *wind
         eglCore_ = nullptr;
     }
 
-    // TSFN temizle
-    if (g_gameOverTsfn != nullptr) {
-        napi_release_threadsafe_function(g_gameOverTsfn, napi_tsfn_release);
-        g_gameOverTsfn = nullptr;
-    }
-
-    if (instance_[id_]) {
-        delete instance_[id_];
-        instance_[id_] = nullptr;
-        instance_.erase(id_);
+    // Deletes this object, so nothing may touch members afterwards.
+    auto it = instance_.find(id_);
+    if (it != instance_.end()) {
+        PluginRender *instance = it->second;
+        instance_.erase(it);
+        delete instance;
     }
 }
 
 napi_value PluginRender::Export(napi_env env, napi_value exports) {
     LOGI("PluginRender::Export");
+    Tracer::SetThreadName("js");
 
     napi_property_descriptor desc[] = {
         DECLARE_NAPI_FUNCTION("moveLeft", PluginRender::NapiMoveLeft),
         DECLARE_NAPI_FUNCTION("moveRight", PluginRender::NapiMoveRight),
         DECLARE_NAPI_FUNCTION("restartGame", PluginRender::NapiRestartGame),
+        DECLARE_NAPI_FUNCTION("setPaused", PluginRender::NapiSetPaused),
         DECLARE_NAPI_FUNCTION("setGameOverCallback", PluginRender::NapiSetGameOverCallback),
+        DECLARE_NAPI_FUNCTION("setEventListener", PluginRender::NapiSetEventListener),
+        DECLARE_NAPI_FUNCTION("setAdaptiveResolution", PluginRender::NapiSetAdaptiveResolution),
+        DECLARE_NAPI_FUNCTION("setLateLatch", PluginRender::NapiSetLateLatch),
+        DECLARE_NAPI_FUNCTION("setSoftwareRendering", PluginRender::NapiSetSoftwareRendering),
+        DECLARE_NAPI_FUNCTION("setSnapshotPath", PluginRender::NapiSetSnapshotPath),
+        DECLARE_NAPI_FUNCTION("loadSpawnSchedule", PluginRender::NapiLoadSpawnSchedule),
+        DECLARE_NAPI_FUNCTION("setCollisionMasks", PluginRender::NapiSetCollisionMasks),
+        DECLARE_NAPI_FUNCTION("getSharedState", PluginRender::NapiGetSharedState),
+        DECLARE_NAPI_FUNCTION("getMemoryStats", PluginRender::NapiGetMemoryStats),
+        DECLARE_NAPI_FUNCTION("setMemoryBudget", PluginRender::NapiSetMemoryBudget),
+        DECLARE_NAPI_FUNCTION("setTracing", PluginRender::NapiSetTracing),
+        DECLARE_NAPI_FUNCTION("dumpTrace", PluginRender::NapiDumpTrace),
+        DECLARE_NAPI_FUNCTION("startFrameCapture", PluginRender::NapiStartFrameCapture),
+        DECLARE_NAPI_FUNCTION("stopFrameCapture", PluginRender::NapiStopFrameCapture),
         DECLARE_NAPI_FUNCTION("switchAmbient", PluginRender::NapiSwitchAmbient),
         DECLARE_NAPI_FUNCTION("switchDiffuse", PluginRender::NapiSwitchDiffuse),
         DECLARE_NAPI_FUNCTION("switchSpecular", PluginRender::NapiSwitchSpecular),
@@ -180,50 +343,33 @@ napi_value PluginRender::NapiSetGameOverCallback(napi_env env, napi_callback_inf
         return nullptr;
     }
 
-    if (g_gameOverTsfn != nullptr) {
-        napi_release_threadsafe_function(g_gameOverTsfn, napi_tsfn_release);
-        g_gameOverTsfn = nullptr;
-    }
-
-    napi_value resourceName;
-    napi_create_string_utf8(env, "GameOverCallbackTSFN", NAPI_AUTO_LENGTH, &resourceName);
-
-    status = napi_create_threadsafe_function(env, args[1], nullptr, resourceName, 0, 1, nullptr, nullptr, nullptr,
-                                             CallGameOverJS, &g_gameOverTsfn);
-
-    if (status != napi_ok) {
-        LOGE("Failed to create threadsafe function");
+    // Delivered from the GameOver entry of the event batch, on the same channel as setEventListener.
+    if (!EnsureEventChannel(env)) {
         return nullptr;
     }
+    StoreCallbackRef(env, g_gameOverRef, args[1]);
 
-    LOGI("Threadsafe function created successfully");
-
-    std::string id("A");
-    PluginRender *instance = PluginRender::GetInstance(id);
-
-    if (instance && instance->eglCore_) {
-        instance->eglCore_->SetGameOverCallback([](int finalScore) {
-            LOGI("Game over! Triggering callback with score: %{public}d", finalScore);
-
-            if (g_gameOverTsfn == nullptr) {
-                LOGE("TSFN is null, cannot call callback");
-                return;
-            }
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
 
-            auto *payload = new GameOverPayload{finalScore};
+napi_value PluginRender::NapiSetEventListener(napi_env env, napi_callback_info info) {
+    LOGI("NapiSetEventListener called");
 
-            napi_status callStatus = napi_call_threadsafe_function(g_gameOverTsfn, payload, napi_tsfn_nonblocking);
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
 
-            if (callStatus != napi_ok) {
-                LOGE("Failed to call threadsafe function, status: %{public}d", callStatus);
-                delete payload;
-            } else {
-                LOGI("Threadsafe function call queued successfully");
-            }
-        });
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetEventListener: Failed to get callback info or wrong argument count");
+        return nullptr;
+    }
 
-        LOGI("Game over callback registered in EGLCore");
+    if (!EnsureEventChannel(env)) {
+        return nullptr;
     }
+    StoreCallbackRef(env, g_eventListenerRef, args[1]);
 
     napi_value undefined;
     napi_get_undefined(env, &undefined);
@@ -232,6 +378,7 @@ napi_value PluginRender::NapiSetGameOverCallback(napi_env env, napi_callback_inf
 
 napi_value PluginRender::NapiMoveLeft(napi_env env, napi_callback_info info) {
     LOGD("NapiMoveLeft called");
+    TRACE_SCOPE("moveLeft");
 
     size_t argc = 1;
     napi_value args[1] = {nullptr};
@@ -262,6 +409,7 @@ napi_value PluginRender::NapiMoveLeft(napi_env env, napi_callback_info info) {
 
 napi_value PluginRender::NapiMoveRight(napi_env env, napi_callback_info info) {
     LOGD("NapiMoveRight called");
+    TRACE_SCOPE("moveRight");
 
     size_t argc = 1;
     napi_value args[1] = {nullptr};
@@ -292,6 +440,7 @@ napi_value PluginRender::NapiMoveRight(napi_env env, napi_callback_info info) {
 
 napi_value PluginRender::NapiRestartGame(napi_env env, napi_callback_info info) {
     LOGD("NapiRestartGame called");
+    TRACE_SCOPE("restartGame");
 
     size_t argc = 1;
     napi_value args[1] = {nullptr};
@@ -320,6 +469,504 @@ napi_value PluginRender::NapiRestartGame(napi_env env, napi_callback_info info)
     return nullptr;
 }
 
+napi_value PluginRender::NapiSetPaused(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetPaused called");
+    TRACE_SCOPE("setPaused");
+
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetPaused: Failed to get callback info");
+        return nullptr;
+    }
+
+    bool paused = false;
+    if (napi_get_value_bool(env, args[1], &paused) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        instance->eglCore_->SetPaused(paused);
+    }
+    return nullptr;
+}
+
+napi_value PluginRender::NapiSetAdaptiveResolution(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetAdaptiveResolution called");
+
+    size_t argc = 4;
+    napi_value args[4] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetAdaptiveResolution: Failed to get callback info");
+        return nullptr;
+    }
+
+    bool enabled = true;
+    if (napi_get_value_bool(env, args[1], &enabled) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+
+    ResolutionScalerConfig config;
+    double value = 0.0;
+    if (argc > 2 && napi_get_value_double(env, args[2], &value) == napi_ok) {
+        config.minScale = static_cast<float>(value);
+    }
+    if (argc > 3 && napi_get_value_double(env, args[3], &value) == napi_ok) {
+        config.maxScale = static_cast<float>(value);
+    }
+
+    g_settings.adaptiveResolution = enabled;
+    g_settings.resolution = config;
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        instance->eglCore_->SetAdaptiveResolution(enabled, config);
+    }
+    return nullptr;
+}
+
+napi_value PluginRender::NapiSetLateLatch(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetLateLatch called");
+
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetLateLatch: Failed to get callback info");
+        return nullptr;
+    }
+
+    bool enabled = true;
+    if (napi_get_value_bool(env, args[1], &enabled) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+
+    g_settings.lateLatch = enabled;
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        instance->eglCore_->SetLateLatch(enabled);
+    }
+    return nullptr;
+}
+
+napi_value PluginRender::NapiSetSoftwareRendering(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetSoftwareRendering called");
+
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetSoftwareRendering: Failed to get callback info");
+        return nullptr;
+    }
+
+    bool enabled = false;
+    if (napi_get_value_bool(env, args[1], &enabled) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+
+    g_settings.softwareRendering = enabled;
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        instance->eglCore_->SetSoftwareRendering(enabled);
+    }
+    return nullptr;
+}
+
+napi_value PluginRender::NapiSetSnapshotPath(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetSnapshotPath called");
+
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetSnapshotPath: Failed to get callback info");
+        return nullptr;
+    }
+
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, args[1], nullptr, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+    std::string path(length, '\0');
+    napi_get_value_string_utf8(env, args[1], &path[0], length + 1, &length);
+
+    g_settings.snapshotPath = path;
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        instance->eglCore_->SetSnapshotPath(path);
+    }
+    return nullptr;
+}
+
+static bool ReadRawFile(napi_env env, napi_value resourceManager, const char *name, std::string &text) {
+    NativeResourceManager *manager = OH_ResourceManager_InitNativeResourceManager(env, resourceManager);
+    if (!manager) {
+        return false;
+    }
+    RawFile *file = OH_ResourceManager_OpenRawFile(manager, name);
+    bool ok = false;
+    if (file) {
+        long size = OH_ResourceManager_GetRawFileSize(file);
+        text.resize(size > 0 ? size : 0);
+        ok = size > 0 && OH_ResourceManager_ReadRawFile(file, &text[0], size) == size;
+        OH_ResourceManager_CloseRawFile(file);
+    }
+    OH_ResourceManager_ReleaseNativeResourceManager(manager);
+    return ok;
+}
+
+napi_value PluginRender::NapiLoadSpawnSchedule(napi_env env, napi_callback_info info) {
+    LOGD("NapiLoadSpawnSchedule called");
+
+    size_t argc = 3;
+    napi_value args[3] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 3) {
+        LOGE("NapiLoadSpawnSchedule: Failed to get callback info");
+        return nullptr;
+    }
+
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, args[2], nullptr, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+    std::string filesDir(length, '\0');
+    napi_get_value_string_utf8(env, args[2], &filesDir[0], length + 1, &length);
+
+    std::string text;
+    if (!ReadRawFile(env, args[1], "spawn_waves.txt", text)) {
+        LOGE("NapiLoadSpawnSchedule: rawfile spawn_waves.txt unavailable, using built-in waves");
+        text = DEFAULT_SPAWN_WAVES;
+    }
+
+    bool loaded = false;
+    std::string cachePath = filesDir + "/spawn_waves.bin";
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        loaded = instance->eglCore_->LoadSpawnSchedule(text, cachePath);
+    }
+    if (loaded) {
+        g_settings.spawnText = std::move(text);
+        g_settings.spawnCachePath = std::move(cachePath);
+    }
+
+    napi_value result;
+    napi_get_boolean(env, loaded, &result);
+    return result;
+}
+
+napi_value PluginRender::NapiSetCollisionMasks(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetCollisionMasks called");
+
+    size_t argc = 6;
+    napi_value args[6] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetCollisionMasks: Failed to get callback info");
+        return nullptr;
+    }
+
+    // null or undefined turns the masks off.
+    napi_valuetype type = napi_undefined;
+    napi_typeof(env, args[1], &type);
+    void *data = nullptr;
+    size_t bytes = 0;
+    int32_t sizes[4] = {0};
+    bool valid = true;
+    if (type != napi_null && type != napi_undefined) {
+        bool sized = argc >= 6;
+        for (int i = 0; sized && i < 4; i++) {
+            sized = napi_get_value_int32(env, args[i + 2], &sizes[i]) == napi_ok && sizes[i] > 0;
+        }
+        if (!sized || napi_get_arraybuffer_info(env, args[1], &data, &bytes) != napi_ok) {
+            napi_throw_type_error(env, NULL, "Wrong arguments");
+            return nullptr;
+        }
+        if (bytes / 4 / static_cast<size_t>(sizes[0]) < static_cast<size_t>(sizes[1])) {
+            LOGE("NapiSetCollisionMasks: %{public}zu bytes for a %{public}dx%{public}d RGBA atlas", bytes, sizes[0],
+                 sizes[1]);
+            valid = false;
+        }
+    }
+
+    std::shared_ptr<const CollisionAtlas> atlas;
+    if (valid && data) {
+        atlas = EGLCore::BuildCollisionMasks(static_cast<const uint8_t *>(data), sizes[0], sizes[1], sizes[2],
+                                             sizes[3]);
+        valid = atlas != nullptr;
+    }
+    if (valid) {
+        g_settings.collisionMasks = atlas;
+        std::string id("A");
+        PluginRender *instance = PluginRender::GetInstance(id);
+        if (instance && instance->eglCore_) {
+            instance->eglCore_->SetCollisionMasks(atlas);
+        }
+    }
+
+    napi_value result;
+    napi_get_boolean(env, valid, &result);
+    return result;
+}
+
+napi_value PluginRender::NapiGetSharedState(napi_env env, napi_callback_info info) {
+    LOGD("NapiGetSharedState called");
+
+    size_t argc = 1;
+    napi_value args[1] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 1) {
+        LOGE("NapiGetSharedState: Failed to get callback info");
+        return nullptr;
+    }
+
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (!instance || !instance->eglCore_) {
+        return nullptr;
+    }
+
+    // The ArrayBuffer holds a reference until it is collected; the surface may be destroyed before that.
+    auto *hint = new std::shared_ptr<SharedState>(instance->eglCore_->Shared());
+    napi_value buffer = nullptr;
+    status = napi_create_external_arraybuffer(
+        env, (*hint)->Data(), SharedState::Size(),
+        [](napi_env env, void *data, void *hint) { delete static_cast<std::shared_ptr<SharedState> *>(hint); }, hint,
+        &buffer);
+    if (status != napi_ok) {
+        LOGE("NapiGetSharedState: napi_create_external_arraybuffer failed, status: %{public}d", status);
+        delete hint;
+        return nullptr;
+    }
+    return buffer;
+}
+
+static void SetNumberProperty(napi_env env, napi_value object, const char *name, double value) {
+    napi_value field;
+    napi_create_double(env, value, &field);
+    napi_set_named_property(env, object, name, field);
+}
+
+static napi_value CreateUsageObject(napi_env env, const ResourceUsage &usage) {
+    napi_value object;
+    napi_create_object(env, &object);
+    SetNumberProperty(env, object, "count", usage.count);
+    SetNumberProperty(env, object, "bytes", static_cast<double>(usage.bytes));
+    SetNumberProperty(env, object, "peakBytes", static_cast<double>(usage.peakBytes));
+    SetNumberProperty(env, object, "budgetBytes", static_cast<double>(usage.budgetBytes));
+    SetNumberProperty(env, object, "overBudget", usage.overBudget);
+    return object;
+}
+
+napi_value PluginRender::NapiGetMemoryStats(napi_env env, napi_callback_info info) {
+    LOGD("NapiGetMemoryStats called");
+
+    ResourceSnapshot snapshot = ResourceRegistry::GetInstance()->Snapshot();
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "gpu",
+                            CreateUsageObject(env, snapshot.pools[static_cast<int>(ResourcePool::Gpu)]));
+    napi_set_named_property(env, result, "cpu",
+                            CreateUsageObject(env, snapshot.pools[static_cast<int>(ResourcePool::Cpu)]));
+
+    napi_value kinds;
+    napi_create_object(env, &kinds);
+    for (int i = 0; i < static_cast<int>(ResourceKind::Count); i++) {
+        napi_set_named_property(env, kinds, ResourceKindName(static_cast<ResourceKind>(i)),
+                                CreateUsageObject(env, snapshot.kinds[i]));
+    }
+    napi_set_named_property(env, result, "kinds", kinds);
+
+    napi_value owners;
+    napi_create_array_with_length(env, snapshot.owners.size(), &owners);
+    for (size_t i = 0; i < snapshot.owners.size(); i++) {
+        const ResourceOwnerUsage &usage = snapshot.owners[i];
+        napi_value owner;
+        napi_create_object(env, &owner);
+        napi_value name;
+        napi_create_string_utf8(env, usage.owner.c_str(), NAPI_AUTO_LENGTH, &name);
+        napi_set_named_property(env, owner, "owner", name);
+        SetNumberProperty(env, owner, "count", usage.count);
+        SetNumberProperty(env, owner, "bytes", static_cast<double>(usage.bytes));
+        napi_set_element(env, owners, static_cast<uint32_t>(i), owner);
+    }
+    napi_set_named_property(env, result, "owners", owners);
+    return result;
+}
+
+napi_value PluginRender::NapiSetMemoryBudget(napi_env env, napi_callback_info info) {
+    LOGI("NapiSetMemoryBudget called");
+
+    size_t argc = 3;
+    napi_value args[3] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 3) {
+        LOGE("NapiSetMemoryBudget: Failed to get callback info or wrong argument count");
+        return nullptr;
+    }
+
+    char name[32] = {0};
+    size_t nameLength = 0;
+    double bytes = 0;
+    if (napi_get_value_string_utf8(env, args[1], name, sizeof(name), &nameLength) != napi_ok ||
+        napi_get_value_double(env, args[2], &bytes) != napi_ok || bytes < 0) {
+        LOGE("NapiSetMemoryBudget: expected (context, string, bytes >= 0)");
+        return nullptr;
+    }
+
+    ResourceRegistry *registry = ResourceRegistry::GetInstance();
+    std::string target(name, nameLength);
+    ResourceKind kind;
+    if (target == "gpu") {
+        registry->SetPoolBudget(ResourcePool::Gpu, static_cast<uint64_t>(bytes));
+    } else if (target == "cpu") {
+        registry->SetPoolBudget(ResourcePool::Cpu, static_cast<uint64_t>(bytes));
+    } else if (ResourceKindFromName(target, kind)) {
+        registry->SetBudget(kind, static_cast<uint64_t>(bytes));
+    } else {
+        LOGE("NapiSetMemoryBudget: unknown budget '%{public}s'", target.c_str());
+        return nullptr;
+    }
+    LOGI("Memory budget %{public}s = %{public}.0f bytes", target.c_str(), bytes);
+
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+}
+
+napi_value PluginRender::NapiSetTracing(napi_env env, napi_callback_info info) {
+    LOGD("NapiSetTracing called");
+
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiSetTracing: Failed to get callback info");
+        return nullptr;
+    }
+
+    bool enabled = false;
+    if (napi_get_value_bool(env, args[1], &enabled) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+
+    // Process-wide, like the memory registry; the context only keeps the call shape of the other exports.
+    if (enabled) {
+        Tracer::GetInstance()->Start();
+    } else {
+        Tracer::GetInstance()->Stop();
+    }
+    return nullptr;
+}
+
+napi_value PluginRender::NapiDumpTrace(napi_env env, napi_callback_info info) {
+    LOGD("NapiDumpTrace called");
+
+    size_t argc = 2;
+    napi_value args[2] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiDumpTrace: Failed to get callback info");
+        return nullptr;
+    }
+
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, args[1], nullptr, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+    std::string path(length, '\0');
+    napi_get_value_string_utf8(env, args[1], &path[0], length + 1, &length);
+
+    napi_value result;
+    napi_get_boolean(env, Tracer::GetInstance()->Dump(path), &result);
+    return result;
+}
+
+napi_value PluginRender::NapiStartFrameCapture(napi_env env, napi_callback_info info) {
+    LOGD("NapiStartFrameCapture called");
+
+    size_t argc = 4;
+    napi_value args[4] = {nullptr};
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (status != napi_ok || argc < 2) {
+        LOGE("NapiStartFrameCapture: Failed to get callback info");
+        return nullptr;
+    }
+
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, args[1], nullptr, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Wrong arguments");
+        return nullptr;
+    }
+    FrameCaptureConfig config;
+    config.directory.assign(length, '\0');
+    napi_get_value_string_utf8(env, args[1], &config.directory[0], length + 1, &length);
+    double value = 0.0;
+    if (argc > 2 && napi_get_value_double(env, args[2], &value) == napi_ok && value >= 1.0) {
+        config.everyN = static_cast<uint32_t>(value);
+    }
+    if (argc > 3 && napi_get_value_double(env, args[3], &value) == napi_ok && value >= 0.0) {
+        config.maxFrames = static_cast<uint32_t>(value);
+    }
+
+    bool started = false;
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        started = instance->eglCore_->StartFrameCapture(config);
+    }
+    if (started) {
+        // Capture goes on with the next surface until stopFrameCapture.
+        g_settings.capturing = true;
+        g_settings.capture = std::move(config);
+    }
+    napi_value result;
+    napi_get_boolean(env, started, &result);
+    return result;
+}
+
+napi_value PluginRender::NapiStopFrameCapture(napi_env env, napi_callback_info info) {
+    LOGD("NapiStopFrameCapture called");
+
+    g_settings.capturing = false;
+    g_settings.capture = {};
+    std::string id("A");
+    PluginRender *instance = PluginRender::GetInstance(id);
+    if (instance && instance->eglCore_) {
+        instance->eglCore_->StopFrameCapture();
+    }
+    return nullptr;
+}
+
 napi_value PluginRender::NapiSwitchAmbient(napi_env env, napi_callback_info info) {
     LOGD("NapiSwitchAmbient - Deprecated");
     return nullptr;
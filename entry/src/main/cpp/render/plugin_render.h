@@ -26,7 +26,22 @@ public:
     static napi_value NapiMoveLeft(napi_env env, napi_callback_info info);
     static napi_value NapiMoveRight(napi_env env, napi_callback_info info);
     static napi_value NapiRestartGame(napi_env env, napi_callback_info info);
+    static napi_value NapiSetPaused(napi_env env, napi_callback_info info);
     static napi_value NapiSetGameOverCallback(napi_env env, napi_callback_info info);
+    static napi_value NapiSetEventListener(napi_env env, napi_callback_info info);
+    static napi_value NapiSetAdaptiveResolution(napi_env env, napi_callback_info info);
+    static napi_value NapiSetLateLatch(napi_env env, napi_callback_info info);
+    static napi_value NapiSetSoftwareRendering(napi_env env, napi_callback_info info);
+    static napi_value NapiSetSnapshotPath(napi_env env, napi_callback_info info);
+    static napi_value NapiLoadSpawnSchedule(napi_env env, napi_callback_info info);
+    static napi_value NapiSetCollisionMasks(napi_env env, napi_callback_info info);
+    static napi_value NapiGetSharedState(napi_env env, napi_callback_info info);
+    static napi_value NapiGetMemoryStats(napi_env env, napi_callback_info info);
+    static napi_value NapiSetMemoryBudget(napi_env env, napi_callback_info info);
+    static napi_value NapiSetTracing(napi_env env, napi_callback_info info);
+    static napi_value NapiDumpTrace(napi_env env, napi_callback_info info);
+    static napi_value NapiStartFrameCapture(napi_env env, napi_callback_info info);
+    static napi_value NapiStopFrameCapture(napi_env env, napi_callback_info info);
     static napi_value NapiSwitchAmbient(napi_env env, napi_callback_info info);
     static napi_value NapiSwitchDiffuse(napi_env env, napi_callback_info info);
     static napi_value NapiSwitchSpecular(napi_env env, napi_callback_info info);
@@ -39,6 +54,7 @@ private:
     std::string id_;
     uint64_t width_;
     uint64_t height_;
+    TrackedResource tracked_ {ResourceKind::Heap, "PluginRender", sizeof(PluginRender)};
 };
 
 #endif // PLUGIN_RENDER_H
\ No newline at end of file
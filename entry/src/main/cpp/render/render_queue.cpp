@@ -0,0 +1,55 @@
+#include "render_queue.h"
+
+void RenderQueue::Reserve(size_t count) {
+    commands_.reserve(count);
+    scratch_.reserve(count);
+}
+
+void RenderQueue::Assign(const RenderCommand *commands, size_t count) {
+    commands_.assign(commands, commands + count);
+}
+
+void RenderQueue::Sort() {
+    const size_t count = commands_.size();
+    if (count < 2) {
+        return;
+    }
+    scratch_.resize(count);
+
+    const int radixBits = 8;
+    const int buckets = 1 << radixBits;
+    for (int shift = 0; shift < 64; shift += radixBits) {
+        size_t histogram[buckets] = {0};
+        for (const RenderCommand &command : commands_) {
+            histogram[(command.sortKey >> shift) & (buckets - 1)]++;
+        }
+        // All keys share this byte: the pass would not move anything.
+        if (histogram[(commands_[0].sortKey >> shift) & (buckets - 1)] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int i = 0; i < buckets; i++) {
+            size_t bucketCount = histogram[i];
+            histogram[i] = offset;
+            offset += bucketCount;
+        }
+        for (const RenderCommand &command : commands_) {
+            scratch_[histogram[(command.sortKey >> shift) & (buckets - 1)]++] = command;
+        }
+        commands_.swap(scratch_);
+    }
+}
+
+void RenderQueue::Submit(const std::function<void(const RenderBatch &)> &submitBatch) const {
+    size_t begin = 0;
+    while (begin < commands_.size()) {
+        uint64_t state = commands_[begin].sortKey & RenderKey::kStateMask;
+        size_t end = begin + 1;
+        while (end < commands_.size() && (commands_[end].sortKey & RenderKey::kStateMask) == state) {
+            end++;
+        }
+        submitBatch({state, &commands_[begin], end - begin});
+        begin = end;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Sort key layout, most significant first:
+//   [63..56] layer  [55..48] program  [47..32] texture  [31..0] depth
+// Commands sharing the upper 32 bits need no state change between them and are merged into one batch.
+namespace RenderKey {
+constexpr int kLayerShift = 56;
+constexpr int kProgramShift = 48;
+constexpr int kTextureShift = 32;
+constexpr uint64_t kStateMask = 0xFFFFFFFF00000000ull;
+
+inline uint64_t Make(uint8_t layer, uint8_t program, uint16_t texture, uint32_t depth) {
+    return (static_cast<uint64_t>(layer) << kLayerShift) | (static_cast<uint64_t>(program) << kProgramShift) |
+           (static_cast<uint64_t>(texture) << kTextureShift) | depth;
+}
+inline uint8_t Layer(uint64_t key) { return static_cast<uint8_t>(key >> kLayerShift); }
+inline uint8_t Program(uint64_t key) { return static_cast<uint8_t>(key >> kProgramShift); }
+inline uint16_t Texture(uint64_t key) { return static_cast<uint16_t>(key >> kTextureShift); }
+} // namespace RenderKey
+
+// One sprite draw. Plain data so a frame can be copied, recorded and replayed as a flat array.
+struct RenderCommand {
+    uint64_t sortKey;
+    float x, y;          // center in NDC
+    float width, height; // size in NDC
+    uint32_t color;      // RGBA8, red in the lowest byte
+    uint32_t reserved;
+};
+
+struct RenderBatch {
+    uint64_t stateKey;
+    const RenderCommand *commands;
+    size_t count;
+};
+
+inline uint32_t PackColor(float r, float g, float b, float a) {
+    auto channel = [](float v) -> uint32_t {
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        return static_cast<uint32_t>(v * 255.0f + 0.5f);
+    };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+}
+
+// Commands are filled by the frame builder, radix sorted by key and submitted as batches of
+// state-compatible commands.
+class RenderQueue {
+public:
+    void Clear() { commands_.clear(); }
+    void Reserve(size_t count);
+    void Push(const RenderCommand &command) { commands_.push_back(command); }
+    void Assign(const RenderCommand *commands, size_t count);
+
+    // Stable LSD radix sort on the 64-bit key, skipping byte passes where every key is equal.
+    void Sort();
+    void Submit(const std::function<void(const RenderBatch &)> &submitBatch) const;
+
+    const std::vector<RenderCommand> &Commands() const { return commands_; }
+    size_t Size() const { return commands_.size(); }
+
+private:
+    std::vector<RenderCommand> commands_;
+    std::vector<RenderCommand> scratch_;
+};
+
+#endif // RENDER_QUEUE_H
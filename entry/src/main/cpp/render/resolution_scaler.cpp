@@ -0,0 +1,50 @@
+#include <algorithm>
+#include "resolution_scaler.h"
+
+void ResolutionScaler::Configure(const ResolutionScalerConfig &config) {
+    config_ = config;
+    config_.minScale = std::clamp(config_.minScale, 0.1f, 1.0f);
+    config_.maxScale = std::clamp(config_.maxScale, config_.minScale, 1.0f);
+    config_.step = std::max(config_.step, 0.01f);
+    config_.smoothing = std::clamp(config_.smoothing, 0.01f, 1.0f);
+    scale_ = std::clamp(scale_, config_.minScale, config_.maxScale);
+    overBudgetFrames_ = 0;
+    underBudgetFrames_ = 0;
+}
+
+void ResolutionScaler::Reset() {
+    scale_ = config_.maxScale;
+    smoothedMs_ = 0.0f;
+    overBudgetFrames_ = 0;
+    underBudgetFrames_ = 0;
+}
+
+bool ResolutionScaler::AddFrameTime(float frameMs) {
+    if (smoothedMs_ <= 0.0f) {
+        smoothedMs_ = frameMs;
+    } else {
+        smoothedMs_ += (frameMs - smoothedMs_) * config_.smoothing;
+    }
+
+    float upper = config_.targetFrameMs * config_.upperThreshold;
+    float lower = config_.targetFrameMs * config_.lowerThreshold;
+    overBudgetFrames_ = smoothedMs_ > upper ? overBudgetFrames_ + 1 : 0;
+    underBudgetFrames_ = smoothedMs_ < lower ? underBudgetFrames_ + 1 : 0;
+
+    float next = scale_;
+    if (overBudgetFrames_ >= config_.framesToDecrease) {
+        next = std::max(config_.minScale, scale_ - config_.step);
+    } else if (underBudgetFrames_ >= config_.framesToIncrease) {
+        next = std::min(config_.maxScale, scale_ + config_.step);
+    }
+    if (next == scale_) {
+        return false;
+    }
+
+    scale_ = next;
+    overBudgetFrames_ = 0;
+    underBudgetFrames_ = 0;
+    // Forget the previous level's history so the next decision is based on frames at the new scale.
+    smoothedMs_ = lower + (upper - lower) * 0.5f;
+    return true;
+}
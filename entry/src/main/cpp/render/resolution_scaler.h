@@ -0,0 +1,41 @@
+#ifndef RESOLUTION_SCALER_H
+#define RESOLUTION_SCALER_H
+
+struct ResolutionScalerConfig {
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float step = 0.1f;
+    // Frame budget in milliseconds; one vsync period at 60 Hz by default.
+    float targetFrameMs = 16.6f;
+    // Scale down once the smoothed frame time exceeds targetFrameMs * upperThreshold ...
+    float upperThreshold = 0.9f;
+    // ... and back up once it stays below targetFrameMs * lowerThreshold.
+    float lowerThreshold = 0.65f;
+    int framesToDecrease = 6;
+    int framesToIncrease = 90;
+    float smoothing = 0.15f;
+};
+
+// Picks the render scale from measured frame times. Decreases react within a few frames to keep the
+// frame rate, increases need a long calm streak so the scale does not oscillate around the budget.
+class ResolutionScaler {
+public:
+    void Configure(const ResolutionScalerConfig &config);
+    void Reset();
+
+    // Feeds one frame time in milliseconds. Returns true when the scale changed.
+    bool AddFrameTime(float frameMs);
+
+    float Scale() const { return scale_; }
+    float SmoothedFrameMs() const { return smoothedMs_; }
+    const ResolutionScalerConfig &Config() const { return config_; }
+
+private:
+    ResolutionScalerConfig config_;
+    float scale_ = 1.0f;
+    float smoothedMs_ = 0.0f;
+    int overBudgetFrames_ = 0;
+    int underBudgetFrames_ = 0;
+};
+
+#endif // RESOLUTION_SCALER_H
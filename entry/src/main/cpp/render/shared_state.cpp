@@ -0,0 +1,80 @@
+#include <cstring>
+#include "shared_state.h"
+
+namespace {
+const int MAX_READ_ATTEMPTS = 64;
+
+uint32_t FloatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float BitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+} // namespace
+
+SharedState::SharedState() {
+    for (auto &word : words_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    words_[SHARED_VERSION].store(SHARED_STATE_VERSION, std::memory_order_relaxed);
+    Publish(SharedStateValues());
+}
+
+void SharedState::Store(SharedStateWord word, int32_t value) {
+    words_[word].store(static_cast<uint32_t>(value), std::memory_order_relaxed);
+}
+
+void SharedState::Store(SharedStateWord word, float value) {
+    words_[word].store(FloatBits(value), std::memory_order_relaxed);
+}
+
+void SharedState::Publish(const SharedStateValues &values) {
+    uint32_t sequence = words_[SHARED_SEQUENCE].load(std::memory_order_relaxed);
+    words_[SHARED_SEQUENCE].store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Store(SHARED_FRAME, values.frame);
+    Store(SHARED_SCORE, values.score);
+    Store(SHARED_STATE, values.state);
+    Store(SHARED_OBSTACLES, values.obstacles);
+    Store(SHARED_PLAYER_X, values.playerX);
+    Store(SHARED_PLAYER_Y, values.playerY);
+    Store(SHARED_FPS, values.fps);
+    Store(SHARED_FRAME_MS, values.frameMs);
+    Store(SHARED_RENDER_SCALE, values.renderScale);
+    Store(SHARED_SIM_SECONDS, values.simSeconds);
+    Store(SHARED_INPUT_LATENCY_MS, values.inputLatencyMs);
+
+    words_[SHARED_SEQUENCE].store(sequence + 2, std::memory_order_release);
+}
+
+bool SharedState::Read(SharedStateValues &values) const {
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint32_t before = words_[SHARED_SEQUENCE].load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        auto word = [this](SharedStateWord index) { return words_[index].load(std::memory_order_relaxed); };
+        values.frame = static_cast<int32_t>(word(SHARED_FRAME));
+        values.score = static_cast<int32_t>(word(SHARED_SCORE));
+        values.state = static_cast<int32_t>(word(SHARED_STATE));
+        values.obstacles = static_cast<int32_t>(word(SHARED_OBSTACLES));
+        values.playerX = BitsFloat(word(SHARED_PLAYER_X));
+        values.playerY = BitsFloat(word(SHARED_PLAYER_Y));
+        values.fps = BitsFloat(word(SHARED_FPS));
+        values.frameMs = BitsFloat(word(SHARED_FRAME_MS));
+        values.renderScale = BitsFloat(word(SHARED_RENDER_SCALE));
+        values.simSeconds = BitsFloat(word(SHARED_SIM_SECONDS));
+        values.inputLatencyMs = BitsFloat(word(SHARED_INPUT_LATENCY_MS));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (words_[SHARED_SEQUENCE].load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,71 @@
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#include <atomic>
+#include <cstdint>
+#include "resource_registry.h"
+
+// Word indices of the shared state block. ArkTS reads the block through Int32Array and Float32Array
+// views of the same ArrayBuffer; keep this list in sync with Index.d.ts and SharedStateView.ets.
+enum SharedStateWord : uint32_t {
+    SHARED_SEQUENCE = 0,     // odd while the engine is writing
+    SHARED_VERSION,          // SHARED_STATE_VERSION
+    SHARED_FRAME,            // int32, frames presented, continued from a restored snapshot
+    SHARED_SCORE,            // int32
+    SHARED_STATE,            // int32, 0 playing, 1 paused, 2 game over
+    SHARED_OBSTACLES,        // int32, live obstacles
+    SHARED_PLAYER_X,         // float32, NDC
+    SHARED_PLAYER_Y,         // float32, NDC
+    SHARED_FPS,              // float32, smoothed display rate
+    SHARED_FRAME_MS,         // float32, CPU + GPU time of the last drawn frame
+    SHARED_RENDER_SCALE,     // float32, adaptive resolution scale
+    SHARED_SIM_SECONDS,      // float32, simulation time of the current game
+    SHARED_INPUT_LATENCY_MS, // float32, smoothed input-to-present latency, 0 until measured
+    SHARED_WORD_COUNT,
+};
+
+// 2 added SHARED_INPUT_LATENCY_MS.
+constexpr uint32_t SHARED_STATE_VERSION = 2;
+constexpr uint32_t SHARED_STATE_WORDS = 16;
+static_assert(SHARED_WORD_COUNT <= SHARED_STATE_WORDS, "shared state block is full");
+
+struct SharedStateValues {
+    int32_t frame = 0;
+    int32_t score = 0;
+    int32_t state = 0;
+    int32_t obstacles = 0;
+    float playerX = 0.0f;
+    float playerY = 0.0f;
+    float fps = 0.0f;
+    float frameMs = 0.0f;
+    float renderScale = 1.0f;
+    float simSeconds = 0.0f;
+    float inputLatencyMs = 0.0f;
+};
+
+// Fixed 64-byte block handed to ArkTS as an external ArrayBuffer, so the UI reads live values without a
+// native call. One writer (the render thread) publishes under a sequence lock: readers retry while the
+// sequence is odd or changed during their read. Every ArrayBuffer keeps its own reference to the block,
+// so a buffer stays readable after the XComponent and its EGLCore are gone.
+class SharedState {
+public:
+    SharedState();
+
+    void Publish(const SharedStateValues &values);
+    // Native-side reader following the same protocol as ArkTS. Returns false if the writer kept it busy.
+    bool Read(SharedStateValues &values) const;
+
+    void *Data() { return words_; }
+    static constexpr size_t Size() { return SHARED_STATE_WORDS * sizeof(uint32_t); }
+
+private:
+    void Store(SharedStateWord word, int32_t value);
+    void Store(SharedStateWord word, float value);
+
+    alignas(64) std::atomic<uint32_t> words_[SHARED_STATE_WORDS];
+    TrackedResource tracked_ {ResourceKind::Heap, "SharedState", sizeof(SharedState)};
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "shared words must be plain 32-bit");
+
+#endif // SHARED_STATE_H
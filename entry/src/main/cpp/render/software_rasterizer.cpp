@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cmath>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "software_rasterizer.h"
+#include "tracing.h"
+
+namespace {
+// Sprites per binning job, and tiles per drawing job.
+const size_t BIN_CHUNK = 256;
+const size_t TILE_GRAIN = 4;
+
+uint8_t EncodeSrgb(float linear) {
+    linear = std::clamp(linear, 0.0f, 1.0f);
+    float encoded = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(encoded * 255.0f + 0.5f);
+}
+
+// What the sRGB window surface stores for a linear RGBA8 color; alpha is not encoded.
+uint32_t EncodeColor(uint32_t color) {
+    static const struct Table {
+        uint8_t values[256];
+        Table() {
+            for (int i = 0; i < 256; i++) {
+                values[i] = EncodeSrgb(i / 255.0f);
+            }
+        }
+    } table;
+    return table.values[color & 0xff] | (table.values[(color >> 8) & 0xff] << 8) |
+           (table.values[(color >> 16) & 0xff] << 16) | (color & 0xff000000u);
+}
+
+void FillSpan(uint32_t *dst, int count, uint32_t color) {
+#if defined(__ARM_NEON)
+    uint32x4_t value = vdupq_n_u32(color);
+    for (; count >= 8; count -= 8, dst += 8) {
+        vst1q_u32(dst, value);
+        vst1q_u32(dst + 4, value);
+    }
+    if (count >= 4) {
+        vst1q_u32(dst, value);
+        count -= 4;
+        dst += 4;
+    }
+#elif defined(__SSE2__)
+    __m128i value = _mm_set1_epi32(static_cast<int>(color));
+    for (; count >= 8; count -= 8, dst += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), value);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4), value);
+    }
+    if (count >= 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), value);
+        count -= 4;
+        dst += 4;
+    }
+#endif
+    for (; count > 0; count--) {
+        *dst++ = color;
+    }
+}
+
+// First pixel whose center is at or past the window coordinate edge.
+int32_t PixelEdge(float ndc, int size) {
+    return static_cast<int32_t>(std::ceil((ndc + 1.0f) * 0.5f * size - 0.5f));
+}
+} // namespace
+
+void SoftwareRasterizer::Resize(int width, int height) {
+    if (width == width_ && height == height_) {
+        return;
+    }
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    tilesX_ = (width_ + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY_ = (height_ + TILE_SIZE - 1) / TILE_SIZE;
+    pixels_.assign(static_cast<size_t>(width_) * height_, 0);
+    pixels_.shrink_to_fit();
+    trackedPixels_.Resize(pixels_.size() * sizeof(uint32_t));
+    fullRedraw_ = true;
+}
+
+void SoftwareRasterizer::Begin(float r, float g, float b, float a) {
+    clearColor_ = EncodeSrgb(r) | (EncodeSrgb(g) << 8) | (EncodeSrgb(b) << 16) |
+                  (static_cast<uint32_t>(std::clamp(a, 0.0f, 1.0f) * 255.0f + 0.5f) << 24);
+    rects_.clear();
+}
+
+void SoftwareRasterizer::SubmitSprites(const SpriteInstance *sprites, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const SpriteInstance &sprite = sprites[i];
+        float cx = SpriteCoordToNdc(sprite.x);
+        float cy = SpriteCoordToNdc(sprite.y);
+        float halfWidth = SpriteCoordToNdc(sprite.width) * 0.5f;
+        float halfHeight = SpriteCoordToNdc(sprite.height) * 0.5f;
+        PixelRect rect;
+        rect.x0 = std::max(0, PixelEdge(cx - halfWidth, width_));
+        rect.x1 = std::min(width_, PixelEdge(cx + halfWidth, width_));
+        rect.y0 = std::max(0, PixelEdge(cy - halfHeight, height_));
+        rect.y1 = std::min(height_, PixelEdge(cy + halfHeight, height_));
+        if (rect.x0 < rect.x1 && rect.y0 < rect.y1) {
+            rect.color = EncodeColor(sprite.color);
+            rects_.push_back(rect);
+        }
+    }
+    stats_.sprites += count;
+}
+
+void SoftwareRasterizer::Resolve(JobSystem &jobs, const std::vector<int32_t> *rects) {
+    TRACE_SCOPE("SoftwareRaster");
+    int tileCount = tilesX_ * tilesY_;
+    bool full = fullRedraw_ || !rects;
+    tileDirty_.assign(tileCount, full ? 1 : 0);
+    if (!full) {
+        for (size_t i = 0; i + 3 < rects->size(); i += 4) {
+            int32_t x0 = std::max(0, (*rects)[i]);
+            int32_t y0 = std::max(0, (*rects)[i + 1]);
+            int32_t x1 = std::min(width_, (*rects)[i] + (*rects)[i + 2]);
+            int32_t y1 = std::min(height_, (*rects)[i + 1] + (*rects)[i + 3]);
+            for (int32_t ty = y0 / TILE_SIZE; x0 < x1 && ty * TILE_SIZE < y1; ty++) {
+                for (int32_t tx = x0 / TILE_SIZE; tx * TILE_SIZE < x1; tx++) {
+                    tileDirty_[ty * tilesX_ + tx] = 1;
+                }
+            }
+        }
+    }
+    fullRedraw_ = false;
+
+    binChunks_ = JobSystem::ChunkCount(rects_.size(), BIN_CHUNK);
+    if (bins_.size() < binChunks_) {
+        bins_.resize(binChunks_);
+    }
+    for (size_t chunk = 0; chunk < binChunks_; chunk++) {
+        bins_[chunk].resize(tileCount);
+    }
+    jobs.ParallelFor(rects_.size(), BIN_CHUNK,
+                     [this](size_t chunk, size_t begin, size_t end) { BinChunk(chunk, begin, end); });
+
+    drawList_.clear();
+    for (int tile = 0; tile < tileCount; tile++) {
+        if (tileDirty_[tile]) {
+            drawList_.push_back(tile);
+        }
+    }
+    jobs.ParallelFor(drawList_.size(), TILE_GRAIN, [this](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            DrawTile(drawList_[i]);
+        }
+    });
+    stats_.frames++;
+    stats_.tilesDrawn += drawList_.size();
+    stats_.tilesKept += tileCount - drawList_.size();
+}
+
+void SoftwareRasterizer::BinChunk(size_t chunk, size_t begin, size_t end) {
+    std::vector<std::vector<uint32_t>> &bins = bins_[chunk];
+    for (std::vector<uint32_t> &bin : bins) {
+        bin.clear();
+    }
+    for (size_t i = begin; i < end; i++) {
+        const PixelRect &rect = rects_[i];
+        int tx1 = (rect.x1 - 1) / TILE_SIZE;
+        int ty1 = (rect.y1 - 1) / TILE_SIZE;
+        for (int ty = rect.y0 / TILE_SIZE; ty <= ty1; ty++) {
+            for (int tx = rect.x0 / TILE_SIZE; tx <= tx1; tx++) {
+                int tile = ty * tilesX_ + tx;
+                if (tileDirty_[tile]) {
+                    bins[tile].push_back(static_cast<uint32_t>(i));
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::DrawTile(int tile) {
+    int32_t x0 = (tile % tilesX_) * TILE_SIZE;
+    int32_t y0 = (tile / tilesX_) * TILE_SIZE;
+    int32_t x1 = std::min(width_, x0 + TILE_SIZE);
+    int32_t y1 = std::min(height_, y0 + TILE_SIZE);
+    for (int32_t y = y0; y < y1; y++) {
+        FillSpan(&pixels_[static_cast<size_t>(y) * width_ + x0], x1 - x0, clearColor_);
+    }
+    // Chunks cover consecutive sprites, so walking them in order keeps the submission order.
+    for (size_t chunk = 0; chunk < binChunks_; chunk++) {
+        for (uint32_t index : bins_[chunk][tile]) {
+            const PixelRect &rect = rects_[index];
+            int32_t left = std::max(x0, rect.x0);
+            int32_t right = std::min(x1, rect.x1);
+            int32_t top = std::min(y1, rect.y1);
+            for (int32_t y = std::max(y0, rect.y0); y < top; y++) {
+                FillSpan(&pixels_[static_cast<size_t>(y) * width_ + left], right - left, rect.color);
+            }
+        }
+    }
+}
+
+SoftwareRasterStats SoftwareRasterizer::TakeStats() {
+    SoftwareRasterStats stats = stats_;
+    stats_ = {};
+    return stats;
+}
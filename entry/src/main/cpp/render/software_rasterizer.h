@@ -0,0 +1,71 @@
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "job_system.h"
+#include "resource_registry.h"
+#include "sprite_instance.h"
+
+struct SoftwareRasterStats {
+    uint32_t frames = 0;
+    uint64_t sprites = 0;
+    uint64_t tilesDrawn = 0;
+    // Tiles outside the damage region, kept from the previous frame.
+    uint64_t tilesKept = 0;
+};
+
+// CPU backend for the sprite batches the GL path uploads. Quads are snapped to pixel rectangles with the
+// GL sampling rule (a pixel is covered when its center is inside), binned into TILE_SIZE tiles in parallel
+// and filled tile by tile on the job system, each tile applying its sprites in submission order. Like the
+// GL pipeline, sprites are opaque and colors are written sRGB-encoded, so a frame compares against a GL
+// readback of the sRGB window surface. The framebuffer is kept between frames; only tiles touched by the
+// damage region are redrawn. Rows are stored bottom first, as glReadPixels returns them.
+class SoftwareRasterizer {
+public:
+    static constexpr int TILE_SIZE = 64;
+
+    void Resize(int width, int height);
+    int Width() const { return width_; }
+    int Height() const { return height_; }
+    // RGBA8, red in the lowest byte.
+    const uint32_t *Pixels() const { return pixels_.data(); }
+
+    // Starts a frame cleared to the given linear color.
+    void Begin(float r, float g, float b, float a);
+    void SubmitSprites(const SpriteInstance *sprites, size_t count);
+    // Draws the tiles overlapping rects (x, y, w, h quadruples in pixels, bottom-left origin), or all of
+    // them when rects is null or the framebuffer was resized since the last frame.
+    void Resolve(JobSystem &jobs, const std::vector<int32_t> *rects);
+
+    // Returns the counters accumulated since the previous call.
+    SoftwareRasterStats TakeStats();
+
+private:
+    struct PixelRect {
+        int32_t x0, y0, x1, y1;
+        uint32_t color;
+    };
+
+    void BinChunk(size_t chunk, size_t begin, size_t end);
+    void DrawTile(int tile);
+
+    int width_ = 0;
+    int height_ = 0;
+    int tilesX_ = 0;
+    int tilesY_ = 0;
+    std::vector<uint32_t> pixels_;
+    TrackedResource trackedPixels_ {ResourceKind::Heap, "software framebuffer", 0};
+    bool fullRedraw_ = true;
+    uint32_t clearColor_ = 0;
+    std::vector<PixelRect> rects_;
+    // Per binning chunk, per tile: indices into rects_. Kept across frames for their capacity.
+    std::vector<std::vector<std::vector<uint32_t>>> bins_;
+    size_t binChunks_ = 0;
+    std::vector<uint8_t> tileDirty_;
+    std::vector<int> drawList_;
+    SoftwareRasterStats stats_;
+};
+
+#endif // SOFTWARE_RASTERIZER_H
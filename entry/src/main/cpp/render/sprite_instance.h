@@ -0,0 +1,27 @@
+#ifndef SPRITE_INSTANCE_H
+#define SPRITE_INSTANCE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Sprite positions and sizes are quantized to int16 over [-SPRITE_POSITION_RANGE, SPRITE_POSITION_RANGE].
+// The sprite vertex shader hardcodes the same range.
+constexpr float SPRITE_POSITION_RANGE = 4.0f;
+
+// Per-sprite instance data: center and size as normalized int16 scaled by SPRITE_POSITION_RANGE in the
+// shader, color as RGBA8. 12 bytes per sprite; the quad corners come from a static buffer.
+struct SpriteInstance {
+    int16_t x, y;
+    int16_t width, height;
+    uint32_t color;
+};
+
+inline int16_t QuantizeSpriteCoord(float value) {
+    float scaled = std::round(value / SPRITE_POSITION_RANGE * 32767.0f);
+    return static_cast<int16_t>(std::clamp(scaled, -32767.0f, 32767.0f));
+}
+
+inline float SpriteCoordToNdc(int16_t value) { return value / 32767.0f * SPRITE_POSITION_RANGE; }
+
+#endif // SPRITE_INSTANCE_H
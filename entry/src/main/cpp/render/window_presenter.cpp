@@ -0,0 +1,102 @@
+#include <hilog/log.h>
+#include <algorithm>
+#include <cstring>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <native_buffer/native_buffer.h>
+#include <native_window/external_window.h>
+#include "window_presenter.h"
+#include "plugin_common.h"
+#include "tracing.h"
+
+namespace {
+// A release fence that has not signaled by then belongs to a wedged compositor; drop the frame.
+const int FENCE_TIMEOUT_MS = 3000;
+} // namespace
+
+bool WindowPresenter::Attach(void *window) {
+    Detach();
+    window_ = static_cast<NativeWindow *>(window);
+    uint64_t usage = NATIVEBUFFER_USAGE_CPU_READ | NATIVEBUFFER_USAGE_CPU_WRITE | NATIVEBUFFER_USAGE_MEM_DMA;
+    if (OH_NativeWindow_NativeWindowHandleOpt(window_, SET_FORMAT, NATIVEBUFFER_PIXEL_FMT_RGBA_8888) != 0 ||
+        OH_NativeWindow_NativeWindowHandleOpt(window_, SET_USAGE, usage) != 0) {
+        LOGE("WindowPresenter: cannot configure window buffers");
+        window_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void WindowPresenter::Detach() {
+    window_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+}
+
+bool WindowPresenter::Present(const uint32_t *pixels, int width, int height, const std::vector<int32_t> *rects) {
+    if (!window_ || width <= 0 || height <= 0) {
+        return false;
+    }
+    if (width != width_ || height != height_) {
+        if (OH_NativeWindow_NativeWindowHandleOpt(window_, SET_BUFFER_GEOMETRY, width, height) != 0) {
+            LOGE("WindowPresenter: cannot size window buffers to %{public}dx%{public}d", width, height);
+            return false;
+        }
+        width_ = width;
+        height_ = height;
+    }
+
+    OHNativeWindowBuffer *buffer = nullptr;
+    int fenceFd = -1;
+    if (OH_NativeWindow_NativeWindowRequestBuffer(window_, &buffer, &fenceFd) != 0 || !buffer) {
+        LOGE("WindowPresenter: no window buffer available");
+        return false;
+    }
+    if (fenceFd >= 0) {
+        // The compositor may still be reading this buffer.
+        TRACE_SCOPE("WaitReleaseFence");
+        struct pollfd fence = {fenceFd, POLLIN, 0};
+        int ready = poll(&fence, 1, FENCE_TIMEOUT_MS);
+        close(fenceFd);
+        if (ready <= 0) {
+            OH_NativeWindow_NativeWindowAbortBuffer(window_, buffer);
+            return false;
+        }
+    }
+    BufferHandle *handle = OH_NativeWindow_GetBufferHandleFromNative(buffer);
+    void *mapped = handle ? mmap(handle->virAddr, handle->size, PROT_READ | PROT_WRITE, MAP_SHARED, handle->fd, 0)
+                          : MAP_FAILED;
+    if (mapped == MAP_FAILED) {
+        LOGE("WindowPresenter: cannot map window buffer");
+        OH_NativeWindow_NativeWindowAbortBuffer(window_, buffer);
+        return false;
+    }
+
+    {
+        TRACE_SCOPE("CopyToWindow");
+        // Window buffers are stored top row first. Every dequeued buffer is rewritten in full, since its
+        // age in the queue is unknown.
+        int copyWidth = std::min(width, handle->width);
+        int copyHeight = std::min(height, handle->height);
+        uint8_t *dst = static_cast<uint8_t *>(mapped);
+        for (int y = 0; y < copyHeight; y++) {
+            const uint32_t *src = pixels + static_cast<size_t>(height - 1 - y) * width;
+            memcpy(dst + static_cast<size_t>(y) * handle->stride, src, copyWidth * sizeof(uint32_t));
+        }
+    }
+    munmap(mapped, handle->size);
+
+    std::vector<Region::Rect> damage;
+    if (rects) {
+        for (size_t i = 0; i + 3 < rects->size(); i += 4) {
+            int32_t x = (*rects)[i];
+            int32_t y = (*rects)[i + 1];
+            int32_t w = (*rects)[i + 2];
+            int32_t h = (*rects)[i + 3];
+            damage.push_back({x, height - (y + h), static_cast<uint32_t>(w), static_cast<uint32_t>(h)});
+        }
+    }
+    Region region {damage.empty() ? nullptr : damage.data(), static_cast<int32_t>(damage.size())};
+    return OH_NativeWindow_NativeWindowFlushBuffer(window_, buffer, -1, region) == 0;
+}
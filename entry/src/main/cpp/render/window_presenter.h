@@ -0,0 +1,28 @@
+#ifndef WINDOW_PRESENTER_H
+#define WINDOW_PRESENTER_H
+
+#include <cstdint>
+#include <vector>
+#include "damage_tracker.h"
+
+struct NativeWindow;
+
+// Presents CPU-rendered frames by writing them into the window's buffer queue, for when there is no
+// working GLES driver. The window must not have an EGL surface attached.
+class WindowPresenter {
+public:
+    bool Attach(void *window);
+    void Detach();
+    bool Attached() const { return window_ != nullptr; }
+
+    // pixels are RGBA8 rows, bottom row first. rects (x, y, w, h quadruples, bottom-left origin) are
+    // passed to the compositor as the changed area; null means the whole window.
+    bool Present(const uint32_t *pixels, int width, int height, const std::vector<int32_t> *rects);
+
+private:
+    NativeWindow *window_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+};
+
+#endif // WINDOW_PRESENTER_H
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "capture_writer.h"
+#include "test_check.h"
+
+// TGA round trips and the golden-image comparison the rendering tests are built on.
+namespace {
+CapturedFrame Gradient(int width, int height) {
+    CapturedFrame frame;
+    frame.width = width;
+    frame.height = height;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            frame.rgba.insert(frame.rgba.end(), {static_cast<uint8_t>(x * 40), static_cast<uint8_t>(y * 60),
+                                                 static_cast<uint8_t>(x + y), static_cast<uint8_t>(255 - x)});
+        }
+    }
+    return frame;
+}
+
+bool WriteBytes(const std::string &path, const std::vector<uint8_t> &bytes) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+void TestRoundTrip() {
+    CapturedFrame frame = Gradient(5, 3);
+    CHECK(WriteFrameTga("capture_writer_test.tga", frame));
+    CapturedFrame read;
+    CHECK(ReadFrameTga("capture_writer_test.tga", read));
+    CHECK(read.width == 5 && read.height == 3);
+    CHECK(read.rgba == frame.rgba);
+    FrameDiff diff = CompareFrames(read, frame, 0);
+    CHECK(diff.sameSize && diff.mismatched == 0 && diff.maxDelta == 0);
+}
+
+void TestTopOrigin24Bit() {
+    // 2x2, rows stored top first as BGR: red, green over blue, white.
+    std::vector<uint8_t> bytes(18, 0);
+    bytes[2] = 2;
+    bytes[12] = 2;
+    bytes[14] = 2;
+    bytes[16] = 24;
+    bytes[17] = 0x20;
+    bytes.insert(bytes.end(), {0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255});
+    CHECK(WriteBytes("capture_writer_test_top.tga", bytes));
+    CapturedFrame read;
+    CHECK(ReadFrameTga("capture_writer_test_top.tga", read));
+    // Bottom row first, opaque.
+    std::vector<uint8_t> expected = {0, 0, 255, 255, 255, 255, 255, 255, 255, 0, 0, 255, 0, 255, 0, 255};
+    CHECK(read.width == 2 && read.height == 2 && read.rgba == expected);
+
+    bytes.resize(bytes.size() - 1);
+    CHECK(WriteBytes("capture_writer_test_top.tga", bytes));
+    CHECK(!ReadFrameTga("capture_writer_test_top.tga", read));
+}
+
+void TestCompareTolerance() {
+    CapturedFrame reference = Gradient(4, 4);
+    CapturedFrame frame = reference;
+    frame.rgba[5 * 4 + 1] += 3;
+    frame.rgba[9 * 4 + 2] += 1;
+
+    FrameDiff diff = CompareFrames(frame, reference, 3);
+    CHECK(diff.sameSize && diff.mismatched == 0 && diff.maxDelta == 3);
+    diff = CompareFrames(frame, reference, 2);
+    CHECK(diff.mismatched == 1);
+    diff = CompareFrames(frame, reference, 0);
+    CHECK(diff.mismatched == 2);
+
+    CHECK(!CompareFrames(Gradient(4, 3), reference, 255).sameSize);
+}
+} // namespace
+
+int main() {
+    TestRoundTrip();
+    TestTopOrigin24Bit();
+    TestCompareTolerance();
+    return TestResult();
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "collision_mask.h"
+#include "test_check.h"
+
+// The word-wise narrowphase against a cell-by-cell reference, and its cost for a frame with hundreds of
+// candidate pairs.
+namespace {
+uint32_t g_random = 11;
+
+int Random(int range) {
+    g_random = g_random * 1103515245u + 12345u;
+    return static_cast<int>((g_random >> 16) % static_cast<uint32_t>(range));
+}
+
+bool NaiveOverlap(const CollisionMask &a, int ax, int ay, const CollisionMask &b, int bx, int by) {
+    for (int y = 0; y < a.Height(); y++) {
+        for (int x = 0; x < a.Width(); x++) {
+            int u = x + ax - bx;
+            int v = y + ay - by;
+            if (a.Test(x, y) && u >= 0 && v >= 0 && u < b.Width() && v < b.Height() && b.Test(u, v)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+CollisionMask RandomMask(int width, int height, int permille) {
+    CollisionMask mask(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (Random(1000) < permille) {
+                mask.Set(x, y);
+            }
+        }
+    }
+    return mask;
+}
+
+CollisionMask Circle(int size) {
+    std::vector<uint8_t> rgba(size * size * 4, 0);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float dx = (x + 0.5f) / size - 0.5f;
+            float dy = (y + 0.5f) / size - 0.5f;
+            rgba[(y * size + x) * 4 + 3] = dx * dx + dy * dy <= 0.25f ? 255 : 0;
+        }
+    }
+    return CollisionAtlas::FromRgba(rgba.data(), size, size, size, size, 128)->Frame(0);
+}
+
+void TestMatchesReference() {
+    int mismatches = 0;
+    int hits = 0;
+    for (int i = 0; i < 20000; i++) {
+        // Sparse masks make most overlapping placements miss, dense ones make them hit.
+        int permille = i % 4 == 0 ? 2 : 300;
+        CollisionMask a = RandomMask(1 + Random(200), 1 + Random(40), permille);
+        CollisionMask b = RandomMask(1 + Random(200), 1 + Random(40), permille);
+        int ax = Random(400) - 200;
+        int ay = Random(60) - 30;
+        int bx = Random(400) - 200;
+        int by = Random(60) - 30;
+        bool expected = NaiveOverlap(a, ax, ay, b, bx, by);
+        hits += expected;
+        mismatches += MasksOverlap(a, ax, ay, b, bx, by) != expected;
+    }
+    CHECK(mismatches == 0);
+    CHECK(hits > 1000);
+}
+
+void TestAtlasOrientation() {
+    // Top row opaque in a 2x3 atlas frame: masks are bottom row first, so that is row 2.
+    std::vector<uint8_t> rgba(4 * 3 * 4, 0);
+    for (int x = 0; x < 4; x++) {
+        rgba[x * 4 + 3] = 255;
+    }
+    std::shared_ptr<CollisionAtlas> atlas = CollisionAtlas::FromRgba(rgba.data(), 4, 3, 2, 3, 128);
+    CHECK(atlas && atlas->FrameCount() == 2);
+    CHECK(atlas && atlas->Frame(1).Test(0, 2) && !atlas->Frame(1).Test(0, 0));
+}
+
+// Player and obstacle circles at the game's sizes, for 500 candidate pairs whose boxes overlap. Most
+// miss at the corners, which visits every shared row: the expensive case.
+void BenchmarkCandidatePairs() {
+    const int pairs = 500;
+    const int frames = 2000;
+    CollisionMask player = Circle(38);
+    CollisionMask obstacle = Circle(32);
+    CHECK(!MasksOverlap(player, 0, 0, obstacle, 34, 34));
+    CHECK(MasksOverlap(player, 0, 0, obstacle, 3, 3));
+    std::vector<int> x(pairs), y(pairs);
+    for (int i = 0; i < pairs; i++) {
+        x[i] = 28 + Random(9);
+        y[i] = 28 + Random(9);
+    }
+    int found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < pairs; i++) {
+            found += MasksOverlap(player, 0, 0, obstacle, x[i], y[i]);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("%d candidate pairs: %.1f us per frame, %.1f ns per pair, %d hits\n", pairs, ns / frames / 1000,
+           ns / frames / pairs, found / frames);
+}
+} // namespace
+
+int main() {
+    TestMatchesReference();
+    TestAtlasOrientation();
+    BenchmarkCandidatePairs();
+    return TestResult();
+}
@@ -0,0 +1,72 @@
+#include "collision.h"
+#include "test_check.h"
+
+// Discrete and swept box tests, including the thin-obstacle case the swept test exists for.
+namespace {
+void TestOverlaps() {
+    Aabb a {0.0f, 0.0f, 1.0f, 1.0f};
+    CHECK(Overlaps(a, {0.5f, 0.5f, 1.0f, 1.0f}));
+    CHECK(Overlaps(a, {0.25f, 0.25f, 0.5f, 0.5f}));
+    // Touching edges and corners do not count.
+    CHECK(!Overlaps(a, {1.0f, 0.0f, 1.0f, 1.0f}));
+    CHECK(!Overlaps(a, {0.0f, -1.0f, 1.0f, 1.0f}));
+    CHECK(!Overlaps(a, {1.0f, 1.0f, 1.0f, 1.0f}));
+    CHECK(!Overlaps(a, {2.0f, 0.0f, 1.0f, 1.0f}));
+}
+
+void TestSweptHitsThinBoxInBetween() {
+    // Falls 2 units in one step past a wall 0.125 thick; the end position overlaps nothing.
+    Aabb a {0.0f, 1.0f, 0.5f, 0.5f};
+    Aabb wall {-1.0f, 0.0f, 4.0f, 0.125f};
+    CHECK(!Overlaps({a.x, a.y - 2.0f, a.width, a.height}, wall));
+    float toi = -1.0f;
+    CHECK(SweptOverlaps(a, 0.0f, -2.0f, wall, toi));
+    // The bottom edge reaches the wall's top after 0.875 units.
+    CHECK(toi == 0.4375f);
+}
+
+void TestSweptTimeOfImpact() {
+    Aabb a {0.0f, 0.0f, 1.0f, 1.0f};
+    Aabb b {3.0f, 0.0f, 1.0f, 1.0f};
+    float toi = -1.0f;
+    CHECK(SweptOverlaps(a, 4.0f, 0.0f, b, toi));
+    CHECK(toi == 0.5f);
+    // Stops just short, or would only arrive after the step.
+    CHECK(!SweptOverlaps(a, 2.0f, 0.0f, b, toi));
+    // Moving away.
+    CHECK(!SweptOverlaps(a, -4.0f, 0.0f, b, toi));
+}
+
+void TestSweptStartingInside() {
+    Aabb a {0.0f, 0.0f, 1.0f, 1.0f};
+    Aabb b {0.5f, 0.5f, 1.0f, 1.0f};
+    float toi = -1.0f;
+    CHECK(SweptOverlaps(a, -4.0f, 0.0f, b, toi));
+    CHECK(toi == 0.0f);
+    toi = -1.0f;
+    CHECK(SweptOverlaps(a, 0.0f, 0.0f, b, toi));
+    CHECK(toi == 0.0f);
+    CHECK(!SweptOverlaps(a, 0.0f, 0.0f, {2.0f, 0.0f, 1.0f, 1.0f}, toi));
+}
+
+void TestSweptMisses() {
+    Aabb a {0.0f, 0.0f, 1.0f, 1.0f};
+    float toi = -1.0f;
+    // Slides along b's edge without entering it.
+    CHECK(!SweptOverlaps(a, 4.0f, 0.0f, {2.0f, 1.0f, 1.0f, 1.0f}, toi));
+    // Passes diagonally below the box and only touches its corner.
+    CHECK(!SweptOverlaps(a, 4.0f, -4.0f, {2.0f, 0.0f, 1.0f, 1.0f}, toi));
+    // Heading straight at the box's corner hits it.
+    CHECK(SweptOverlaps(a, 4.0f, 4.0f, {2.0f, 2.0f, 1.0f, 1.0f}, toi));
+    CHECK(toi == 0.25f);
+}
+} // namespace
+
+int main() {
+    TestOverlaps();
+    TestSweptHitsThinBoxInBetween();
+    TestSweptTimeOfImpact();
+    TestSweptStartingInside();
+    TestSweptMisses();
+    return TestResult();
+}
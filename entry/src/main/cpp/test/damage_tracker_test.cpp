@@ -0,0 +1,93 @@
+#include <vector>
+#include "damage_tracker.h"
+#include "test_check.h"
+
+// Damage regions on a 200x100 surface. A 0.25 x 0.25 NDC sprite at the centre covers pixels 87.5-112.5 x
+// 43.75-56.25, 85-115 x 41-59 once rounded out and padded by 2 pixels.
+namespace {
+bool SameRect(const DamageRect &rect, int32_t x, int32_t y, int32_t w, int32_t h) {
+    return rect.x == x && rect.y == y && rect.w == w && rect.h == h;
+}
+
+void Frame(DamageTracker &tracker, float x) {
+    tracker.BeginFrame();
+    tracker.TrackSprite(0, x, 0.0f, 0.25f, 0.25f);
+    tracker.EndFrame();
+}
+
+void TestMovesAndBufferAge() {
+    DamageTracker tracker;
+    tracker.Resize(200, 100);
+    std::vector<int32_t> rects;
+    DamageRect bounds;
+
+    Frame(tracker, 0.0f);
+    CHECK(tracker.IsFullFrame());
+    CHECK(!tracker.CollectRegion(1, rects, bounds));
+
+    Frame(tracker, 0.0f);
+    CHECK(tracker.IsEmpty());
+    CHECK(tracker.CollectRegion(1, rects, bounds) && rects.empty());
+
+    // Moved by 0.25 NDC: the union of the old and new bounds.
+    Frame(tracker, 0.25f);
+    CHECK(!tracker.IsEmpty() && !tracker.IsFullFrame());
+    CHECK(tracker.CollectRegion(1, rects, bounds));
+    CHECK(rects.size() == 4 && SameRect(bounds, 85, 41, 55, 18));
+    // A buffer two frames old also misses the empty frame before; three frames reach the full one.
+    CHECK(tracker.CollectRegion(2, rects, bounds) && SameRect(bounds, 85, 41, 55, 18));
+    CHECK(!tracker.CollectRegion(3, rects, bounds));
+    CHECK(!tracker.CollectRegion(DamageTracker::kHistory + 1, rects, bounds));
+
+    // A sprite that is no longer drawn damages where it was.
+    tracker.BeginFrame();
+    tracker.EndFrame();
+    CHECK(tracker.CollectRegion(1, rects, bounds) && SameRect(bounds, 110, 41, 30, 18));
+
+    // Dropping an unpresented frame keeps buffer age counting from the last presented one.
+    tracker.BeginFrame();
+    tracker.DropFrame();
+    CHECK(tracker.CollectRegion(1, rects, bounds) && SameRect(bounds, 110, 41, 30, 18));
+}
+
+void TestUntrackedSpriteRepaintsThisFrame() {
+    DamageTracker tracker;
+    tracker.Resize(200, 100);
+    Frame(tracker, 0.0f);
+    Frame(tracker, 0.0f);
+    tracker.BeginFrame();
+    tracker.TrackSprite(0, 0.0f, 0.0f, 0.25f, 0.25f);
+    tracker.TrackSprite(DamageTracker::kMaxSlots, 0.5f, 0.5f, 0.1f, 0.1f);
+    tracker.EndFrame();
+    CHECK(tracker.IsFullFrame());
+    CHECK(tracker.DamagedPercent() == 100.0f);
+}
+
+void TestRectsStayBounded() {
+    DamageTracker tracker;
+    tracker.Resize(200, 100);
+    const int sprites = DamageTracker::kMaxRectsPerFrame * 2;
+    for (int frame = 0; frame < 2; frame++) {
+        tracker.BeginFrame();
+        for (int i = 0; i < sprites; i++) {
+            // Far apart, so none of them touch; the second frame moves every one.
+            tracker.TrackSprite(i, -0.95f + i * 0.12f, frame * 0.3f - 0.5f, 0.02f, 0.02f);
+        }
+        tracker.EndFrame();
+    }
+    std::vector<int32_t> rects;
+    DamageRect bounds;
+    CHECK(tracker.CollectRegion(1, rects, bounds));
+    CHECK(rects.size() <= DamageTracker::kMaxRectsPerFrame * 4);
+    // Merged, but everything that moved is still covered.
+    CHECK(bounds.x <= 3 && bounds.x + bounds.w >= 186 && bounds.y <= 22 && bounds.y + bounds.h >= 43);
+    CHECK(tracker.DamagedPercent() < 100.0f);
+}
+} // namespace
+
+int main() {
+    TestMovesAndBufferAge();
+    TestUntrackedSpriteRepaintsThisFrame();
+    TestRectsStayBounded();
+    return TestResult();
+}
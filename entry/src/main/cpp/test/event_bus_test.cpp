@@ -0,0 +1,147 @@
+#include <vector>
+#include "event_bus.h"
+#include "test_check.h"
+
+// Batching, coalescing, and that a full batch gives up spawn events rather than the events the game
+// flow depends on.
+namespace {
+GameEvent Event(GameEventType type, int32_t value = 0) { return {type, value, 0.0f, 0.0f}; }
+
+int CountOf(const EventBatch &batch, GameEventType type) {
+    int count = 0;
+    for (uint32_t i = 0; i < batch.count; i++) {
+        count += batch.events[i].type == type ? 1 : 0;
+    }
+    return count;
+}
+
+// Stands in for JS: keeps every batch until told to give it back.
+struct HeldBatches {
+    std::vector<EventBatch *> batches;
+    bool refuse = false;
+
+    EventBus::Sink Sink() {
+        return [this](EventBatch *batch) {
+            if (refuse) {
+                return false;
+            }
+            batches.push_back(batch);
+            return true;
+        };
+    }
+};
+
+void TestCoalescesScoreAndState() {
+    EventBus bus;
+    HeldBatches js;
+    bus.SetSink(js.Sink());
+    bus.Post(Event(GameEventType::ScoreChanged, 1));
+    bus.Post(Event(GameEventType::Spawn));
+    bus.Post(Event(GameEventType::ScoreChanged, 2));
+    bus.Post(Event(GameEventType::StateChanged, 1));
+    bus.Post(Event(GameEventType::StateChanged, 0));
+    bus.Flush();
+    CHECK(js.batches.size() == 1);
+    if (js.batches.size() != 1) {
+        return;
+    }
+    const EventBatch &batch = *js.batches[0];
+    CHECK(batch.count == 3);
+    CHECK(batch.events[0].type == GameEventType::ScoreChanged && batch.events[0].value == 2);
+    CHECK(batch.events[2].type == GameEventType::StateChanged && batch.events[2].value == 0);
+
+    // A flushed event is not replaced by the next frame's.
+    bus.Post(Event(GameEventType::ScoreChanged, 3));
+    bus.Flush();
+    CHECK(js.batches.size() == 2 && js.batches[0]->events[0].value == 2);
+    EventBusStats stats = bus.TakeStats();
+    CHECK(stats.posted == 6 && stats.coalesced == 2 && stats.batches == 2 && stats.dropped == 0);
+}
+
+void TestFullBatchKeepsGameOver() {
+    EventBus bus;
+    HeldBatches js;
+    bus.SetSink(js.Sink());
+    for (int i = 0; i < 500; i++) {
+        bus.Post(Event(GameEventType::Spawn, i));
+    }
+    bus.Post(Event(GameEventType::Collision, 9));
+    bus.Post(Event(GameEventType::GameOver, 9));
+    bus.Post(Event(GameEventType::StateChanged, 2));
+    bus.Flush();
+    CHECK(js.batches.size() == 1);
+    if (js.batches.size() != 1) {
+        return;
+    }
+    const EventBatch &batch = *js.batches[0];
+    CHECK(CountOf(batch, GameEventType::Spawn) == static_cast<int>(EventBus::kSpawnSlots));
+    CHECK(batch.events[batch.count - 2].type == GameEventType::GameOver);
+    CHECK(batch.events[batch.count - 1].type == GameEventType::StateChanged);
+    CHECK(bus.TakeStats().dropped == 500 - EventBus::kSpawnSlots);
+}
+
+void TestGameOverArrivesWhileJsHoldsEveryBatch() {
+    EventBus bus;
+    HeldBatches js;
+    bus.SetSink(js.Sink());
+    // JS keeps the first three batches; the fourth collects events and cannot be flushed.
+    for (int frame = 0; frame < 3; frame++) {
+        bus.Post(Event(GameEventType::Spawn));
+        bus.Flush();
+    }
+    CHECK(js.batches.size() == 3);
+    bus.Post(Event(GameEventType::ScoreChanged, 1));
+    for (int frame = 0; frame < 40; frame++) {
+        for (int i = 0; i < 10; i++) {
+            bus.Post(Event(GameEventType::Spawn, i));
+        }
+        // More collisions than the slots kept free of spawns: the rest come from evicted spawns.
+        bus.Post(Event(GameEventType::Collision, frame));
+        bus.Post(Event(GameEventType::ScoreChanged, frame + 2));
+        bus.Flush();
+    }
+    bus.Post(Event(GameEventType::GameOver, 99));
+    bus.Flush();
+    CHECK(js.batches.size() == 3);
+    CHECK(bus.TakeStats().deferred == 41);
+
+    bus.Release(js.batches[0]);
+    bus.Flush();
+    CHECK(js.batches.size() == 4);
+    if (js.batches.size() != 4) {
+        return;
+    }
+    const EventBatch &batch = *js.batches[3];
+    CHECK(batch.count == EventBatch::kCapacity);
+    CHECK(CountOf(batch, GameEventType::Collision) == 40);
+    CHECK(CountOf(batch, GameEventType::ScoreChanged) == 1);
+    CHECK(batch.events[0].type == GameEventType::ScoreChanged && batch.events[0].value == 41);
+    CHECK(batch.events[batch.count - 1].type == GameEventType::GameOver);
+    CHECK(batch.events[batch.count - 1].value == 99);
+}
+
+void TestRefusedBatchIsReused() {
+    EventBus bus;
+    HeldBatches js;
+    js.refuse = true;
+    bus.SetSink(js.Sink());
+    for (int frame = 0; frame < 10; frame++) {
+        bus.Post(Event(GameEventType::GameOver));
+        bus.Flush();
+    }
+    EventBusStats stats = bus.TakeStats();
+    CHECK(stats.dropped == 10 && stats.deferred == 0);
+    js.refuse = false;
+    bus.Post(Event(GameEventType::GameOver));
+    bus.Flush();
+    CHECK(js.batches.size() == 1);
+}
+} // namespace
+
+int main() {
+    TestCoalescesScoreAndState();
+    TestFullBatchKeepsGameOver();
+    TestGameOverArrivesWhileJsHoldsEveryBatch();
+    TestRefusedBatchIsReused();
+    return TestResult();
+}
@@ -0,0 +1,161 @@
+#include <string>
+#include "egl_core_shader.h"
+#include "frame_scheduler.h"
+#include "host_platform.h"
+#include "shared_state.h"
+#include "test_check.h"
+
+// Vsync pacing and parking, first on the scheduler alone, then through EGLCore's game loop on the host vsync
+// and window stand-ins.
+namespace {
+constexpr long long VSYNC_NS = 16666667;
+
+// Obstacles every half second on the right of the screen, clear of the player, so the game stays in play.
+const char SPAWN_WAVES[] = "seed 1\n"
+                           "wave start=0 every=0.5 count=2 x=0.5,0.9 size=0.1,0.1 speed=0.5\n";
+
+// Plays out one vsync the way EGLCore::GameLoop does; returns false when the loop parks.
+bool RunVsync(FrameScheduler &scheduler, bool sceneChanged, bool &rendered) {
+    rendered = scheduler.OnVsync();
+    if (!rendered) {
+        return true;
+    }
+    scheduler.OnFrameDone(sceneChanged);
+    return scheduler.ShouldContinue();
+}
+
+void TestPlayNeverParks() {
+    FrameScheduler scheduler;
+    bool rendered = false;
+    for (int vsync = 0; vsync < 100; vsync++) {
+        CHECK(RunVsync(scheduler, false, rendered));
+        CHECK(rendered);
+    }
+    CHECK(scheduler.Stats().parks == 0);
+}
+
+void TestPausedRendersEveryFourthVsyncAndParks() {
+    FrameScheduler scheduler;
+    scheduler.SetState(FrameState::Paused);
+    bool rendered = false;
+    for (int vsync = 0; vsync < 3; vsync++) {
+        CHECK(RunVsync(scheduler, true, rendered));
+        CHECK(!rendered);
+    }
+    CHECK(RunVsync(scheduler, true, rendered));
+    CHECK(rendered);
+
+    // Two static frames park the loop.
+    for (int vsync = 0; vsync < 7; vsync++) {
+        CHECK(RunVsync(scheduler, false, rendered));
+    }
+    CHECK(!RunVsync(scheduler, false, rendered));
+    CHECK(scheduler.Stats().parks == 1);
+    CHECK(scheduler.Stats().vsyncsSkipped == 9);
+}
+
+void TestWakeRestartsParkedLoop() {
+    FrameScheduler scheduler;
+    scheduler.SetState(FrameState::GameOver);
+    scheduler.SetVsyncDivisor(FrameState::GameOver, 1);
+    bool rendered = false;
+    CHECK(RunVsync(scheduler, false, rendered));
+    CHECK(!RunVsync(scheduler, false, rendered));
+
+    // Only the first wake has to request a vsync, and that vsync renders whatever the divisor.
+    CHECK(scheduler.Wake());
+    CHECK(!scheduler.Wake());
+    scheduler.SetVsyncDivisor(FrameState::GameOver, 4);
+    CHECK(RunVsync(scheduler, false, rendered));
+    CHECK(rendered);
+}
+
+void TestWakeWhileParkingKeepsLoopRunning() {
+    FrameScheduler scheduler;
+    scheduler.SetState(FrameState::Paused);
+    scheduler.SetVsyncDivisor(FrameState::Paused, 1);
+    bool rendered = false;
+    CHECK(RunVsync(scheduler, false, rendered));
+    scheduler.OnVsync();
+    scheduler.OnFrameDone(false);
+    // Input arrived before the loop marked itself parked, so the wake does not request a vsync itself.
+    CHECK(!scheduler.Wake());
+    CHECK(scheduler.ShouldContinue());
+}
+
+// A new game starts with every obstacle above the screen and the player still, so the first frames draw
+// nothing new. The loop has to keep running until the obstacles arrive.
+void TestFreshGameKeepsRunning() {
+    OHNativeWindow *window = TestCreateWindow(120, 200);
+    std::string id("frame_scheduler_test");
+    EGLCore core(id);
+    core.SetSoftwareRendering(true);
+    CHECK(core.LoadSpawnSchedule(SPAWN_WAVES, "frame_scheduler_test_spawn.bin"));
+    core.OnSurfaceCreated(window, 120, 200);
+    CHECK(TestPendingVsyncs() == 1);
+
+    long long timestamp = 0;
+    for (int vsync = 0; vsync < 180; vsync++) {
+        timestamp += VSYNC_NS;
+        CHECK(TestFireVsync(timestamp));
+    }
+    CHECK(TestPendingVsyncs() == 1);
+    SharedStateValues values;
+    core.Shared()->Read(values);
+    CHECK(values.state == 0);
+    CHECK(values.simSeconds > 2.9f);
+    CHECK(values.obstacles > 0);
+    CHECK(TestFlushedFrames(window) > 1);
+
+    // A paused game stops asking for vsyncs once its frame is on screen, and resuming restarts the loop.
+    core.SetPaused(true);
+    for (int vsync = 0; vsync < 40 && TestPendingVsyncs() > 0; vsync++) {
+        timestamp += VSYNC_NS;
+        TestFireVsync(timestamp);
+    }
+    CHECK(TestPendingVsyncs() == 0);
+    core.SetPaused(false);
+    CHECK(TestPendingVsyncs() == 1);
+
+    core.OnSurfaceDestroyed();
+    // The vsync that was still queued finds the surface gone.
+    CHECK(TestFireVsync(timestamp + VSYNC_NS));
+    CHECK(TestPendingVsyncs() == 0);
+    TestDestroyWindow(window);
+}
+
+// PluginRender deletes its EGLCore right after the surface goes away; vsyncs it had queued must find nothing
+// to run, whether the loop had started or not.
+void TestVsyncAfterCoreDeleted() {
+    OHNativeWindow *window = TestCreateWindow(120, 200);
+    std::string id("frame_scheduler_test");
+    auto *core = new EGLCore(id);
+    core->SetSoftwareRendering(true);
+    core->OnSurfaceCreated(window, 120, 200);
+    CHECK(TestFireVsync(VSYNC_NS));
+    CHECK(TestPendingVsyncs() == 1);
+    core->OnSurfaceDestroyed();
+    delete core;
+    CHECK(TestFireVsync(2 * VSYNC_NS));
+    CHECK(TestPendingVsyncs() == 0);
+
+    core = new EGLCore(id);
+    core->SetSoftwareRendering(true);
+    core->OnSurfaceCreated(window, 120, 200);
+    core->OnSurfaceDestroyed();
+    delete core;
+    CHECK(TestFireVsync(3 * VSYNC_NS));
+    CHECK(TestPendingVsyncs() == 0);
+    TestDestroyWindow(window);
+}
+} // namespace
+
+int main() {
+    TestPlayNeverParks();
+    TestPausedRendersEveryFourthVsyncAndParks();
+    TestWakeRestartsParkedLoop();
+    TestWakeWhileParkingKeepsLoopRunning();
+    TestFreshGameKeepsRunning();
+    TestVsyncAfterCoreDeleted();
+    return TestResult();
+}
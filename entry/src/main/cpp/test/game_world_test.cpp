@@ -0,0 +1,151 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "game_world.h"
+#include "job_system.h"
+#include "test_check.h"
+
+// Game rules that the JS side and the renderer rely on.
+namespace {
+constexpr float FRAME_SECONDS = 1.0f / 30;
+
+bool Near(float a, float b) { return std::fabs(a - b) < 1e-4f; }
+
+// Runs the world until the game ends, at most ten seconds, and returns every event it raised.
+std::vector<GameEvent> PlayUntilOver(GameWorld &world, JobSystem &jobs) {
+    std::vector<GameEvent> events;
+    for (int frame = 0; frame < 300 && !world.IsGameOver(); frame++) {
+        world.Advance(jobs, FRAME_SECONDS);
+        world.TakeEvents(events);
+    }
+    return events;
+}
+
+void TestCollisionReportsObstacle() {
+    // One obstacle straight down, just off the player's centre, with a decoy that misses on the left.
+    GameWorld world;
+    world.SetSpawnTable(SpawnTable::FromText("seed 1\n"
+                                             "wave start=0 end=0.3 every=0.2 x=0.1,0.1 size=0.1,0.1 speed=1\n"
+                                             "wave start=0 end=0.3 every=0.2 x=-0.6,-0.6 size=0.1,0.1 speed=1\n"));
+    world.Init();
+    JobSystem jobs(1);
+    std::vector<GameEvent> events = PlayUntilOver(world, jobs);
+    CHECK(world.IsGameOver());
+
+    const Position *player = world.PlayerPosition();
+    int collisions = 0;
+    for (const GameEvent &event : events) {
+        if (event.type != GameEventType::Collision) {
+            continue;
+        }
+        collisions++;
+        CHECK(player != nullptr);
+        // The obstacle's position, frozen at the moment of impact above the player.
+        CHECK(Near(event.x, 0.1f));
+        CHECK(player && event.y > player->y);
+    }
+    CHECK(collisions == 1);
+}
+
+// Drops a single 0.1 x 0.1 obstacle centred on x past the player (0.15 wide, centred on 0) and reports
+// whether it ended the game.
+bool DropHits(float x, std::shared_ptr<const CollisionAtlas> atlas) {
+    char waves[128];
+    snprintf(waves, sizeof(waves), "seed 1\nwave start=0 end=0.3 every=0.2 x=%.3f,%.3f size=0.1,0.1 speed=1\n", x, x);
+    GameWorld world;
+    world.SetSpawnTable(SpawnTable::FromText(waves));
+    world.SetCollisionMasks(std::move(atlas));
+    world.Init();
+    JobSystem jobs(1);
+    PlayUntilOver(world, jobs);
+    return world.IsGameOver();
+}
+
+// Two 16x16 frames: the player's solid, the obstacle's solid in its right half only.
+std::shared_ptr<const CollisionAtlas> HalfSolidAtlas() {
+    std::vector<uint8_t> rgba(32 * 16 * 4, 0);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            rgba[(y * 32 + x) * 4 + 3] = x < 16 || x >= 24 ? 255 : 0;
+        }
+    }
+    return CollisionAtlas::FromRgba(rgba.data(), 32, 16, 16, 16, 128);
+}
+
+void TestBoxesAreCentred() {
+    // Centres 0.12 apart overlap, 0.13 apart miss: the boxes reach 0.125 either side, as drawn.
+    CHECK(DropHits(-0.12f, nullptr));
+    CHECK(DropHits(0.12f, nullptr));
+    CHECK(!DropHits(-0.13f, nullptr));
+    CHECK(!DropHits(0.13f, nullptr));
+}
+
+void TestMasksSitOnTheirBoxes() {
+    // On the left the obstacle's solid half reaches the player; on the right only its empty half does.
+    std::shared_ptr<const CollisionAtlas> atlas = HalfSolidAtlas();
+    CHECK(atlas && atlas->FrameCount() == 2);
+    CHECK(DropHits(-0.12f, atlas));
+    CHECK(!DropHits(0.12f, atlas));
+    CHECK(!DropHits(-0.13f, atlas));
+}
+
+void TestSnapshotRoundTrip() {
+    // Obstacles falling well clear of the player, so the game is still on when the snapshot is taken.
+    GameWorld world;
+    world.SetSpawnTable(SpawnTable::FromText("seed 3\nwave start=0 end=5 every=0.1 x=0.6,0.9 size=0.1,0.1 speed=1\n"));
+    world.Init();
+    JobSystem jobs(1);
+    for (int frame = 0; frame < 20; frame++) {
+        world.QueueMove(-1);
+        world.Advance(jobs, FRAME_SECONDS);
+    }
+    CHECK(!world.IsGameOver());
+    int obstacles = world.ObstacleCount();
+    CHECK(obstacles > 0);
+    float playerX = world.PlayerPosition()->x;
+    std::vector<uint8_t> saved;
+    CHECK(world.SaveSnapshot(7, saved));
+
+    for (int frame = 0; frame < 20; frame++) {
+        world.Advance(jobs, FRAME_SECONDS);
+    }
+    uint32_t frame = 0;
+    CHECK(world.RestoreSnapshot(saved, frame));
+    CHECK(frame == 7);
+    CHECK(world.ObstacleCount() == obstacles);
+    CHECK(world.PlayerPosition() && world.PlayerPosition()->x == playerX);
+    std::vector<uint8_t> again;
+    CHECK(world.SaveSnapshot(7, again));
+    CHECK(again == saved);
+
+    // A damaged snapshot leaves the world as it was.
+    saved[saved.size() / 2] ^= 0xff;
+    world.Advance(jobs, FRAME_SECONDS);
+    int score = world.Score();
+    CHECK(!world.RestoreSnapshot(saved, frame));
+    CHECK(world.Score() == score);
+}
+
+void TestSnapshotRefusesUncountableWorld() {
+    GameWorld world;
+    world.Init();
+    std::vector<uint8_t> out(16);
+    // With the player, one entity more than the 16-bit count holds.
+    for (size_t i = 0; i < UINT16_MAX; i++) {
+        world.Entities().Create(Position {0.0f, 2.0f}, Extent {0.1f, 0.1f}, Obstacle {}, Sprite {});
+    }
+    CHECK(!world.SaveSnapshot(0, out));
+    CHECK(out.empty());
+}
+} // namespace
+
+int main() {
+    TestCollisionReportsObstacle();
+    TestBoxesAreCentred();
+    TestMasksSitOnTheirBoxes();
+    TestSnapshotRoundTrip();
+    TestSnapshotRefusesUncountableWorld();
+    return TestResult();
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include "egl_core_shader.h"
+#include "gl_recorder.h"
+#include "shared_state.h"
+#include "test_check.h"
+
+// Renders a field of 1,000 obstacles under GLRecorder and holds every frame to the sprite budget: the
+// instanced batch keeps draw calls flat, and every sprite is re-uploaded each frame as a 12-byte instance,
+// so the upload bound holds the instance format, not the damage tracking.
+namespace {
+constexpr size_t OBSTACLES = 1000;
+constexpr int FRAMES = 600;
+constexpr GLFrameBudget FRAME_BUDGET {3, 64 * 1024};
+
+// 255 small obstacles every half second on the right of the screen, clear of the player, slow enough
+// that over a thousand are on screen at once.
+const char SPAWN_WAVES[] = "seed 1\n"
+                           "wave start=0 every=0.5 count=255 x=0.3,0.9 size=0.02,0.02 speed=0.5\n";
+} // namespace
+
+int main() {
+    GLRecorder recorder;
+    recorder.Install();
+    std::string id("gl_budget_test");
+    EGLCore core(id);
+    core.SetObstacleLimit(OBSTACLES);
+    CHECK(core.LoadSpawnSchedule(SPAWN_WAVES, "gl_budget_test_spawn.bin"));
+    core.RestartGame();
+    if (!core.InitRenderer(454, 454)) {
+        fprintf(stderr, "InitRenderer failed\n");
+        return 1;
+    }
+
+    int32_t mostObstacles = 0;
+    int overBudget = 0;
+    GLRecorderStats worst;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        recorder.Reset();
+        core.RenderFrame(1.0f / 60);
+        const GLRecorderStats &stats = recorder.Stats();
+        if (!recorder.WithinBudget(FRAME_BUDGET)) {
+            if (overBudget++ == 0) {
+                fprintf(stderr, "frame %d: %u draw calls, %llu bytes uploaded\n", frame, stats.drawCalls,
+                        static_cast<unsigned long long>(stats.uploadBytes));
+            }
+        }
+        worst.drawCalls = std::max(worst.drawCalls, stats.drawCalls);
+        worst.uploadBytes = std::max(worst.uploadBytes, stats.uploadBytes);
+        SharedStateValues values;
+        core.Shared()->Read(values);
+        mostObstacles = std::max(mostObstacles, values.obstacles);
+    }
+    printf("%d frames, up to %d obstacles: at most %u draw calls and %llu bytes uploaded per frame\n", FRAMES,
+           mostObstacles, worst.drawCalls, static_cast<unsigned long long>(worst.uploadBytes));
+    CHECK(mostObstacles >= static_cast<int32_t>(OBSTACLES));
+    CHECK(overBudget == 0);
+    return TestResult();
+}
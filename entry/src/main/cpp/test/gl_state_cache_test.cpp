@@ -0,0 +1,128 @@
+#include <cstring>
+#include "gl_recorder.h"
+#include "gl_state_cache.h"
+#include "test_check.h"
+
+// Redundant state calls are elided and everything else reaches GL, checked against the recorded calls.
+namespace {
+int Recorded(const GLRecorder &recorder, const char *name) {
+    int count = 0;
+    for (const GLRecordedCall &call : recorder.Calls()) {
+        if (strcmp(call.name, name) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void TestRepeatedCallsAreElided(GLRecorder &recorder) {
+    GLStateCache cache;
+    recorder.Reset();
+    cache.BeginFrame();
+    cache.UseProgram(3);
+    cache.UseProgram(3);
+    cache.UseProgram(4);
+    cache.SetBlend(true);
+    cache.SetBlend(true);
+    cache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.Viewport(0, 0, 64, 64);
+    cache.Viewport(0, 0, 64, 64);
+    cache.Viewport(0, 0, 32, 64);
+    cache.ClearColor(0.0f, 0.0f, 0.1f, 1.0f);
+    cache.ClearColor(0.0f, 0.0f, 0.1f, 1.0f);
+    CHECK(Recorded(recorder, "glUseProgram") == 2);
+    CHECK(Recorded(recorder, "glEnable") == 1);
+    CHECK(Recorded(recorder, "glBlendFunc") == 1);
+    CHECK(Recorded(recorder, "glViewport") == 2);
+    CHECK(Recorded(recorder, "glClearColor") == 1);
+    CHECK(cache.FrameStats().issued == 7);
+    CHECK(cache.FrameStats().elided == 5);
+    CHECK(recorder.Stats().calls == cache.FrameStats().issued);
+}
+
+void TestFirstCallAlwaysIssues(GLRecorder &recorder) {
+    // The cache starts out matching GL defaults, but nothing is known until it has been set once.
+    GLStateCache cache;
+    recorder.Reset();
+    cache.UseProgram(0);
+    cache.SetBlend(false);
+    cache.Scissor(0, 0, 0, 0);
+    CHECK(recorder.Stats().calls == 3);
+
+    cache.Invalidate();
+    cache.UseProgram(0);
+    CHECK(Recorded(recorder, "glUseProgram") == 2);
+}
+
+void TestVertexArrayOwnsElementBuffer(GLRecorder &recorder) {
+    GLStateCache cache;
+    recorder.Reset();
+    cache.BindVertexArray(1);
+    cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+    cache.BindBuffer(GL_ARRAY_BUFFER, 6);
+    cache.BindVertexArray(2);
+    // The new vertex array has its own element binding; the array buffer binding is global.
+    cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+    cache.BindBuffer(GL_ARRAY_BUFFER, 6);
+    CHECK(Recorded(recorder, "glBindVertexArray") == 2);
+    CHECK(Recorded(recorder, "glBindBuffer") == 3);
+
+    // A deleted buffer's name may come back for a new buffer, which then has to be bound.
+    cache.OnBufferDeleted(6);
+    cache.BindBuffer(GL_ARRAY_BUFFER, 6);
+    CHECK(Recorded(recorder, "glBindBuffer") == 4);
+}
+
+void TestFramebufferTargets(GLRecorder &recorder) {
+    GLStateCache cache;
+    recorder.Reset();
+    cache.BindFramebuffer(GL_FRAMEBUFFER, 7);
+    // GL_FRAMEBUFFER sets both targets.
+    cache.BindFramebuffer(GL_READ_FRAMEBUFFER, 7);
+    cache.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 7);
+    CHECK(Recorded(recorder, "glBindFramebuffer") == 1);
+    cache.BindFramebuffer(GL_READ_FRAMEBUFFER, 8);
+    cache.BindFramebuffer(GL_FRAMEBUFFER, 7);
+    CHECK(Recorded(recorder, "glBindFramebuffer") == 3);
+
+    cache.OnFramebufferDeleted(7);
+    cache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    cache.BindFramebuffer(GL_FRAMEBUFFER, 7);
+    CHECK(Recorded(recorder, "glBindFramebuffer") == 4);
+}
+
+void TestTextureUnits(GLRecorder &recorder) {
+    GLStateCache cache;
+    recorder.Reset();
+    cache.BindTexture(0, GL_TEXTURE_2D, 10);
+    cache.BindTexture(1, GL_TEXTURE_2D, 11);
+    cache.BindTexture(0, GL_TEXTURE_2D, 10);
+    cache.BindTexture(1, GL_TEXTURE_2D, 11);
+    CHECK(Recorded(recorder, "glActiveTexture") == 2);
+    CHECK(Recorded(recorder, "glBindTexture") == 2);
+
+    // Binding on unit 1 again needs no unit switch; unit 0 does.
+    cache.BindTexture(1, GL_TEXTURE_2D, 12);
+    cache.BindTexture(0, GL_TEXTURE_2D, 13);
+    CHECK(Recorded(recorder, "glActiveTexture") == 3);
+    CHECK(Recorded(recorder, "glBindTexture") == 4);
+
+    // Units past the cache's range always issue and leave the active unit unknown.
+    cache.BindTexture(GLStateCache::kMaxTextureUnits, GL_TEXTURE_2D, 14);
+    cache.BindTexture(0, GL_TEXTURE_2D, 15);
+    CHECK(Recorded(recorder, "glActiveTexture") == 5);
+    CHECK(Recorded(recorder, "glBindTexture") == 6);
+}
+} // namespace
+
+int main() {
+    GLRecorder recorder;
+    recorder.Install();
+    TestRepeatedCallsAreElided(recorder);
+    TestFirstCallAlwaysIssues(recorder);
+    TestVertexArrayOwnsElementBuffer(recorder);
+    TestFramebufferTargets(recorder);
+    TestTextureUnits(recorder);
+    return TestResult();
+}
@@ -0,0 +1,112 @@
+#include <cstring>
+#include <vector>
+#include "gl_recorder.h"
+#include "gpu_uploader.h"
+#include "resource_registry.h"
+#include "test_check.h"
+
+// Upload lifecycle with the work done inline by Poll(), as on devices without a loader context: pending
+// until polled, ready with a GL name, tracked in the resource registry, and deleted on release.
+namespace {
+int Recorded(const GLRecorder &recorder, const char *name) {
+    int count = 0;
+    for (const GLRecordedCall &call : recorder.Calls()) {
+        if (strcmp(call.name, name) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint64_t TextureBytes() {
+    return ResourceRegistry::GetInstance()->Snapshot().kinds[static_cast<int>(ResourceKind::Texture)].bytes;
+}
+
+void TestTextureLifecycle(GLRecorder &recorder) {
+    GpuUploader uploader;
+    recorder.Reset();
+    uint64_t before = TextureBytes();
+    CHECK(!uploader.Poll());
+    CHECK(!uploader.Threaded());
+
+    GpuResourceId id = uploader.UploadTexture(16, 8, std::vector<uint8_t>(16 * 8 * 4, 0x7f), "test");
+    CHECK(id != 0);
+    CHECK(uploader.State(id) == GpuResourceState::Pending);
+    CHECK(uploader.Name(id) == 0);
+    CHECK(recorder.Stats().calls == 0);
+
+    CHECK(uploader.Poll());
+    CHECK(uploader.State(id) == GpuResourceState::Ready);
+    CHECK(uploader.Name(id) != 0);
+    CHECK(Recorded(recorder, "glTexImage2D") == 1);
+    CHECK(recorder.Stats().uploadBytes == 16 * 8 * 4);
+    CHECK(TextureBytes() == before + 16 * 8 * 4);
+
+    uploader.Release(id);
+    CHECK(uploader.Name(id) == 0);
+    CHECK(Recorded(recorder, "glDeleteTextures") == 1);
+    CHECK(TextureBytes() == before);
+    uploader.Release(id);
+    CHECK(Recorded(recorder, "glDeleteTextures") == 1);
+
+    GpuUploaderStats stats = uploader.TakeStats();
+    CHECK(stats.submitted == 1 && stats.completed == 1 && stats.failed == 0);
+    CHECK(stats.bytesUploaded == 16 * 8 * 4);
+}
+
+void TestReleaseBeforeUpload(GLRecorder &recorder) {
+    GpuUploader uploader;
+    recorder.Reset();
+    GpuResourceId id = uploader.UploadBuffer(GL_ARRAY_BUFFER, std::vector<uint8_t>(256), GL_STATIC_DRAW, "test");
+    uploader.Release(id);
+    uploader.Poll();
+    // The upload still ran, and its object went away as soon as it existed.
+    CHECK(Recorded(recorder, "glDeleteBuffers") == 1);
+    CHECK(uploader.Name(id) == 0);
+    CHECK(ResourceRegistry::GetInstance()->Snapshot().kinds[static_cast<int>(ResourceKind::Buffer)].bytes == 0);
+}
+
+void TestFailedUploads(GLRecorder &recorder) {
+    GpuUploader uploader;
+    recorder.Reset();
+    // Not width * height * 4 bytes.
+    GpuResourceId malformed = uploader.UploadTexture(4, 4, std::vector<uint8_t>(10), "test");
+    ResourceRegistry::GetInstance()->SetBudget(ResourceKind::Texture, 1024);
+    GpuResourceId overBudget = uploader.UploadTexture(32, 32, std::vector<uint8_t>(32 * 32 * 4), "test");
+    GpuResourceId withinBudget = uploader.UploadTexture(4, 4, std::vector<uint8_t>(4 * 4 * 4), "test");
+    uploader.Poll();
+    ResourceRegistry::GetInstance()->SetBudget(ResourceKind::Texture, 0);
+    CHECK(uploader.State(malformed) == GpuResourceState::Failed);
+    CHECK(uploader.State(overBudget) == GpuResourceState::Failed);
+    CHECK(uploader.State(withinBudget) == GpuResourceState::Ready);
+    CHECK(Recorded(recorder, "glGenTextures") == 1);
+    CHECK(uploader.TakeStats().failed == 2);
+
+    CHECK(uploader.State(0) == GpuResourceState::Failed);
+    CHECK(uploader.State(99) == GpuResourceState::Failed);
+    CHECK(uploader.Name(99) == 0);
+    uploader.Release(withinBudget);
+}
+
+void TestProgram(GLRecorder &recorder) {
+    GpuUploader uploader;
+    recorder.Reset();
+    GpuResourceId id = uploader.CompileProgram("void main() {}", "void main() {}", "test");
+    uploader.Poll();
+    CHECK(uploader.State(id) == GpuResourceState::Ready);
+    CHECK(uploader.Name(id) != 0);
+    CHECK(Recorded(recorder, "glLinkProgram") == 1);
+    uploader.Release(id);
+    CHECK(Recorded(recorder, "glDeleteProgram") == 1);
+}
+} // namespace
+
+int main() {
+    GLRecorder recorder;
+    recorder.Install();
+    TestTextureLifecycle(recorder);
+    TestReleaseBeforeUpload(recorder);
+    TestFailedUploads(recorder);
+    TestProgram(recorder);
+    return TestResult();
+}
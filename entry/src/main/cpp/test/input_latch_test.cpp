@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "input_latch.h"
+#include "test_check.h"
+#include "tracing.h"
+
+// Gesture extrapolation, and input latency measured from the oldest move a presented frame shows. Uses the
+// real clock, so latency checks are lower bounds only.
+namespace {
+void Sleep(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+bool Near(float a, float b) { return std::fabs(a - b) < 1e-4f; }
+
+void TestExtrapolate() {
+    InputLatch latch;
+    CHECK(latch.Extrapolate(0.05f) == 0.0f);
+    latch.OnMove(1);
+    latch.OnMove(1);
+    latch.OnMove(5);
+    // Three moves right within the velocity window: 30 moves per second.
+    CHECK(Near(latch.Extrapolate(0.02f), 0.6f));
+    CHECK(Near(latch.Extrapolate(1.0f), 30.0f * InputLatch::kMaxHorizonSeconds));
+    CHECK(latch.Extrapolate(-1.0f) == 0.0f);
+    latch.OnMove(-1);
+    latch.OnMove(-3);
+    CHECK(Near(latch.Extrapolate(0.02f), 0.2f));
+    latch.Reset();
+    CHECK(latch.Extrapolate(0.02f) == 0.0f);
+}
+
+void TestStoppedGestureIsNotExtrapolated() {
+    InputLatch latch;
+    latch.OnMove(1);
+    Sleep(static_cast<int>(InputLatch::kGestureIdleSeconds * 1000) + 20);
+    CHECK(latch.Extrapolate(0.02f) == 0.0f);
+}
+
+void TestLatency() {
+    InputLatch latch;
+    // Nothing latched: presenting measures nothing.
+    latch.OnPresented();
+    latch.Latch();
+    latch.OnPresented();
+    CHECK(latch.TakeStats().samples == 0);
+
+    latch.OnMove(1);
+    Sleep(10);
+    latch.OnMove(1);
+    latch.Latch();
+    Sleep(10);
+    latch.OnPresented();
+    InputLatencyStats stats = latch.TakeStats();
+    CHECK(stats.samples == 1);
+    CHECK(stats.maxMs >= 20.0f);
+    CHECK(Near(latch.SmoothedLatencyMs(), stats.maxMs));
+    CHECK(latch.TakeStats().samples == 0);
+}
+
+void TestUnpresentedFrameCarriesOldestInput() {
+    InputLatch latch;
+    latch.OnMove(1);
+    latch.Latch();
+    // That frame was dropped; the next one shows a newer move as well, but the first is still unseen.
+    Sleep(30);
+    latch.OnMove(1);
+    latch.Latch();
+    latch.OnPresented();
+    InputLatencyStats stats = latch.TakeStats();
+    CHECK(stats.samples == 1);
+    CHECK(stats.maxMs >= 30.0f);
+
+    // A reset drops moves that were never latched.
+    latch.OnMove(1);
+    latch.Reset();
+    latch.Latch();
+    latch.OnPresented();
+    CHECK(latch.TakeStats().samples == 0);
+}
+
+void TestInputFlows() {
+    Tracer *tracer = Tracer::GetInstance();
+    tracer->Start();
+    InputLatch latch;
+    latch.OnMove(1);
+    latch.OnMove(-1);
+    latch.Latch();
+    tracer->Begin("present");
+    latch.OnPresented();
+    tracer->End("present");
+    tracer->Stop();
+    // Two flow starts, the present slice, and the two flows ending in it.
+    CHECK(tracer->Stats().events == 6);
+}
+} // namespace
+
+int main() {
+    TestExtrapolate();
+    TestStoppedGestureIsNotExtrapolated();
+    TestLatency();
+    TestUnpresentedFrameCarriesOldestInput();
+    TestInputFlows();
+    return TestResult();
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "game_world.h"
+#include "job_system.h"
+#include "test_check.h"
+
+// The job system must leave the game single-threaded at its normal obstacle counts, produce the same
+// world for any worker count, and is benchmarked from 1 to kMaxWorkers workers on crowded fields.
+namespace {
+constexpr float FRAME_SECONDS = 1.0f / 30;
+
+// Fixed seed; obstacles fall on both sides of the player so none of them ends the game.
+const char SPAWN_WAVES[] = "seed 7\n"
+                           "wave start=0 every=0.2 count=200 x=-0.9,-0.3 size=0.02,0.04 speed=0.4 growth=0.1\n"
+                           "wave start=0 every=0.2 count=200 x=0.3,0.9 size=0.04,0.02 speed=0.6\n";
+
+std::vector<uint8_t> RunGame(JobSystem &jobs, size_t obstacleLimit, int frames, double *usPerTick = nullptr) {
+    GameWorld world;
+    world.SetSpawnTable(SpawnTable::FromText(SPAWN_WAVES));
+    world.SetObstacleLimit(obstacleLimit);
+    world.Init();
+    // Fill the field before timing.
+    for (int frame = 0; frame < frames; frame++) {
+        world.Advance(jobs, FRAME_SECONDS);
+    }
+    if (usPerTick) {
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            world.Advance(jobs, FRAME_SECONDS);
+        }
+        *usPerTick = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+                     frames;
+    }
+    std::vector<uint8_t> snapshot;
+    world.SaveSnapshot(0, snapshot);
+    return snapshot;
+}
+
+void TestIdleGameStaysOnCaller() {
+    JobSystem jobs(JobSystem::kMaxWorkers);
+    RunGame(jobs, GameWorld::kDefaultObstacleLimit, 300);
+    CHECK(!jobs.WorkersStarted());
+}
+
+void TestSameWorldForAnyWorkerCount() {
+    JobSystem single(1);
+    std::vector<uint8_t> expected = RunGame(single, 2000, 150);
+    for (int workers = 2; workers <= JobSystem::kMaxWorkers; workers++) {
+        JobSystem jobs(workers);
+        CHECK(RunGame(jobs, 2000, 150) == expected);
+        CHECK(jobs.WorkersStarted());
+    }
+}
+
+// Scaling needs as many cores as workers; on fewer the extra workers only add overhead.
+void BenchmarkScaling() {
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    for (size_t obstacles : {1000, 10000}) {
+        double baseline = 0.0;
+        for (int workers = 1; workers <= JobSystem::kMaxWorkers; workers++) {
+            JobSystem jobs(workers);
+            double us = 0.0;
+            RunGame(jobs, obstacles, 120, &us);
+            baseline = workers == 1 ? us : baseline;
+            printf("%5zu obstacles, %d worker(s): %8.1f us per frame, %.2fx\n", obstacles, workers, us,
+                   baseline / us);
+        }
+    }
+}
+} // namespace
+
+int main() {
+    TestIdleGameStaysOnCaller();
+    TestSameWorldForAnyWorkerCount();
+    BenchmarkScaling();
+    return TestResult();
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "render_queue.h"
+#include "test_check.h"
+
+// Radix sort order and stability against std::stable_sort, and batching of state-compatible commands.
+namespace {
+RenderCommand Command(uint64_t key, uint32_t index) {
+    RenderCommand command {};
+    command.sortKey = key;
+    command.reserved = index;
+    return command;
+}
+
+// The reserved word carries each command's push order, so equal keys show whether the sort kept it.
+bool SameOrder(const std::vector<RenderCommand> &a, const std::vector<RenderCommand> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].sortKey != b[i].sortKey || a[i].reserved != b[i].reserved) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestKeyFields() {
+    uint64_t key = RenderKey::Make(3, 7, 0x1234, 0xDEADBEEF);
+    CHECK(RenderKey::Layer(key) == 3);
+    CHECK(RenderKey::Program(key) == 7);
+    CHECK(RenderKey::Texture(key) == 0x1234);
+    CHECK((key & ~RenderKey::kStateMask) == 0xDEADBEEF);
+    // Layer outranks everything below it.
+    CHECK(RenderKey::Make(1, 0, 0, 0) > RenderKey::Make(0, 255, 0xFFFF, 0xFFFFFFFF));
+}
+
+void TestSortMatchesStableSort() {
+    std::mt19937 random(29);
+    RenderQueue queue;
+    std::vector<RenderCommand> expected;
+    for (uint32_t i = 0; i < 5000; i++) {
+        // Few distinct states and depths, so many keys collide and stability matters.
+        uint64_t key = RenderKey::Make(random() % 3, random() % 2, random() % 4, random() % 50);
+        queue.Push(Command(key, i));
+        expected.push_back(Command(key, i));
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const RenderCommand &a, const RenderCommand &b) { return a.sortKey < b.sortKey; });
+    queue.Sort();
+    CHECK(SameOrder(queue.Commands(), expected));
+}
+
+void TestSortFullWidthKeys() {
+    std::mt19937_64 random(64);
+    std::vector<RenderCommand> commands;
+    for (uint32_t i = 0; i < 1000; i++) {
+        commands.push_back(Command(random(), i));
+    }
+    RenderQueue queue;
+    queue.Assign(commands.data(), commands.size());
+    queue.Sort();
+    std::stable_sort(commands.begin(), commands.end(),
+                     [](const RenderCommand &a, const RenderCommand &b) { return a.sortKey < b.sortKey; });
+    CHECK(SameOrder(queue.Commands(), commands));
+
+    // Sorting sorted input, equal keys and a single command leaves them as they are.
+    queue.Sort();
+    CHECK(SameOrder(queue.Commands(), commands));
+    std::vector<RenderCommand> equal(10, Command(RenderKey::Make(1, 1, 1, 1), 0));
+    for (uint32_t i = 0; i < equal.size(); i++) {
+        equal[i].reserved = i;
+    }
+    queue.Assign(equal.data(), equal.size());
+    queue.Sort();
+    CHECK(SameOrder(queue.Commands(), equal));
+    queue.Assign(equal.data(), 1);
+    queue.Sort();
+    CHECK(queue.Size() == 1);
+}
+
+void TestSubmitBatchesByState() {
+    RenderQueue queue;
+    queue.Push(Command(RenderKey::Make(1, 0, 0, 5), 0));
+    queue.Push(Command(RenderKey::Make(0, 0, 0, 9), 1));
+    queue.Push(Command(RenderKey::Make(1, 0, 0, 2), 2));
+    queue.Push(Command(RenderKey::Make(0, 0, 0, 1), 3));
+    queue.Push(Command(RenderKey::Make(1, 0, 2, 0), 4));
+    queue.Sort();
+
+    std::vector<RenderBatch> batches;
+    queue.Submit([&batches](const RenderBatch &batch) { batches.push_back(batch); });
+    CHECK(batches.size() == 3);
+    if (batches.size() != 3) {
+        return;
+    }
+    // Depth differences stay within a batch, in depth order.
+    CHECK(batches[0].stateKey == RenderKey::Make(0, 0, 0, 0) && batches[0].count == 2);
+    CHECK(batches[0].commands[0].reserved == 3 && batches[0].commands[1].reserved == 1);
+    CHECK(batches[1].stateKey == RenderKey::Make(1, 0, 0, 0) && batches[1].count == 2);
+    CHECK(batches[1].commands[0].reserved == 2 && batches[1].commands[1].reserved == 0);
+    CHECK(batches[2].stateKey == RenderKey::Make(1, 0, 2, 0) && batches[2].count == 1);
+
+    queue.Clear();
+    int emptyBatches = 0;
+    queue.Submit([&emptyBatches](const RenderBatch &) { emptyBatches++; });
+    CHECK(emptyBatches == 0);
+}
+
+void TestPackColor() {
+    CHECK(PackColor(1.0f, 0.0f, 0.0f, 1.0f) == 0xFF0000FFu);
+    CHECK(PackColor(0.0f, 0.0f, 1.0f, 0.0f) == 0x00FF0000u);
+    // Out-of-range channels clamp.
+    CHECK(PackColor(-1.0f, 2.0f, 0.5f, 1.0f) == 0xFF80FF00u);
+}
+} // namespace
+
+int main() {
+    TestKeyFields();
+    TestSortMatchesStableSort();
+    TestSortFullWidthKeys();
+    TestSubmitBatchesByState();
+    TestPackColor();
+    return TestResult();
+}
@@ -0,0 +1,79 @@
+#include "resolution_scaler.h"
+#include "test_check.h"
+
+// Render scale decisions with the default 16.6 ms budget: down above 14.9 ms smoothed, up below 10.8 ms.
+namespace {
+bool Near(float a, float b) { return a - b < 1e-4f && b - a < 1e-4f; }
+
+// Feeds frames until the scale changes; returns how many it took, or frames + 1 if it never did.
+int FramesUntilChange(ResolutionScaler &scaler, float frameMs, int frames) {
+    for (int frame = 1; frame <= frames; frame++) {
+        if (scaler.AddFrameTime(frameMs)) {
+            return frame;
+        }
+    }
+    return frames + 1;
+}
+
+void TestSlowFramesScaleDownQuickly() {
+    ResolutionScaler scaler;
+    scaler.Configure(ResolutionScalerConfig {});
+    scaler.Reset();
+    CHECK(Near(scaler.Scale(), 1.0f));
+    CHECK(FramesUntilChange(scaler, 30.0f, 100) == 6);
+    CHECK(Near(scaler.Scale(), 0.9f));
+    // Keeps stepping down while frames stay slow, and stops at the minimum.
+    for (int frame = 0; frame < 200; frame++) {
+        scaler.AddFrameTime(30.0f);
+    }
+    CHECK(Near(scaler.Scale(), 0.5f));
+}
+
+void TestFastFramesScaleUpSlowly() {
+    ResolutionScaler scaler;
+    ResolutionScalerConfig config;
+    config.minScale = 0.5f;
+    scaler.Configure(config);
+    scaler.Reset();
+    for (int frame = 0; frame < 200; frame++) {
+        scaler.AddFrameTime(40.0f);
+    }
+    CHECK(Near(scaler.Scale(), 0.5f));
+    // A long calm streak is needed for every step up.
+    int frames = FramesUntilChange(scaler, 4.0f, 1000);
+    CHECK(frames >= config.framesToIncrease && frames < 200);
+    CHECK(Near(scaler.Scale(), 0.6f));
+    for (int frame = 0; frame < 2000; frame++) {
+        scaler.AddFrameTime(4.0f);
+    }
+    CHECK(Near(scaler.Scale(), 1.0f));
+}
+
+void TestFramesInsideTheBandHoldTheScale() {
+    ResolutionScaler scaler;
+    scaler.Configure(ResolutionScalerConfig {});
+    scaler.Reset();
+    CHECK(FramesUntilChange(scaler, 12.0f, 1000) == 1001);
+    CHECK(Near(scaler.Scale(), 1.0f));
+}
+
+void TestConfigureClamps() {
+    ResolutionScaler scaler;
+    ResolutionScalerConfig config;
+    config.minScale = 0.0f;
+    config.maxScale = 2.0f;
+    config.step = 0.0f;
+    scaler.Configure(config);
+    CHECK(Near(scaler.Config().minScale, 0.1f));
+    CHECK(Near(scaler.Config().maxScale, 1.0f));
+    CHECK(scaler.Config().step > 0.0f);
+}
+} // namespace
+
+int main() {
+    TestSlowFramesScaleDownQuickly();
+    TestFastFramesScaleUpSlowly();
+    TestFramesInsideTheBandHoldTheScale();
+    TestConfigureClamps();
+    return TestResult();
+}
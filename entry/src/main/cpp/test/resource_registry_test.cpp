@@ -0,0 +1,107 @@
+#include <vector>
+#include "resource_registry.h"
+#include "test_check.h"
+
+// Per-kind and per-pool accounting, budget crossings, and budget callbacks that call back into the
+// registry.
+namespace {
+ResourceUsage KindUsage(ResourceKind kind) {
+    return ResourceRegistry::GetInstance()->Snapshot().kinds[static_cast<int>(kind)];
+}
+
+ResourceUsage PoolUsage(ResourcePool pool) {
+    return ResourceRegistry::GetInstance()->Snapshot().pools[static_cast<int>(pool)];
+}
+
+void TestAccounting() {
+    ResourceRegistry *registry = ResourceRegistry::GetInstance();
+    ResourceUsage gpuBefore = PoolUsage(ResourcePool::Gpu);
+    ResourceHandle a = registry->Track(ResourceKind::Renderbuffer, "accounting", 1000);
+    ResourceHandle b = registry->Track(ResourceKind::Renderbuffer, "accounting", 500);
+    CHECK(a != 0 && b != 0 && a != b);
+    CHECK(KindUsage(ResourceKind::Renderbuffer).count == 2);
+    CHECK(KindUsage(ResourceKind::Renderbuffer).bytes == 1500);
+    CHECK(PoolUsage(ResourcePool::Gpu).bytes == gpuBefore.bytes + 1500);
+
+    registry->Resize(a, 3000);
+    CHECK(KindUsage(ResourceKind::Renderbuffer).bytes == 3500);
+    registry->Untrack(a);
+    registry->Untrack(a);
+    registry->Untrack(0);
+    ResourceUsage usage = KindUsage(ResourceKind::Renderbuffer);
+    CHECK(usage.count == 1 && usage.bytes == 500 && usage.peakBytes == 3500);
+
+    // Owners are listed largest first.
+    ResourceHandle big = registry->Track(ResourceKind::Renderbuffer, "bigger owner", 1 << 20);
+    ResourceSnapshot snapshot = registry->Snapshot();
+    CHECK(!snapshot.owners.empty() && snapshot.owners[0].owner == "bigger owner");
+    registry->Untrack(big);
+    registry->Untrack(b);
+    CHECK(KindUsage(ResourceKind::Renderbuffer).bytes == 0);
+    CHECK(PoolUsage(ResourcePool::Gpu).bytes == gpuBefore.bytes);
+}
+
+void TestBudgetCrossings() {
+    ResourceRegistry *registry = ResourceRegistry::GetInstance();
+    std::vector<BudgetExceeded> events;
+    registry->SetBudgetCallback([&events](const BudgetExceeded &event) { events.push_back(event); });
+    registry->SetBudget(ResourceKind::Framebuffer, 1000);
+    CHECK(registry->Fits(ResourceKind::Framebuffer, 1000));
+    CHECK(!registry->Fits(ResourceKind::Framebuffer, 1001));
+
+    ResourceHandle a = registry->Track(ResourceKind::Framebuffer, "budget", 800);
+    CHECK(events.empty());
+    ResourceHandle b = registry->Track(ResourceKind::Framebuffer, "budget", 400);
+    CHECK(events.size() == 1);
+    if (!events.empty()) {
+        CHECK(!events[0].pool && events[0].index == static_cast<int>(ResourceKind::Framebuffer));
+        CHECK(events[0].bytes == 1200 && events[0].budgetBytes == 1000);
+    }
+    // Still over: no second report until usage has come back under the budget.
+    registry->Resize(b, 500);
+    CHECK(events.size() == 1);
+    registry->Untrack(a);
+    registry->Resize(b, 1500);
+    CHECK(events.size() == 2);
+    CHECK(KindUsage(ResourceKind::Framebuffer).overBudget == 2);
+
+    registry->Untrack(b);
+    registry->SetBudget(ResourceKind::Framebuffer, 0);
+    registry->SetBudgetCallback(nullptr);
+    CHECK(registry->Fits(ResourceKind::Framebuffer, 1ull << 40));
+}
+
+void TestCallbackMayCallBack() {
+    ResourceRegistry *registry = ResourceRegistry::GetInstance();
+    registry->SetBudget(ResourceKind::VertexArray, 100);
+    int calls = 0;
+    ResourceHandle nested = 0;
+    // The callback replaces itself, then allocates enough to cross the pool budget, which notifies again
+    // from inside the first notification.
+    registry->SetPoolBudget(ResourcePool::Gpu, PoolUsage(ResourcePool::Gpu).bytes + 150);
+    registry->SetBudgetCallback([&](const BudgetExceeded &) {
+        calls++;
+        if (calls == 1) {
+            ResourceRegistry::GetInstance()->SetBudgetCallback([&calls](const BudgetExceeded &) { calls += 10; });
+            nested = ResourceRegistry::GetInstance()->Track(ResourceKind::VertexArray, "nested", 100);
+        }
+    });
+    ResourceHandle handle = registry->Track(ResourceKind::VertexArray, "reentrant", 120);
+    CHECK(nested != 0);
+    // The kind crossing went to the first callback, the nested pool crossing to its replacement.
+    CHECK(calls == 11);
+
+    registry->Untrack(nested);
+    registry->Untrack(handle);
+    registry->SetBudget(ResourceKind::VertexArray, 0);
+    registry->SetPoolBudget(ResourcePool::Gpu, 0);
+    registry->SetBudgetCallback(nullptr);
+}
+} // namespace
+
+int main() {
+    TestAccounting();
+    TestBudgetCrossings();
+    TestCallbackMayCallBack();
+    return TestResult();
+}
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "egl_core_shader.h"
+#include "shared_state.h"
+#include "test_check.h"
+
+// The shared state block as ArkTS sees it: word layout, the sequence lock under a concurrent writer, and
+// the frame counter EGLCore publishes.
+namespace {
+int32_t IntWord(SharedState &state, SharedStateWord word) {
+    int32_t value;
+    memcpy(&value, static_cast<const uint8_t *>(state.Data()) + word * sizeof(uint32_t), sizeof(value));
+    return value;
+}
+
+float FloatWord(SharedState &state, SharedStateWord word) {
+    float value;
+    memcpy(&value, static_cast<const uint8_t *>(state.Data()) + word * sizeof(uint32_t), sizeof(value));
+    return value;
+}
+
+void TestLayout() {
+    SharedState state;
+    CHECK(SharedState::Size() == 64);
+    CHECK(IntWord(state, SHARED_VERSION) == static_cast<int32_t>(SHARED_STATE_VERSION));
+    // Constructed with one complete publish: the sequence is even and non-zero.
+    CHECK(IntWord(state, SHARED_SEQUENCE) == 2);
+
+    SharedStateValues values;
+    values.frame = 12;
+    values.score = 345;
+    values.state = 2;
+    values.obstacles = 6;
+    values.playerX = -0.5f;
+    values.fps = 59.5f;
+    values.inputLatencyMs = 21.25f;
+    state.Publish(values);
+    CHECK(IntWord(state, SHARED_SEQUENCE) == 4);
+    CHECK(IntWord(state, SHARED_FRAME) == 12);
+    CHECK(IntWord(state, SHARED_SCORE) == 345);
+    CHECK(IntWord(state, SHARED_STATE) == 2);
+    CHECK(IntWord(state, SHARED_OBSTACLES) == 6);
+    CHECK(FloatWord(state, SHARED_PLAYER_X) == -0.5f);
+    CHECK(FloatWord(state, SHARED_FPS) == 59.5f);
+    CHECK(FloatWord(state, SHARED_INPUT_LATENCY_MS) == 21.25f);
+
+    SharedStateValues read;
+    CHECK(state.Read(read));
+    CHECK(read.frame == 12 && read.score == 345 && read.playerX == -0.5f && read.inputLatencyMs == 21.25f);
+}
+
+void TestReadGivesUpWhileWriting() {
+    SharedState state;
+    auto *sequence = static_cast<std::atomic<uint32_t> *>(state.Data());
+    // A writer that stalled halfway through a publish.
+    sequence->store(3);
+    SharedStateValues read;
+    read.score = -1;
+    CHECK(!state.Read(read));
+    CHECK(read.score == -1);
+    sequence->store(4);
+    CHECK(state.Read(read));
+}
+
+void TestReadsAreNeverTorn() {
+    SharedState state;
+    std::atomic<bool> done {false};
+    // Every publish writes the same counter into each field, so a mixed snapshot shows up as a mismatch.
+    std::thread writer([&state, &done] {
+        for (int32_t i = 1; i <= 200000; i++) {
+            SharedStateValues values;
+            values.frame = i;
+            values.score = i;
+            values.obstacles = i;
+            values.simSeconds = static_cast<float>(i);
+            values.inputLatencyMs = static_cast<float>(i);
+            state.Publish(values);
+        }
+        done.store(true);
+    });
+    int reads = 0;
+    int torn = 0;
+    int32_t last = 0;
+    bool backwards = false;
+    while (!done.load() || reads == 0) {
+        SharedStateValues values;
+        if (!state.Read(values)) {
+            continue;
+        }
+        reads++;
+        if (values.score != values.frame || values.obstacles != values.frame ||
+            values.simSeconds != static_cast<float>(values.frame) ||
+            values.inputLatencyMs != static_cast<float>(values.frame)) {
+            torn++;
+        }
+        backwards = backwards || values.frame < last;
+        last = values.frame;
+    }
+    writer.join();
+    CHECK(reads > 0);
+    CHECK(torn == 0);
+    CHECK(!backwards);
+}
+
+// Only frames that were drawn and presented advance the counter. A new game has every obstacle above the
+// screen, so after the first frame the scene is static for a while.
+void TestFrameCountsPresentedFrames() {
+    std::string id("shared_state_test");
+    EGLCore core(id);
+    core.SetSoftwareRendering(true);
+    core.RestartGame();
+    CHECK(core.InitRenderer(120, 200));
+    int presented = 0;
+    for (int frame = 0; frame < 10; frame++) {
+        if (core.RenderFrame(1.0f / 60)) {
+            presented++;
+        }
+    }
+    SharedStateValues values;
+    CHECK(core.Shared()->Read(values));
+    CHECK(presented > 0 && presented < 10);
+    CHECK(values.frame == presented);
+}
+} // namespace
+
+int main() {
+    TestLayout();
+    TestReadGivesUpWhileWriting();
+    TestReadsAreNeverTorn();
+    TestFrameCountsPresentedFrames();
+    return TestResult();
+}
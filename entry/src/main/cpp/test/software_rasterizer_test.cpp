@@ -0,0 +1,127 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "capture_writer.h"
+#include "software_rasterizer.h"
+#include "test_check.h"
+
+// Rasterizes a fixed sprite batch and compares it with the images checked in under golden/, once drawn
+// in full and once as a partial redraw of the damage left by moving a few sprites. Run with --update to
+// rewrite the golden images after an intended change in output.
+namespace {
+constexpr int WIDTH = 200;
+constexpr int HEIGHT = 120;
+constexpr size_t SPRITES = 48;
+constexpr size_t MOVED = 6;
+constexpr float CLEAR[4] = {0.05f, 0.05f, 0.12f, 1.0f};
+
+// Overlapping sprites of every size, some crossing tile borders and some the screen edge; fixed so the
+// golden images never change unless the rasterizer does.
+std::vector<SpriteInstance> SpriteBatch() {
+    std::vector<SpriteInstance> sprites;
+    uint32_t state = 12345;
+    auto next = [&state](int range) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>((state >> 16) % static_cast<uint32_t>(range));
+    };
+    for (size_t i = 0; i < SPRITES; i++) {
+        float x = next(2400) / 1000.0f - 1.2f;
+        float y = next(2400) / 1000.0f - 1.2f;
+        float w = next(500) / 1000.0f + 0.01f;
+        float h = next(500) / 1000.0f + 0.01f;
+        uint32_t color = 0xff000000u | static_cast<uint32_t>(next(1 << 24));
+        sprites.push_back({QuantizeSpriteCoord(x), QuantizeSpriteCoord(y), QuantizeSpriteCoord(w),
+                           QuantizeSpriteCoord(h), color});
+    }
+    return sprites;
+}
+
+// Pixel rectangle (x, y, w, h, bottom-left origin) covering a sprite, one pixel wider on each side.
+void AppendDamage(const SpriteInstance &sprite, std::vector<int32_t> &rects) {
+    float cx = SpriteCoordToNdc(sprite.x);
+    float cy = SpriteCoordToNdc(sprite.y);
+    float hw = SpriteCoordToNdc(sprite.width) / 2;
+    float hh = SpriteCoordToNdc(sprite.height) / 2;
+    int32_t x0 = static_cast<int32_t>(std::floor((cx - hw + 1.0f) * 0.5f * WIDTH)) - 1;
+    int32_t y0 = static_cast<int32_t>(std::floor((cy - hh + 1.0f) * 0.5f * HEIGHT)) - 1;
+    int32_t x1 = static_cast<int32_t>(std::ceil((cx + hw + 1.0f) * 0.5f * WIDTH)) + 1;
+    int32_t y1 = static_cast<int32_t>(std::ceil((cy + hh + 1.0f) * 0.5f * HEIGHT)) + 1;
+    rects.insert(rects.end(), {x0, y0, x1 - x0, y1 - y0});
+}
+
+CapturedFrame Capture(const SoftwareRasterizer &rasterizer) {
+    CapturedFrame frame;
+    frame.width = rasterizer.Width();
+    frame.height = rasterizer.Height();
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(rasterizer.Pixels());
+    frame.rgba.assign(bytes, bytes + static_cast<size_t>(frame.width) * frame.height * 4);
+    return frame;
+}
+
+void Draw(SoftwareRasterizer &rasterizer, JobSystem &jobs, const std::vector<SpriteInstance> &sprites,
+          const std::vector<int32_t> *damage) {
+    rasterizer.Begin(CLEAR[0], CLEAR[1], CLEAR[2], CLEAR[3]);
+    rasterizer.SubmitSprites(sprites.data(), sprites.size());
+    rasterizer.Resolve(jobs, damage);
+}
+
+void CheckGolden(const CapturedFrame &frame, const char *name, bool update) {
+    std::string path = std::string(TEST_GOLDEN_DIR) + "/" + name;
+    if (update) {
+        CHECK(WriteFrameTga(path, frame));
+        printf("wrote %s\n", path.c_str());
+        return;
+    }
+    CapturedFrame golden;
+    if (!ReadFrameTga(path, golden)) {
+        fprintf(stderr, "cannot read %s\n", path.c_str());
+        TestFailures()++;
+        return;
+    }
+    // The CPU path is exact: any changed pixel is a change in output.
+    FrameDiff diff = CompareFrames(frame, golden, 0);
+    if (!diff.sameSize || diff.mismatched != 0) {
+        fprintf(stderr, "%s: %u pixels differ, by up to %d\n", name, diff.mismatched, diff.maxDelta);
+        WriteFrameTga(std::string("actual_") + name, frame);
+        TestFailures()++;
+    }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    JobSystem jobs(4);
+    std::vector<SpriteInstance> sprites = SpriteBatch();
+
+    SoftwareRasterizer rasterizer;
+    rasterizer.Resize(WIDTH, HEIGHT);
+    Draw(rasterizer, jobs, sprites, nullptr);
+    CheckGolden(Capture(rasterizer), "sprite_batch_full.tga", update);
+
+    // Next frame: a few sprites move, only the tiles they touched before and after are redrawn.
+    std::vector<SpriteInstance> moved = sprites;
+    std::vector<int32_t> damage;
+    for (size_t i = 0; i < MOVED; i++) {
+        AppendDamage(moved[i * 7], damage);
+        moved[i * 7].x = static_cast<int16_t>(moved[i * 7].x + QuantizeSpriteCoord(0.15f));
+        moved[i * 7].y = static_cast<int16_t>(moved[i * 7].y - QuantizeSpriteCoord(0.1f));
+        AppendDamage(moved[i * 7], damage);
+    }
+    rasterizer.TakeStats();
+    Draw(rasterizer, jobs, moved, &damage);
+    SoftwareRasterStats stats = rasterizer.TakeStats();
+    CHECK(stats.tilesKept > 0);
+    CapturedFrame partial = Capture(rasterizer);
+    CheckGolden(partial, "sprite_batch_partial.tga", update);
+
+    // The partial redraw has to match drawing the moved batch from scratch, on any number of workers.
+    JobSystem single(1);
+    SoftwareRasterizer fresh;
+    fresh.Resize(WIDTH, HEIGHT);
+    Draw(fresh, single, moved, nullptr);
+    FrameDiff diff = CompareFrames(partial, Capture(fresh), 0);
+    CHECK(diff.sameSize && diff.mismatched == 0);
+    return TestResult();
+}
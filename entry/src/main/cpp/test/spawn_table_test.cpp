@@ -0,0 +1,77 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "spawn_schedule.h"
+#include "test_check.h"
+
+// A cached table whose records were damaged after the header was written must be recompiled, not
+// mapped: the scheduler trusts mapped records as much as freshly compiled ones.
+namespace {
+const char SPAWN_WAVES[] = "seed 3\n"
+                           "wave start=0 every=0.5 x=-0.5,0.5 size=0.1,0.1 speed=1\n"
+                           "wave start=2 end=10 every=0.25 count=3 x=-0.9,0.9 size=0.05,0.08 speed=1.5\n";
+const char CACHE_PATH[] = "spawn_table_test.bin";
+
+bool WriteCache(const std::vector<uint8_t> &bytes) {
+    FILE *file = fopen(CACHE_PATH, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+// Writes the compiled table with damage applied to its records, then loads it back.
+std::shared_ptr<SpawnTable> LoadDamaged(const std::function<void(SpawnWaveRecord *)> &damage) {
+    std::vector<uint8_t> bytes;
+    CHECK(SpawnTable::Compile(SPAWN_WAVES, bytes));
+    SpawnWaveRecord *waves = reinterpret_cast<SpawnWaveRecord *>(bytes.data() + sizeof(SpawnTableHeader));
+    damage(waves);
+    CHECK(WriteCache(bytes));
+    return SpawnTable::LoadOrCompile(SPAWN_WAVES, CACHE_PATH);
+}
+
+void TestDamagedRecordsAreRecompiled() {
+    const std::function<void(SpawnWaveRecord *)> damages[] = {
+        [](SpawnWaveRecord *waves) { waves[1].periodMs = 0; },
+        [](SpawnWaveRecord *waves) { waves[1].endMs = waves[1].startMs; },
+        [](SpawnWaveRecord *waves) { waves[1].count = 0; },
+        [](SpawnWaveRecord *waves) { waves[1].chance = SPAWN_CHANCE_ALWAYS + 1; },
+        [](SpawnWaveRecord *waves) { waves[1].xMin = waves[1].xMax + 1; },
+        [](SpawnWaveRecord *waves) { waves[1].width = 0; },
+        [](SpawnWaveRecord *waves) { waves[1].speed = NAN; },
+        [](SpawnWaveRecord *waves) { std::swap(waves[0], waves[1]); },
+    };
+    for (const auto &damage : damages) {
+        std::shared_ptr<SpawnTable> table = LoadDamaged(damage);
+        CHECK(table && !table->IsMapped());
+        if (table) {
+            CHECK(table->Waves()[1].periodMs == 250);
+        }
+        // The rebuilt cache is mapped next time.
+        table = SpawnTable::LoadOrCompile(SPAWN_WAVES, CACHE_PATH);
+        CHECK(table && table->IsMapped());
+    }
+}
+
+void TestIntactCacheIsMapped() {
+    std::shared_ptr<SpawnTable> table = LoadDamaged([](SpawnWaveRecord *) {});
+    CHECK(table && table->IsMapped());
+    SpawnScheduler scheduler;
+    scheduler.Reset(table, table ? table->Header().seed : 0);
+    std::vector<SpawnRequest> spawns;
+    scheduler.Advance(10000, 0, false, spawns);
+    // Waves first fire one period after they start: 20 firings of the first wave by 10 s, and 31 of three
+    // obstacles from the second before it ends.
+    CHECK(spawns.size() == 20 + 31 * 3);
+}
+} // namespace
+
+int main() {
+    TestDamagedRecordsAreRecompiled();
+    TestIntactCacheIsMapped();
+    return TestResult();
+}
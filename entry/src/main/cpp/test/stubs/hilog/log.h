@@ -0,0 +1,16 @@
+#ifndef TEST_STUB_HILOG_LOG_H
+#define TEST_STUB_HILOG_LOG_H
+
+// Host stand-in for the hilog NDK header; platform_stubs.cpp prints warnings and errors to stderr.
+typedef enum { LOG_APP = 0 } LogType;
+typedef enum { LOG_DEBUG = 3, LOG_INFO = 4, LOG_WARN = 5, LOG_ERROR = 6, LOG_FATAL = 7 } LogLevel;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int OH_LOG_Print(LogType type, LogLevel level, unsigned int domain, const char *tag, const char *fmt, ...);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_STUB_HILOG_LOG_H
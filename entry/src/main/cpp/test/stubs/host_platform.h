@@ -0,0 +1,17 @@
+#ifndef TEST_STUB_HOST_PLATFORM_H
+#define TEST_STUB_HOST_PLATFORM_H
+
+#include <native_window/external_window.h>
+
+// Test controls for the host stand-ins of the platform APIs.
+OHNativeWindow *TestCreateWindow(int width, int height);
+void TestDestroyWindow(OHNativeWindow *window);
+// Number of buffers the window has had flushed to it.
+int TestFlushedFrames(OHNativeWindow *window);
+
+// Frame callbacks requested and not yet delivered.
+int TestPendingVsyncs();
+// Delivers the oldest requested frame callback; returns false when none is pending.
+bool TestFireVsync(long long timestamp);
+
+#endif // TEST_STUB_HOST_PLATFORM_H
@@ -0,0 +1,16 @@
+#ifndef TEST_STUB_NATIVE_BUFFER_H
+#define TEST_STUB_NATIVE_BUFFER_H
+
+#include <stdint.h>
+
+typedef enum {
+    NATIVEBUFFER_USAGE_CPU_READ = (1ULL << 0),
+    NATIVEBUFFER_USAGE_CPU_WRITE = (1ULL << 1),
+    NATIVEBUFFER_USAGE_MEM_DMA = (1ULL << 3),
+} OH_NativeBuffer_Usage;
+
+typedef enum {
+    NATIVEBUFFER_PIXEL_FMT_RGBA_8888 = 12,
+} OH_NativeBuffer_Format;
+
+#endif // TEST_STUB_NATIVE_BUFFER_H
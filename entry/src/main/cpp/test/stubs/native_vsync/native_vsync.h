@@ -0,0 +1,20 @@
+#ifndef TEST_STUB_NATIVE_VSYNC_H
+#define TEST_STUB_NATIVE_VSYNC_H
+
+// Host stand-in: there is no display, so requested frames wait until a test delivers them with
+// TestFireVsync() from host_platform.h.
+struct OH_NativeVSync;
+typedef struct OH_NativeVSync OH_NativeVSync;
+typedef void (*OH_NativeVSync_FrameCallback)(long long timestamp, void *data);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+OH_NativeVSync *OH_NativeVSync_Create(const char *name, unsigned int length);
+void OH_NativeVSync_Destroy(OH_NativeVSync *nativeVsync);
+int OH_NativeVSync_RequestFrame(OH_NativeVSync *nativeVsync, OH_NativeVSync_FrameCallback callback, void *data);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_STUB_NATIVE_VSYNC_H
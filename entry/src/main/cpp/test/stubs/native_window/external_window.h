@@ -0,0 +1,55 @@
+#ifndef TEST_STUB_EXTERNAL_WINDOW_H
+#define TEST_STUB_EXTERNAL_WINDOW_H
+
+#include <stdint.h>
+
+// Host stand-in: windows come from TestCreateWindow() in host_platform.h and hold one buffer in memory.
+typedef struct {
+    int32_t fd;
+    int32_t width;
+    int32_t stride;
+    int32_t height;
+    int32_t size;
+    int32_t format;
+    uint64_t usage;
+    void *virAddr;
+} BufferHandle;
+
+struct NativeWindow;
+struct NativeWindowBuffer;
+typedef struct NativeWindow OHNativeWindow;
+typedef struct NativeWindowBuffer OHNativeWindowBuffer;
+
+typedef struct Region {
+    struct Rect {
+        int32_t x;
+        int32_t y;
+        uint32_t w;
+        uint32_t h;
+    } *rects;
+    int32_t rectNumber;
+} Region;
+
+enum NativeWindowOperation {
+    SET_BUFFER_GEOMETRY,
+    GET_BUFFER_GEOMETRY,
+    GET_FORMAT,
+    SET_FORMAT,
+    GET_USAGE,
+    SET_USAGE,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int32_t OH_NativeWindow_NativeWindowRequestBuffer(OHNativeWindow *window, OHNativeWindowBuffer **buffer, int *fenceFd);
+int32_t OH_NativeWindow_NativeWindowFlushBuffer(OHNativeWindow *window, OHNativeWindowBuffer *buffer, int fenceFd,
+                                                Region region);
+int32_t OH_NativeWindow_NativeWindowAbortBuffer(OHNativeWindow *window, OHNativeWindowBuffer *buffer);
+BufferHandle *OH_NativeWindow_GetBufferHandleFromNative(OHNativeWindowBuffer *buffer);
+int32_t OH_NativeWindow_NativeWindowHandleOpt(OHNativeWindow *window, int code, ...);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_STUB_EXTERNAL_WINDOW_H
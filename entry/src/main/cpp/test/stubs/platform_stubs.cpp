@@ -0,0 +1,168 @@
+#include <hilog/log.h>
+#include <cstdarg>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <native_vsync/native_vsync.h>
+#include <native_window/external_window.h>
+#include "host_platform.h"
+
+extern "C" int OH_LOG_Print(LogType, LogLevel level, unsigned int, const char *tag, const char *fmt, ...) {
+    if (level < LOG_WARN) {
+        return 0;
+    }
+    // hilog privacy markers are not printf syntax.
+    std::string format(fmt);
+    for (const char *marker : {"{public}", "{private}"}) {
+        for (size_t at = format.find(marker); at != std::string::npos; at = format.find(marker, at)) {
+            format.erase(at, std::char_traits<char>::length(marker));
+        }
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%s] ", tag);
+    vfprintf(stderr, format.c_str(), args);
+    fputc('\n', stderr);
+    va_end(args);
+    return 0;
+}
+
+namespace {
+struct PendingFrame {
+    OH_NativeVSync_FrameCallback callback;
+    void *data;
+};
+
+std::mutex g_vsyncMutex;
+std::deque<PendingFrame> g_pendingFrames;
+} // namespace
+
+struct OH_NativeVSync {};
+
+extern "C" OH_NativeVSync *OH_NativeVSync_Create(const char *, unsigned int) { return new OH_NativeVSync; }
+extern "C" void OH_NativeVSync_Destroy(OH_NativeVSync *nativeVsync) { delete nativeVsync; }
+extern "C" int OH_NativeVSync_RequestFrame(OH_NativeVSync *nativeVsync, OH_NativeVSync_FrameCallback callback,
+                                           void *data) {
+    if (!nativeVsync || !callback) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(g_vsyncMutex);
+    g_pendingFrames.push_back({callback, data});
+    return 0;
+}
+
+int TestPendingVsyncs() {
+    std::lock_guard<std::mutex> lock(g_vsyncMutex);
+    return static_cast<int>(g_pendingFrames.size());
+}
+
+bool TestFireVsync(long long timestamp) {
+    PendingFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(g_vsyncMutex);
+        if (g_pendingFrames.empty()) {
+            return false;
+        }
+        frame = g_pendingFrames.front();
+        g_pendingFrames.pop_front();
+    }
+    // Outside the lock: the callback usually requests the next frame.
+    frame.callback(timestamp, frame.data);
+    return true;
+}
+
+struct NativeWindow {
+    int width = 0;
+    int height = 0;
+    int flushed = 0;
+    bool dequeued = false;
+    BufferHandle handle {};
+};
+
+// The buffer is the window's only one, so its address stands in for the buffer object.
+struct NativeWindowBuffer {};
+
+namespace {
+// Window buffers are memfd backed so the presenter can map them like dma-buf handles.
+bool AllocateBuffer(NativeWindow *window, int width, int height) {
+    if (window->handle.fd >= 0) {
+        close(window->handle.fd);
+    }
+    window->handle.fd = static_cast<int32_t>(memfd_create("host_window", 0));
+    window->handle.width = width;
+    window->handle.height = height;
+    window->handle.stride = width * 4;
+    window->handle.size = window->handle.stride * height;
+    return window->handle.fd >= 0 && ftruncate(window->handle.fd, window->handle.size) == 0;
+}
+} // namespace
+
+OHNativeWindow *TestCreateWindow(int width, int height) {
+    NativeWindow *window = new NativeWindow;
+    window->handle.fd = -1;
+    window->width = width;
+    window->height = height;
+    AllocateBuffer(window, width, height);
+    return window;
+}
+
+void TestDestroyWindow(OHNativeWindow *window) {
+    if (window && window->handle.fd >= 0) {
+        close(window->handle.fd);
+    }
+    delete window;
+}
+
+int TestFlushedFrames(OHNativeWindow *window) { return window ? window->flushed : 0; }
+
+extern "C" int32_t OH_NativeWindow_NativeWindowRequestBuffer(OHNativeWindow *window, OHNativeWindowBuffer **buffer,
+                                                             int *fenceFd) {
+    if (!window || window->dequeued || window->handle.fd < 0) {
+        return -1;
+    }
+    window->dequeued = true;
+    *buffer = reinterpret_cast<OHNativeWindowBuffer *>(window);
+    *fenceFd = -1;
+    return 0;
+}
+
+extern "C" int32_t OH_NativeWindow_NativeWindowFlushBuffer(OHNativeWindow *window, OHNativeWindowBuffer *, int,
+                                                           Region) {
+    if (!window || !window->dequeued) {
+        return -1;
+    }
+    window->dequeued = false;
+    window->flushed++;
+    return 0;
+}
+
+extern "C" int32_t OH_NativeWindow_NativeWindowAbortBuffer(OHNativeWindow *window, OHNativeWindowBuffer *) {
+    if (window) {
+        window->dequeued = false;
+    }
+    return 0;
+}
+
+extern "C" BufferHandle *OH_NativeWindow_GetBufferHandleFromNative(OHNativeWindowBuffer *buffer) {
+    return buffer ? &reinterpret_cast<NativeWindow *>(buffer)->handle : nullptr;
+}
+
+extern "C" int32_t OH_NativeWindow_NativeWindowHandleOpt(OHNativeWindow *window, int code, ...) {
+    if (!window) {
+        return -1;
+    }
+    if (code != SET_BUFFER_GEOMETRY) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, code);
+    int width = va_arg(args, int);
+    int height = va_arg(args, int);
+    va_end(args);
+    window->width = width;
+    window->height = height;
+    return AllocateBuffer(window, width, height) ? 0 : -1;
+}
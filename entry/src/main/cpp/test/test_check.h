@@ -0,0 +1,29 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// Minimal assertions for the host tests: a failed CHECK is reported and counted, and main returns
+// TestResult() so ctest sees the failure.
+inline int &TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            TestFailures()++;                                                             \
+        }                                                                                 \
+    } while (0)
+
+inline int TestResult() {
+    if (TestFailures() != 0) {
+        fprintf(stderr, "%d check(s) failed\n", TestFailures());
+        return 1;
+    }
+    return 0;
+}
+
+#endif // TEST_CHECK_H
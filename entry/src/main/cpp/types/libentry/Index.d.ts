@@ -5,6 +5,14 @@ export interface RenderContext {
 export const moveLeft: (context: ESObject) => void;
 export const moveRight: (context: ESObject) => void;
 export const restartGame: (context: ESObject) => void;
+
+/**
+ * Pauses or resumes the simulation. While paused the render loop drops to a low rate and
+ * stops requesting vsyncs once the scene is static.
+ * @param context - XComponent context
+ * @param paused - true to pause, false to resume
+ */
+export const setPaused: (context: ESObject, paused: boolean) => void;
 export const getContext: (value: number) => ESObject;
 
 /**
@@ -12,4 +20,214 @@ export const getContext: (value: number) => ESObject;
  * @param context - XComponent context
  * @param callback - Function called with final score when game ends
  */
-export const setGameOverCallback: (context: ESObject, callback: (score: number) => void) => void;
\ No newline at end of file
+export const setGameOverCallback: (context: ESObject, callback: (score: number) => void) => void;
+
+/**
+ * Engine event types; values match GameEventType in game/game_events.h.
+ * 0 ScoreChanged (value: score), 1 Spawn (x, y: spawn position), 2 Collision (value: score, x, y: obstacle),
+ * 3 GameOver (value: final score), 4 StateChanged (value: 0 playing, 1 paused, 2 game over).
+ */
+export interface EngineEvent {
+  type: number;
+  value: number;
+  x: number;
+  y: number;
+}
+
+/**
+ * Registers a listener for engine events. Events are delivered in batches, at most one per rendered frame;
+ * score and state changes within a batch are coalesced to the latest value. A batch that overflows drops
+ * spawn events first.
+ * @param context - XComponent context
+ * @param listener - Called with the events of one batch in order, or null to stop listening
+ */
+export const setEventListener: (context: ESObject, listener: ((events: EngineEvent[]) => void) | null) => void;
+
+/**
+ * Enables or disables dynamic resolution scaling driven by measured frame time. Off by default. The setting
+ * carries over to surfaces created later.
+ * @param context - XComponent context
+ * @param enabled - Render into a scaled offscreen target and upscale when frames run over budget
+ * @param minScale - Lowest render scale relative to the window (default 0.5)
+ * @param maxScale - Highest render scale relative to the window (default 1.0)
+ */
+export const setAdaptiveResolution: (context: ESObject, enabled: boolean, minScale?: number, maxScale?: number) => void;
+
+/**
+ * Enables or disables late input latching (on by default). When on, the player is drawn at the position
+ * sampled just before each frame is built, including moves not yet simulated and a short extrapolation of
+ * the current gesture; collisions still use the simulated position. Kept for later surfaces too.
+ * @param context - XComponent context
+ * @param enabled - Sample input at frame build time instead of at the last simulation tick
+ */
+export const setLateLatch: (context: ESObject, enabled: boolean) => void;
+
+/**
+ * Renders on the CPU instead of GLES, presenting through the window's buffer queue. Takes effect when the
+ * next surface is created. The engine also switches to it by itself when EGL or the sprite shader cannot
+ * be set up on the device.
+ * @param context - XComponent context
+ * @param enabled - Use the software renderer
+ */
+export const setSoftwareRendering: (context: ESObject, enabled: boolean) => void;
+
+/**
+ * Enables world snapshots. The running game is saved to path when it is paused and when the surface is
+ * destroyed, and restored when the next surface starts, so play continues where it left off. A finished
+ * game is not kept.
+ * @param context - XComponent context
+ * @param path - Snapshot file, for example filesDir + '/world.snapshot'
+ */
+export const setSnapshotPath: (context: ESObject, path: string) => void;
+
+/**
+ * Loads the obstacle spawn waves from rawfile spawn_waves.txt. The text is compiled once into a
+ * binary table cached as spawn_waves.bin in filesDir and memory-mapped on later launches; the cache
+ * is rebuilt whenever the text changes. The running game switches to the new waves immediately, and games
+ * on later surfaces use them as well.
+ * @param context - XComponent context
+ * @param resourceManager - Resource manager of the application context
+ * @param filesDir - Writable directory for the compiled table
+ * @returns false if the text has errors; the previous waves stay in use
+ */
+export const loadSpawnSchedule: (context: ESObject, resourceManager: ESObject, filesDir: string) => boolean;
+
+/**
+ * Turns on pixel-accurate collision. Obstacles whose boxes touch the player only end the game if the
+ * opaque pixels of their frames overlap. Masks are built once, here, from the atlas alpha channel, and stay
+ * in use when the surface is recreated.
+ * Frame 0 is the player; obstacles are given the remaining frames by spawn wave.
+ * @param context - XComponent context
+ * @param atlas - Decoded RGBA atlas pixels, top row first, or null to go back to box collision
+ * @param width - Atlas width in pixels
+ * @param height - Atlas height in pixels
+ * @param frameWidth - Frame width in pixels; frames are numbered row by row from the top left
+ * @param frameHeight - Frame height in pixels
+ * @returns false if the atlas is smaller than its size or than one frame
+ */
+export const setCollisionMasks: (context: ESObject, atlas: ArrayBuffer | null, width?: number, height?: number,
+  frameWidth?: number, frameHeight?: number) => boolean;
+
+/**
+ * Live engine state, as read from the buffer returned by getSharedState. The buffer holds 16 32-bit
+ * words; the word index of every field is given below. Integer fields are read through an Int32Array,
+ * float fields through a Float32Array over the same buffer.
+ *
+ * The engine republishes the block on every pass of the game loop, including passes that draw nothing
+ * because the scene did not change, under a sequence lock: word 0 is odd while it writes. Read word 0, the fields, then word 0 again, and retry if it was odd or changed.
+ */
+export interface SharedStateSnapshot {
+  /** Word 1: layout version, currently 2. */
+  version: number;
+  /**
+   * Word 2 (int32): frames drawn and presented. Passes that draw nothing do not count. The count starts at 0
+   * with a new surface, or continues from the saved count when the game is restored from a snapshot.
+   */
+  frame: number;
+  /** Word 3 (int32): current score. */
+  score: number;
+  /** Word 4 (int32): 0 playing, 1 paused, 2 game over. */
+  state: number;
+  /** Word 5 (int32): live obstacles. */
+  obstacles: number;
+  /** Word 6 (float32): player x in NDC. */
+  playerX: number;
+  /** Word 7 (float32): player y in NDC. */
+  playerY: number;
+  /** Word 8 (float32): smoothed display rate. */
+  fps: number;
+  /** Word 9 (float32): CPU and GPU time of the last drawn frame in ms. */
+  frameMs: number;
+  /** Word 10 (float32): adaptive resolution scale. */
+  renderScale: number;
+  /** Word 11 (float32): simulation time of the current game in seconds. */
+  simSeconds: number;
+  /** Word 12 (float32, version 2): smoothed input-to-present latency in ms, 0 until measured. */
+  inputLatencyMs: number;
+}
+
+/**
+ * Returns an ArrayBuffer backed directly by the engine's shared state block (see SharedStateSnapshot).
+ * Reading it needs no further native calls. The buffer belongs to the current XComponent surface: it
+ * stays readable afterwards but stops updating, so fetch a new one after the XComponent is recreated.
+ * @param context - XComponent context
+ */
+export const getSharedState: (context: ESObject) => ArrayBuffer;
+
+/** Usage of one resource kind or memory pool. Sizes are engine estimates, not driver-reported. */
+export interface MemoryUsage {
+  count: number;
+  bytes: number;
+  /** Highest bytes seen since launch. */
+  peakBytes: number;
+  /** 0 when unlimited. */
+  budgetBytes: number;
+  /** Times an allocation took usage over the budget. */
+  overBudget: number;
+}
+
+/**
+ * Snapshot of everything the engine tracks. Kinds are program, buffer, texture, renderbuffer, framebuffer,
+ * vertexArray, surface (window buffers) and heap; heap counts toward cpu, all others toward gpu.
+ */
+export interface MemoryStats {
+  gpu: MemoryUsage;
+  cpu: MemoryUsage;
+  kinds: Record<string, MemoryUsage>;
+  /** Totals per owner tag, largest first. */
+  owners: Array<{ owner: string; count: number; bytes: number }>;
+}
+
+/**
+ * Returns the engine's resource accounting for the whole process.
+ * @param context - XComponent context
+ */
+export const getMemoryStats: (context: ESObject) => MemoryStats;
+
+/**
+ * Sets a memory budget. Crossing it is logged with the largest owners; texture and buffer uploads and the
+ * adaptive resolution target are refused while they would exceed it.
+ * @param context - XComponent context
+ * @param budget - "gpu", "cpu" or a kind name from MemoryStats
+ * @param bytes - Budget in bytes, 0 for unlimited
+ */
+export const setMemoryBudget: (context: ESObject, budget: string, bytes: number) => void;
+
+/**
+ * Starts or stops recording a timeline of engine work on every native thread: NAPI calls, the vsync
+ * callback, simulation ticks, draw submission, buffer swaps and event delivery, with flows from each move
+ * to the frame that shows it. Starting discards the previous recording; stopping keeps it for dumpTrace.
+ * @param context - XComponent context
+ * @param enabled - Record events
+ */
+export const setTracing: (context: ESObject, enabled: boolean) => void;
+
+/**
+ * Writes the current recording, for example to filesDir + '/engine.json'. Paths ending in .pftrace or
+ * .perfetto-trace get Perfetto protobuf, anything else Chrome Trace Event JSON (chrome://tracing,
+ * ui.perfetto.dev). Runs on the calling thread; recording may continue meanwhile.
+ * @param context - XComponent context
+ * @param path - Output file path
+ * @returns Whether the file was written
+ */
+export const dumpTrace: (context: ESObject, path: string) => boolean;
+
+/**
+ * Captures rendered frames as uncompressed TGA files named frame_<frame>.tga, where frame matches
+ * SharedState's frame counter. Pixels are read back a frame or two late through a ring of buffers, so the
+ * game loop never waits for them; frames are dropped, not delayed, when the GPU or the disk falls behind.
+ * Frames the game loop skips because nothing changed are not captured. The sequence can be turned into a
+ * video with ffmpeg -framerate 60 -i frame_%06d.tga. Capture resumes on a recreated surface until stopped.
+ * @param context - XComponent context
+ * @param directory - Existing directory for the images, for example filesDir
+ * @param everyN - Capture every Nth rendered frame (default 1)
+ * @param maxFrames - Stop after this many frames; 0 or omitted captures until stopFrameCapture
+ * @returns false if the directory does not exist
+ */
+export const startFrameCapture: (context: ESObject, directory: string, everyN?: number, maxFrames?: number) => boolean;
+
+/**
+ * Stops frame capture once the images already queued are written.
+ * @param context - XComponent context
+ */
+export const stopFrameCapture: (context: ESObject) => void;